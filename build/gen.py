@@ -696,7 +696,9 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/functions_target.cc',
         'src/gn/general_tool.cc',
         'src/gn/generated_file_target_generator.cc',
+        'src/gn/graph_snapshot.cc',
         'src/gn/group_target_generator.cc',
+        'src/gn/header_check_state.cc',
         'src/gn/header_checker.cc',
         'src/gn/import_manager.cc',
         'src/gn/input_conversion.cc',
@@ -721,6 +723,7 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/ninja_create_bundle_target_writer.cc',
         'src/gn/ninja_generated_file_target_writer.cc',
         'src/gn/ninja_group_target_writer.cc',
+        'src/gn/ninja_logs.cc',
         'src/gn/ninja_outputs_writer.cc',
         'src/gn/ninja_rust_binary_target_writer.cc',
         'src/gn/ninja_target_command_util.cc',
@@ -732,10 +735,12 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/operators.cc',
         'src/gn/output_conversion.cc',
         'src/gn/output_file.cc',
+        'src/gn/output_sink.cc',
         'src/gn/parse_node_value_adapter.cc',
         'src/gn/parse_tree.cc',
         'src/gn/parser.cc',
         'src/gn/path_output.cc',
+        'src/gn/path_output_cache.cc',
         'src/gn/pattern.cc',
         'src/gn/pool.cc',
         'src/gn/qt_creator_writer.cc',
@@ -766,7 +771,10 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/swift_variables.cc',
         'src/gn/switches.cc',
         'src/gn/target.cc',
+        'src/gn/target_closure.cc',
         'src/gn/target_generator.cc',
+        'src/gn/target_graph_index.cc',
+        'src/gn/target_values_union.cc',
         'src/gn/template.cc',
         'src/gn/token.cc',
         'src/gn/tokenizer.cc',
@@ -805,10 +813,12 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/bundle_data_unittest.cc',
         'src/gn/c_include_iterator_unittest.cc',
         'src/gn/command_format_unittest.cc',
+        'src/gn/command_path_unittest.cc',
         'src/gn/commands_unittest.cc',
         'src/gn/compile_commands_writer_unittest.cc',
         'src/gn/config_unittest.cc',
         'src/gn/config_values_extractors_unittest.cc',
+        'src/gn/desc_builder_unittest.cc',
         'src/gn/escape_unittest.cc',
         'src/gn/exec_process_unittest.cc',
         'src/gn/filesystem_utils_unittest.cc',
@@ -830,7 +840,9 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/functions_target_rust_unittest.cc',
         'src/gn/functions_target_unittest.cc',
         'src/gn/functions_unittest.cc',
+        'src/gn/graph_snapshot_unittest.cc',
         'src/gn/hash_table_base_unittest.cc',
+        'src/gn/header_check_state_unittest.cc',
         'src/gn/header_checker_unittest.cc',
         'src/gn/input_conversion_unittest.cc',
         'src/gn/json_project_writer_unittest.cc',
@@ -850,13 +862,16 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/ninja_create_bundle_target_writer_unittest.cc',
         'src/gn/ninja_generated_file_target_writer_unittest.cc',
         'src/gn/ninja_group_target_writer_unittest.cc',
+        'src/gn/ninja_logs_unittest.cc',
         'src/gn/ninja_outputs_writer_unittest.cc',
         'src/gn/ninja_rust_binary_target_writer_unittest.cc',
         'src/gn/ninja_target_command_util_unittest.cc',
         'src/gn/ninja_target_writer_unittest.cc',
         'src/gn/ninja_toolchain_writer_unittest.cc',
+        'src/gn/ninja_writer_unittest.cc',
         'src/gn/operators_unittest.cc',
         'src/gn/output_conversion_unittest.cc',
+        'src/gn/output_sink_unittest.cc',
         'src/gn/parse_tree_unittest.cc',
         'src/gn/parser_unittest.cc',
         'src/gn/path_output_unittest.cc',
@@ -875,8 +890,11 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/string_utils_unittest.cc',
         'src/gn/substitution_pattern_unittest.cc',
         'src/gn/substitution_writer_unittest.cc',
+        'src/gn/target_closure_unittest.cc',
+        'src/gn/target_graph_index_unittest.cc',
         'src/gn/target_public_pair_unittest.cc',
         'src/gn/target_unittest.cc',
+        'src/gn/target_values_union_unittest.cc',
         'src/gn/template_unittest.cc',
         'src/gn/test_with_scheduler.cc',
         'src/gn/test_with_scope.cc',
@@ -889,9 +907,11 @@ def WriteGNNinja(path, platform, host, options, args_list):
         'src/gn/visual_studio_utils_unittest.cc',
         'src/gn/visual_studio_writer_unittest.cc',
         'src/gn/xcode_object_unittest.cc',
+        'src/gn/xcode_writer_unittest.cc',
         'src/gn/xml_element_writer_unittest.cc',
         'src/util/atomic_write_unittest.cc',
         'src/util/test/gn_test.cc',
+        'src/util/worker_pool_unittest.cc',
       ], 'libs': []},
   }
 
@@ -46,6 +46,16 @@ bool JSONWriter::WriteWithOptions(const Value& node,
   return result;
 }
 
+// static
+bool JSONWriter::WriteFragmentWithOptions(const Value& node,
+                                          int options,
+                                          size_t depth,
+                                          std::string* json) {
+  json->clear();
+  JSONWriter writer(options, json);
+  return writer.BuildJSONString(node, depth);
+}
+
 JSONWriter::JSONWriter(int options, std::string* json)
     : omit_binary_values_((options & OPTIONS_OMIT_BINARY_VALUES) != 0),
       pretty_print_((options & OPTIONS_PRETTY_PRINT) != 0),
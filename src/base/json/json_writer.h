@@ -41,6 +41,15 @@ class JSONWriter {
                                int options,
                                std::string* json);
 
+  // Same as WriteWithOptions(), but formats |node| as the value of an entry
+  // nested |depth| levels deep in a larger document, and doesn't append a
+  // final line ending. This allows rendering the entries of a large
+  // dictionary separately, and concatenating them afterwards.
+  static bool WriteFragmentWithOptions(const Value& node,
+                                       int options,
+                                       size_t depth,
+                                       std::string* json);
+
  private:
   JSONWriter(int options, std::string* json);
 
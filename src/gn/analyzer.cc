@@ -25,9 +25,49 @@
 #include "gn/pool.h"
 #include "gn/source_file.h"
 #include "gn/target.h"
+#include "util/worker_pool.h"
 
 namespace {
 
+// The files referred to by a range of items, see CollectFileReferences().
+struct FileReferences {
+  std::vector<std::pair<SourceFile, size_t>> files;
+  std::vector<std::pair<std::string_view, size_t>> data;
+};
+
+// Appends the files that |item| (whose index is |index|) refers to directly
+// to |refs|. Files referred to by the sub-configs of a config are not
+// included, since the config depends on them.
+void CollectFileReferences(const Item* item,
+                           size_t index,
+                           FileReferences* refs) {
+  for (const auto& cur_file : item->build_dependency_files())
+    refs->files.emplace_back(cur_file, index);
+
+  const Target* target = item->AsTarget();
+  if (!target)
+    return;
+
+  for (const auto& cur_file : target->sources())
+    refs->files.emplace_back(cur_file, index);
+  for (const auto& cur_file : target->public_headers())
+    refs->files.emplace_back(cur_file, index);
+  for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
+    for (const auto& cur_file : iter.cur().inputs())
+      refs->files.emplace_back(cur_file, index);
+  }
+  for (const auto& cur_file : target->data())
+    refs->data.emplace_back(cur_file, index);
+
+  if (!target->action_values().script().is_null())
+    refs->files.emplace_back(target->action_values().script(), index);
+
+  std::vector<SourceFile> outputs;
+  target->action_values().GetOutputsAsSourceFiles(target, &outputs);
+  for (auto& cur_file : outputs)
+    refs->files.emplace_back(std::move(cur_file), index);
+}
+
 struct Inputs {
   std::vector<SourceFile> source_vec;
   std::vector<Label> compile_vec;
@@ -240,37 +280,64 @@ Analyzer::Analyzer(const Builder& builder,
       build_config_file_(build_config_file),
       dot_file_(dot_file),
       build_args_dependency_files_(build_args_dependency_files) {
+  item_indices_.reserve(all_items_.size());
+  for (size_t i = 0; i < all_items_.size(); i++)
+    item_indices_[all_items_[i]] = i;
+
+  // Pairs of (dependency, dependent) items.
+  std::vector<std::pair<const Item*, const Item*>> edges;
   for (const auto* item : all_items_) {
     labels_to_items_[item->label()] = item;
 
-    // Fill dep_map_.
     if (item->AsTarget()) {
       for (const auto& dep_target_pair :
            item->AsTarget()->GetDeps(Target::DEPS_ALL))
-        dep_map_.insert(std::make_pair(dep_target_pair.ptr, item));
+        edges.emplace_back(dep_target_pair.ptr, item);
 
       for (const auto& dep_config_pair : item->AsTarget()->configs())
-        dep_map_.insert(std::make_pair(dep_config_pair.ptr, item));
+        edges.emplace_back(dep_config_pair.ptr, item);
 
-      dep_map_.insert(std::make_pair(item->AsTarget()->toolchain(), item));
+      edges.emplace_back(item->AsTarget()->toolchain(), item);
 
       if (item->AsTarget()->IsBinary() ||
           item->AsTarget()->output_type() == Target::ACTION ||
           item->AsTarget()->output_type() == Target::ACTION_FOREACH) {
         const LabelPtrPair<Pool>& pool = item->AsTarget()->pool();
         if (pool.ptr)
-          dep_map_.insert(std::make_pair(pool.ptr, item));
+          edges.emplace_back(pool.ptr, item);
       }
     } else if (item->AsConfig()) {
       for (const auto& dep_config_pair : item->AsConfig()->configs())
-        dep_map_.insert(std::make_pair(dep_config_pair.ptr, item));
+        edges.emplace_back(dep_config_pair.ptr, item);
     } else if (item->AsToolchain()) {
       for (const auto& dep_pair : item->AsToolchain()->deps())
-        dep_map_.insert(std::make_pair(dep_pair.ptr, item));
+        edges.emplace_back(dep_pair.ptr, item);
     } else {
       DCHECK(item->AsPool());
     }
   }
+
+  // Fill the compressed dependents lists, grouping |edges| by dependency
+  // with a counting sort.
+  std::vector<std::pair<size_t, size_t>> index_edges;
+  index_edges.reserve(edges.size());
+  for (const auto& edge : edges) {
+    auto dep = item_indices_.find(edge.first);
+    if (dep != item_indices_.end())
+      index_edges.emplace_back(dep->second, item_indices_[edge.second]);
+  }
+  dependents_offsets_.assign(all_items_.size() + 1, 0);
+  for (const auto& edge : index_edges)
+    dependents_offsets_[edge.first + 1]++;
+  for (size_t i = 1; i < dependents_offsets_.size(); i++)
+    dependents_offsets_[i] += dependents_offsets_[i - 1];
+  dependents_.resize(index_edges.size());
+  std::vector<size_t> next(dependents_offsets_.begin(),
+                           dependents_offsets_.end() - 1);
+  for (const auto& edge : index_edges)
+    dependents_[next[edge.first]++] = edge.second;
+
+  BuildFileIndex();
 }
 
 Analyzer::~Analyzer() = default;
@@ -310,12 +377,11 @@ std::string Analyzer::Analyze(const std::string& input, Err* err) const {
     return OutputsToJSON(outputs, default_toolchain_, err);
   }
 
-  std::set<const Item*> affected_items =
-      GetAllAffectedItems(inputs.source_files);
+  std::vector<bool> affected_items = GetAllAffectedItems(inputs.source_files);
   TargetSet affected_targets;
-  for (const Item* affected_item : affected_items) {
-    if (affected_item->AsTarget())
-      affected_targets.insert(affected_item->AsTarget());
+  for (size_t i = 0; i < all_items_.size(); i++) {
+    if (affected_items[i] && all_items_[i]->AsTarget())
+      affected_targets.insert(all_items_[i]->AsTarget());
   }
 
   if (affected_targets.empty()) {
@@ -324,9 +390,10 @@ std::string Analyzer::Analyze(const std::string& input, Err* err) const {
   }
 
   TargetSet root_targets;
-  for (const auto* item : all_items_) {
-    if (item->AsTarget() && dep_map_.find(item) == dep_map_.end())
-      root_targets.insert(item->AsTarget());
+  for (size_t i = 0; i < all_items_.size(); i++) {
+    if (all_items_[i]->AsTarget() &&
+        dependents_offsets_[i] == dependents_offsets_[i + 1])
+      root_targets.insert(all_items_[i]->AsTarget());
   }
 
   TargetSet compile_targets = TargetsFor(inputs.compile_labels);
@@ -354,17 +421,26 @@ std::string Analyzer::Analyze(const std::string& input, Err* err) const {
   return OutputsToJSON(outputs, default_toolchain_, err);
 }
 
-std::set<const Item*> Analyzer::GetAllAffectedItems(
+std::vector<bool> Analyzer::GetAllAffectedItems(
     const std::set<const SourceFile*>& source_files) const {
-  std::set<const Item*> directly_affected_items;
+  std::vector<bool> affected_items(all_items_.size());
+  std::vector<size_t> to_visit;
   for (auto* source_file : source_files)
-    AddItemsDirectlyReferringToFile(source_file, &directly_affected_items);
-
-  std::set<const Item*> all_affected_items;
-  for (auto* affected_item : directly_affected_items)
-    AddAllItemsReferringToItem(affected_item, &all_affected_items);
-
-  return all_affected_items;
+    AddItemsDirectlyReferringToFile(source_file, &affected_items, &to_visit);
+
+  while (!to_visit.empty()) {
+    size_t index = to_visit.back();
+    to_visit.pop_back();
+    for (size_t i = dependents_offsets_[index];
+         i < dependents_offsets_[index + 1]; i++) {
+      size_t dependent = dependents_[i];
+      if (!affected_items[dependent]) {
+        affected_items[dependent] = true;
+        to_visit.push_back(dependent);
+      }
+    }
+  }
+  return affected_items;
 }
 
 std::set<Label> Analyzer::InvalidLabels(const std::set<Label>& labels) const {
@@ -409,80 +485,55 @@ void Analyzer::FilterTarget(const Target* target,
   }
 }
 
-bool Analyzer::ItemRefersToFile(const Item* item,
-                                const SourceFile* file) const {
-  for (const auto& cur_file : item->build_dependency_files()) {
-    if (cur_file == *file)
-      return true;
+void Analyzer::BuildFileIndex() {
+  std::vector<FileReferences> chunks(ParallelForRangeCount(all_items_.size()));
+  ParallelFor(all_items_.size(), [this, &chunks](size_t chunk, size_t begin,
+                                                 size_t end) {
+    for (size_t i = begin; i < end; i++)
+      CollectFileReferences(all_items_[i], i, &chunks[chunk]);
+  });
+
+  for (FileReferences& refs : chunks) {
+    for (auto& file : refs.files)
+      file_index_[std::move(file.first)].push_back(file.second);
+    for (const auto& data : refs.data)
+      data_index_[data.first].push_back(data.second);
   }
-
-  if (const Config* config = item->AsConfig()) {
-    for (const auto& config_pair : config->configs()) {
-      if (ItemRefersToFile(config_pair.ptr, file))
-        return true;
-    }
-  }
-
-  if (!item->AsTarget())
-    return false;
-
-  const Target* target = item->AsTarget();
-  for (const auto& cur_file : target->sources()) {
-    if (cur_file == *file)
-      return true;
-  }
-  for (const auto& cur_file : target->public_headers()) {
-    if (cur_file == *file)
-      return true;
-  }
-  for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
-    for (const auto& cur_file : iter.cur().inputs()) {
-      if (cur_file == *file)
-        return true;
-    }
-  }
-  for (const auto& cur_file : target->data()) {
-    if (cur_file == file->value())
-      return true;
-    if (cur_file.back() == '/' && file->value().starts_with(cur_file))
-      return true;
-  }
-
-  if (target->action_values().script().value() == file->value())
-    return true;
-
-  std::vector<SourceFile> outputs;
-  target->action_values().GetOutputsAsSourceFiles(target, &outputs);
-  for (const auto& cur_file : outputs) {
-    if (cur_file == *file)
-      return true;
-  }
-  return false;
 }
 
 void Analyzer::AddItemsDirectlyReferringToFile(
     const SourceFile* file,
-    std::set<const Item*>* directly_affected_items) const {
-  for (const auto* item : all_items_) {
-    if (ItemRefersToFile(item, file))
-      directly_affected_items->insert(item);
+    std::vector<bool>* affected_items,
+    std::vector<size_t>* to_visit) const {
+  auto add_items = [affected_items, to_visit](const std::vector<size_t>& items) {
+    for (size_t index : items) {
+      if (!(*affected_items)[index]) {
+        (*affected_items)[index] = true;
+        to_visit->push_back(index);
+      }
+    }
+  };
+
+  auto found = file_index_.find(*file);
+  if (found != file_index_.end())
+    add_items(found->second);
+
+  if (data_index_.empty())
+    return;
+
+  // Data entries match the file itself, or any directory containing it.
+  std::string_view value = file->value();
+  auto found_data = data_index_.find(value);
+  if (found_data != data_index_.end())
+    add_items(found_data->second);
+  for (size_t slash = value.find('/'); slash != std::string_view::npos;
+       slash = value.find('/', slash + 1)) {
+    found_data = data_index_.find(value.substr(0, slash + 1));
+    if (found_data != data_index_.end())
+      add_items(found_data->second);
   }
 }
 
-void Analyzer::AddAllItemsReferringToItem(
-    const Item* item,
-    std::set<const Item*>* all_affected_items) const {
-  if (all_affected_items->find(item) != all_affected_items->end())
-    return;  // Already found this item.
-
-  all_affected_items->insert(item);
-
-  auto dep_begin = dep_map_.lower_bound(item);
-  auto dep_end = dep_map_.upper_bound(item);
-  for (auto cur_dep = dep_begin; cur_dep != dep_end; ++cur_dep)
-    AddAllItemsReferringToItem(cur_dep->second, all_affected_items);
-}
-
 bool Analyzer::WereMainGNFilesModified(
     const std::set<const SourceFile*>& modified_files) const {
   for (const auto* file : modified_files) {
@@ -7,6 +7,8 @@
 
 #include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "gn/builder.h"
@@ -36,8 +38,9 @@ class Analyzer {
 
  private:
   // Returns the set of all items that might be affected, directly or
-  // indirectly, by modifications to the given source files.
-  std::set<const Item*> GetAllAffectedItems(
+  // indirectly, by modifications to the given source files, as a bitset
+  // indexed like |all_items_|.
+  std::vector<bool> GetAllAffectedItems(
       const std::set<const SourceFile*>& source_files) const;
 
   // Returns the set of labels that do not refer to objects in the graph.
@@ -73,14 +76,14 @@ class Analyzer {
   // (see Filter(), above).
   void FilterTarget(const Target*, TargetSet* seen, TargetSet* filtered) const;
 
-  bool ItemRefersToFile(const Item* item, const SourceFile* file) const;
+  // Fills |file_index_| and |data_index_|, processing items in parallel.
+  void BuildFileIndex();
 
-  void AddItemsDirectlyReferringToFile(
-      const SourceFile* file,
-      std::set<const Item*>* affected_items) const;
-
-  void AddAllItemsReferringToItem(const Item* item,
-                                  std::set<const Item*>* affected_items) const;
+  // Sets the bits of |affected_items| corresponding to the items that refer
+  // to |file| directly, and appends the newly set ones to |to_visit|.
+  void AddItemsDirectlyReferringToFile(const SourceFile* file,
+                                       std::vector<bool>* affected_items,
+                                       std::vector<size_t>* to_visit) const;
 
   // Main GN files stand for files whose context are used globally to execute
   // every other build files, this list includes dot file, build config file,
@@ -92,8 +95,27 @@ class Analyzer {
   std::map<Label, const Item*> labels_to_items_;
   Label default_toolchain_;
 
-  // Maps items to the list of items that depend on them.
-  std::multimap<const Item*, const Item*> dep_map_;
+  // Maps items to their index in |all_items_|.
+  std::unordered_map<const Item*, size_t> item_indices_;
+
+  // Indices of the items that depend on the item with index i are
+  // dependents_[dependents_offsets_[i]] to
+  // dependents_[dependents_offsets_[i + 1] - 1].
+  std::vector<size_t> dependents_offsets_;
+  std::vector<size_t> dependents_;
+
+  // Maps files to the indices of the items referring to them through their
+  // sources, public headers, inputs, script, outputs or build files.
+  std::unordered_map<SourceFile,
+                     std::vector<size_t>,
+                     SourceFile::PtrHash,
+                     SourceFile::PtrEqual>
+      file_index_;
+
+  // Maps the entries of the targets' data lists to the indices of the
+  // targets listing them. Entries ending with a slash refer to everything
+  // in that directory.
+  std::unordered_map<std::string_view, std::vector<size_t>> data_index_;
 
   const SourceFile build_config_file_;
   const SourceFile dot_file_;
@@ -291,6 +291,37 @@ TEST_F(AnalyzerTest, TargetRefersToData) {
       "}");
 }
 
+// Tests that a target is marked as affected if a file in one of the
+// directories listed in its data is modified.
+TEST_F(AnalyzerTest, TargetRefersToDataDirectory) {
+  std::unique_ptr<Target> t = MakeTarget("//dir", "target_name");
+  t->data().push_back("//dir/data/");
+  builder_.ItemDefined(std::move(t));
+  RunAnalyzerTest(
+      R"({
+       "files": [ "//dir/data_file.html" ],
+       "additional_compile_targets": [ "all" ],
+       "test_targets": [ "//dir:target_name" ]
+       })",
+      "{"
+      R"("compile_targets":[],)"
+      R"/("status":"No dependency",)/"
+      R"("test_targets":[])"
+      "}");
+
+  RunAnalyzerTest(
+      R"({
+       "files": [ "//dir/data/sub/file.html" ],
+       "additional_compile_targets": [ "all" ],
+       "test_targets": [ "//dir:target_name" ]
+       })",
+      "{"
+      R"("compile_targets":["all"],)"
+      R"/("status":"Found dependency",)/"
+      R"("test_targets":["//dir:target_name"])"
+      "}");
+}
+
 // Tests that a target is marked as affected if the target is an action and its
 // action script is modified.
 TEST_F(AnalyzerTest, TargetRefersToActionScript) {
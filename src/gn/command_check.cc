@@ -4,9 +4,17 @@
 
 #include <stddef.h>
 
+#include <memory>
+#include <set>
+
 #include "base/command_line.h"
+#include "base/files/file_util.h"
+#include "base/strings/string_split.h"
 #include "base/strings/stringprintf.h"
+#include "gn/build_settings.h"
 #include "gn/commands.h"
+#include "gn/filesystem_utils.h"
+#include "gn/header_check_state.h"
 #include "gn/header_checker.h"
 #include "gn/setup.h"
 #include "gn/standard_out.h"
@@ -16,6 +24,41 @@
 
 namespace commands {
 
+namespace {
+
+const char kSwitchChangedFiles[] = "changed-files";
+
+// Name of the file in the build directory with the state of the last check.
+const char kHeaderCheckStateFile[] = "header_check.state";
+
+// Reads the list of files given to --changed-files.
+bool ReadChangedFiles(const BuildSettings* build_settings,
+                      const base::FilePath& path,
+                      std::set<SourceFile>* changed_files,
+                      Err* err) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents)) {
+    *err = Err(Location(),
+               std::string("File for --") + kSwitchChangedFiles +
+                   " doesn't exist.",
+               "The file given was \"" + FilePathToUTF8(path) + "\"");
+    return false;
+  }
+
+  SourceDir root_dir("//");
+  for (const auto& line : base::SplitString(
+           contents, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    SourceFile file = root_dir.ResolveRelativeFile(
+        Value(nullptr, line), err, build_settings->root_path_utf8());
+    if (err->has_error())
+      return false;
+    changed_files->insert(std::move(file));
+  }
+  return true;
+}
+
+}  // namespace
+
 const char kNoGnCheck_Help[] =
     R"(nogncheck: Skip an include line from checking.
 
@@ -81,6 +124,21 @@ Command-specific switches
 
 )" DEFAULT_TOOLCHAIN_SWITCH_HELP
     R"(
+  --changed-files=<file>
+      Incremental check. <file> lists the files changed since the last check
+      in this build directory, one per line, either source-absolute
+      ("//foo/bar.cc") or relative to the source root. Only those files are
+      checked, along with all the files of the targets whose dependencies,
+      files or include dirs changed since then, and of the targets which
+      didn't pass. The errors reported for these files are the same as with
+      a full check. The first incremental check in a build directory checks
+      all the files. Checks without this switch don't use or update the
+      state of the incremental checks.
+
+      Changes to targets that the checked targets don't depend on, such as a
+      header moving between two unrelated targets, are only noticed by a full
+      check.
+
   --force
       Ignores specifications of "check_includes = false" and checks all
       target's files that match the target label.
@@ -272,8 +330,46 @@ bool CheckPublicHeaders(const BuildSettings* build_settings,
   scoped_refptr<HeaderChecker> header_checker(new HeaderChecker(
       build_settings, all_targets, check_generated, check_system));
 
+  // Incremental checks skip the files of the targets that passed the last
+  // one unchanged, and record the state for the next one. Other checks don't
+  // touch the state.
+  const base::CommandLine* cmdline = base::CommandLine::ForCurrentProcess();
+  std::unique_ptr<HeaderCheckState> state;
+  base::FilePath state_path;
+  std::set<SourceFile> changed_files;
+  HeaderChecker::FileFilter should_check;
+  if (cmdline->HasSwitch(kSwitchChangedFiles)) {
+    Err err;
+    if (!ReadChangedFiles(build_settings,
+                          cmdline->GetSwitchValuePath(kSwitchChangedFiles),
+                          &changed_files, &err)) {
+      err.PrintToStdout();
+      return false;
+    }
+    state = std::make_unique<HeaderCheckState>(base::StringPrintf(
+        "force=%d generated=%d system=%d", force_check, check_generated,
+        check_system));
+    state_path = build_settings->GetFullPath(SourceFile(
+        build_settings->build_dir().value() + kHeaderCheckStateFile));
+    state->Load(state_path);
+    should_check = [&state, &changed_files](const Target* target,
+                                            const SourceFile& file) {
+      return changed_files.count(file) || !state->IsUpToDate(target);
+    };
+  }
+
   std::vector<Err> header_errors;
-  header_checker->Run(to_check, force_check, &header_errors);
+  std::set<const Target*> failed_targets;
+  header_checker->Run(to_check, force_check, should_check, &failed_targets,
+                      &header_errors);
+
+  if (state) {
+    for (const Target* target : to_check) {
+      if (target->IsBinary())
+        state->SetChecked(target, !failed_targets.count(target));
+    }
+    state->Save(state_path);
+  }
   for (size_t i = 0; i < header_errors.size(); i++) {
     if (i > 0)
       OutputString("___________________\n", DECORATION_YELLOW);
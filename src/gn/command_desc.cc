@@ -8,9 +8,12 @@
 #include <memory>
 #include <set>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 #include "base/command_line.h"
 #include "base/json/json_writer.h"
+#include "base/json/string_escape.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "gn/commands.h"
@@ -23,6 +26,7 @@
 #include "gn/switches.h"
 #include "gn/target.h"
 #include "gn/variables.h"
+#include "util/build_config.h"
 
 namespace commands {
 
@@ -325,14 +329,10 @@ void HandleProperty(const std::string& what,
 }
 
 bool PrintTarget(const Target* target,
+                 std::unique_ptr<base::DictionaryValue> dict,
                  const std::string& what,
                  bool single_target,
-                 const std::map<std::string, DescHandlerFunc>& handler_map,
-                 bool all,
-                 bool tree,
-                 bool blame) {
-  std::unique_ptr<base::DictionaryValue> dict =
-      DescBuilder::DescriptionForTarget(target, what, all, tree, blame);
+                 const std::map<std::string, DescHandlerFunc>& handler_map) {
   if (!what.empty() && dict->empty()) {
     OutputString("Don't know how to display \"" + what + "\" for \"" +
                  Target::GetStringForOutputType(target->output_type()) +
@@ -473,6 +473,39 @@ bool PrintConfig(const Config* config,
   return true;
 }
 
+#if defined(OS_WIN)
+const char kJSONLineEnding[] = "\r\n";
+#else
+const char kJSONLineEnding[] = "\n";
+#endif
+
+// Returns the pretty printed JSON of a dictionary given its entries, as
+// (key, value) pairs where the values were rendered at depth 1 with
+// base::JSONWriter::WriteFragmentWithOptions(). The output is the same as
+// base::JSONWriter::WriteWithOptions() would give for the dictionary.
+std::string JSONDictionaryFromFragments(
+    std::vector<std::pair<std::string, std::string>> entries) {
+  std::sort(entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::string result = "{";
+  result.append(kJSONLineEnding);
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (i > 0) {
+      result.push_back(',');
+      result.append(kJSONLineEnding);
+    }
+    result.append("   ");
+    base::EscapeJSONString(entries[i].first, true, &result);
+    result.append(": ");
+    result.append(entries[i].second);
+  }
+  result.append(kJSONLineEnding);
+  result.push_back('}');
+  result.append(kJSONLineEnding);
+  return result;
+}
+
 }  // namespace
 
 // desc ------------------------------------------------------------------------
@@ -694,42 +727,58 @@ int RunDesc(const std::vector<std::string>& args) {
   }
 
   if (json) {
-    // Convert all targets/configs to JSON, serialize and print them
-    auto res = std::make_unique<base::DictionaryValue>();
+    // Convert all targets/configs to JSON, serialize and print them. Each
+    // description is rendered separately, in parallel, and printed in the
+    // key order of the dictionary that would contain all of them.
+    std::vector<std::pair<std::string, std::string>> entries;
     if (!target_matches.empty()) {
-      for (const auto* target : target_matches) {
-        res->SetWithoutPathExpansion(
-            target->label().GetUserVisibleName(
-                target->settings()->default_toolchain_label()),
-            DescBuilder::DescriptionForTarget(
-                target, what_to_print, cmdline->HasSwitch(kAll),
-                cmdline->HasSwitch(kTree), cmdline->HasSwitch(kBlame)));
-      }
+      entries.resize(target_matches.size());
+      DescBuilder::DescribeTargets(
+          target_matches.vector(), what_to_print, cmdline->HasSwitch(kAll),
+          cmdline->HasSwitch(kTree), cmdline->HasSwitch(kBlame),
+          [&target_matches, &entries](
+              size_t i, std::unique_ptr<base::DictionaryValue> description) {
+            const Target* target = target_matches[i];
+            entries[i].first = target->label().GetUserVisibleName(
+                target->settings()->default_toolchain_label());
+            base::JSONWriter::WriteFragmentWithOptions(
+                *description, base::JSONWriter::OPTIONS_PRETTY_PRINT, 1,
+                &entries[i].second);
+          });
     } else if (!config_matches.empty()) {
       for (const auto* config : config_matches) {
-        res->SetWithoutPathExpansion(
-            config->label().GetUserVisibleName(false),
-            DescBuilder::DescriptionForConfig(config, what_to_print));
+        std::pair<std::string, std::string>& entry = entries.emplace_back();
+        entry.first = config->label().GetUserVisibleName(false);
+        base::JSONWriter::WriteFragmentWithOptions(
+            *DescBuilder::DescriptionForConfig(config, what_to_print),
+            base::JSONWriter::OPTIONS_PRETTY_PRINT, 1, &entry.second);
       }
     }
-    std::string s;
-    base::JSONWriter::WriteWithOptions(
-        *res.get(), base::JSONWriter::OPTIONS_PRETTY_PRINT, &s);
-    OutputString(s);
+    OutputString(JSONDictionaryFromFragments(std::move(entries)));
   } else {
     // Regular (non-json) formatted output
     bool multiple_outputs = (target_matches.size() + config_matches.size()) > 1;
     std::map<std::string, DescHandlerFunc> handlers = GetHandlers();
 
+    // The descriptions are computed in parallel but printed in order.
+    std::vector<std::unique_ptr<base::DictionaryValue>> descriptions(
+        target_matches.size());
+    DescBuilder::DescribeTargets(
+        target_matches.vector(), what_to_print, cmdline->HasSwitch(kAll),
+        cmdline->HasSwitch(kTree), cmdline->HasSwitch(kBlame),
+        [&descriptions](size_t i,
+                        std::unique_ptr<base::DictionaryValue> description) {
+          descriptions[i] = std::move(description);
+        });
+
     bool printed_output = false;
-    for (const Target* target : target_matches) {
+    for (size_t i = 0; i < target_matches.size(); i++) {
       if (printed_output)
         OutputString("\n\n");
       printed_output = true;
 
-      if (!PrintTarget(target, what_to_print, !multiple_outputs, handlers,
-                       cmdline->HasSwitch(kAll), cmdline->HasSwitch(kTree),
-                       cmdline->HasSwitch(kBlame)))
+      if (!PrintTarget(target_matches[i], std::move(descriptions[i]),
+                       what_to_print, !multiple_outputs, handlers))
         return 1;
     }
     for (const Config* config : config_matches) {
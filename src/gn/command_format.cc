@@ -6,6 +6,8 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <set>
 #include <sstream>
 
 #include "base/command_line.h"
@@ -13,6 +15,7 @@
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
 #include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/string_util.h"
 #include "gn/commands.h"
 #include "gn/filesystem_utils.h"
@@ -24,7 +27,9 @@
 #include "gn/string_utils.h"
 #include "gn/switches.h"
 #include "gn/tokenizer.h"
+#include "util/atomic_write.h"
 #include "util/build_config.h"
+#include "util/worker_pool.h"
 
 #if defined(OS_WIN)
 #include <fcntl.h>
@@ -35,6 +40,7 @@ namespace commands {
 
 const char kSwitchDryRun[] = "dry-run";
 const char kSwitchDumpTree[] = "dump-tree";
+const char kSwitchFileList[] = "file-list";
 const char kSwitchReadTree[] = "read-tree";
 const char kSwitchStdin[] = "stdin";
 const char kSwitchTreeTypeJSON[] = "json";
@@ -43,7 +49,8 @@ const char kSwitchTreeTypeText[] = "text";
 const char kFormat[] = "format";
 const char kFormat_HelpShort[] = "format: Format .gn files.";
 const char kFormat_Help[] =
-    R"(gn format [--dump-tree] (--stdin | <list of build_files...>)
+    R"(gn format [--dump-tree] (--stdin | <list of build_files...> |
+                            --file-list=<file>))
 
   Formats .gn file to a standard format.
 
@@ -70,6 +77,12 @@ Arguments
       Dumps the parse tree to stdout and does not update the file or print
       formatted output. If no format is specified, text format will be used.
 
+  --file-list=<file>
+      Also formats the build files listed in <file>, one per line, or in
+      stdin if <file> is "-". This is convenient for formatting many files at
+      once, which are processed in parallel. A summary of the results is
+      printed at the end.
+
   --stdin
       Read input from stdin and write to stdout rather than update a file
       in-place.
@@ -85,6 +98,7 @@ Examples
   gn format some\\BUILD.gn
   gn format /abspath/some/BUILD.gn
   gn format --stdin
+  git ls-files "*.gn" "*.gni" | gn format --file-list=-
   gn format --read-tree=json //rewritten/BUILD.gn
 )";
 
@@ -1255,6 +1269,91 @@ void DoFormat(const ParseNode* root,
   *output = pr.String();
 }
 
+// Same as FormatStringToString(), but leaves the error in |err| rather than
+// printing it. The error points into |file|, which must outlive it.
+bool FormatInputFile(InputFile* file,
+                     TreeDumpMode dump_tree,
+                     std::string* output,
+                     std::string* dump_output,
+                     Err* err) {
+  // Tokenize.
+  std::vector<Token> tokens =
+      Tokenizer::Tokenize(file, err, WhitespaceTransform::kInvalidToSpace);
+  if (err->has_error())
+    return false;
+
+  // Parse.
+  std::unique_ptr<ParseNode> parse_node = Parser::Parse(tokens, err);
+  if (err->has_error())
+    return false;
+
+  DoFormat(parse_node.get(), dump_tree, output, dump_output);
+  return true;
+}
+
+// Number of files formatted concurrently before their results are printed.
+constexpr size_t kFilesPerBatch = 1024;
+
+// The formatting of one of the files given on the command line.
+struct FormatFileJob {
+  // As given on the command line.
+  std::string arg;
+  base::FilePath path;
+
+  // Owns the contents pointed to by |err|.
+  std::unique_ptr<InputFile> input_file;
+
+  // The error to print for this file, if any.
+  Err err;
+  std::string dump_output;
+  bool changed = false;
+};
+
+// Reads, formats and, unless this is a dry run, updates the given file.
+void FormatFile(TreeDumpMode dump_tree, bool dry_run, FormatFileJob* job) {
+  std::string original_contents;
+  if (!base::ReadFileToString(job->path, &original_contents)) {
+    job->err = Err(Location(),
+                   std::string("Couldn't read \"") + FilePathToUTF8(job->path));
+    return;
+  }
+
+  job->input_file = std::make_unique<InputFile>(SourceFile());
+  job->input_file->SetContents(original_contents);
+  std::string output_string;
+  if (!FormatInputFile(job->input_file.get(), dump_tree, &output_string,
+                       &job->dump_output, &job->err))
+    return;
+  if (dump_tree != TreeDumpMode::kInactive)
+    return;
+
+  job->changed = original_contents != output_string;
+  if (job->changed && !dry_run) {
+    // Update the file in-place. It is replaced by a new file, so write
+    // through symbolic links and keep the permissions of the original.
+    base::FilePath real_path = base::MakeAbsoluteFilePath(job->path);
+    if (real_path.empty())
+      real_path = job->path;
+#if defined(OS_POSIX)
+    int mode = 0;
+    bool has_mode = base::GetPosixFilePermissions(real_path, &mode);
+#endif
+    if (util::WriteFileAtomically(real_path, output_string.data(),
+                                  static_cast<int>(output_string.size())) ==
+        -1) {
+      job->err =
+          Err(Location(),
+              std::string("Failed to write formatted output back to \"") +
+                  FilePathToUTF8(job->path) + std::string("\"."));
+      return;
+    }
+#if defined(OS_POSIX)
+    if (has_mode)
+      base::SetPosixFilePermissions(real_path, mode);
+#endif
+  }
+}
+
 }  // namespace
 
 bool FormatJsonToString(const std::string& json, std::string* output) {
@@ -1273,25 +1372,108 @@ bool FormatStringToString(const std::string& input,
   InputFile file(source_file);
   file.SetContents(input);
   Err err;
-  // Tokenize.
-  std::vector<Token> tokens =
-      Tokenizer::Tokenize(&file, &err, WhitespaceTransform::kInvalidToSpace);
-  if (err.has_error()) {
+  if (!FormatInputFile(&file, dump_tree, output, dump_output, &err)) {
     err.PrintToStdout();
     return false;
   }
+  return true;
+}
 
-  // Parse.
-  std::unique_ptr<ParseNode> parse_node = Parser::Parse(tokens, &err);
-  if (err.has_error()) {
-    err.PrintToStdout();
+bool ReadFileList(const std::string& list_file,
+                  std::vector<std::string>* files,
+                  Err* err) {
+  std::string contents;
+  if (list_file == "-") {
+    contents = ReadStdin();
+  } else if (!base::ReadFileToString(UTF8ToFilePath(list_file), &contents)) {
+    *err = Err(Location(), std::string("File for --") + kSwitchFileList +
+                               " doesn't exist.",
+               "The file given was \"" + list_file + "\"");
     return false;
   }
-
-  DoFormat(parse_node.get(), dump_tree, output, dump_output);
+  for (auto& line : base::SplitString(contents, "\n", base::TRIM_WHITESPACE,
+                                      base::SPLIT_WANT_NONEMPTY))
+    files->push_back(std::move(line));
   return true;
 }
 
+FormatFilesResult FormatFiles(const BuildSettings& build_settings,
+                              const SourceDir& source_dir,
+                              const std::vector<std::string>& files,
+                              TreeDumpMode dump_tree,
+                              bool dry_run,
+                              bool quiet) {
+  // A file given more than once, possibly spelled differently, is formatted
+  // once, at its first occurrence: formatting it concurrently would write it
+  // twice.
+  std::vector<FormatFileJob> jobs;
+  jobs.reserve(files.size());
+  std::set<base::FilePath> seen_paths;
+  for (const std::string& arg : files) {
+    FormatFileJob job;
+    job.arg = arg;
+    SourceFile file =
+        source_dir.ResolveRelativeFile(Value(nullptr, job.arg), &job.err);
+    if (!job.err.has_error()) {
+      job.path = build_settings.GetFullPath(file);
+      base::FilePath real_path = base::MakeAbsoluteFilePath(job.path);
+      if (!seen_paths.insert(real_path.empty() ? job.path : real_path).second)
+        continue;
+    }
+    jobs.push_back(std::move(job));
+  }
+
+  FormatFilesResult result;
+  result.checked_count = jobs.size();
+  for (size_t batch_begin = 0; batch_begin < jobs.size();
+       batch_begin += kFilesPerBatch) {
+    size_t batch_end = std::min(jobs.size(), batch_begin + kFilesPerBatch);
+
+    // Files are formatted concurrently, but their results are printed in the
+    // order in which they were given.
+    FormatFileJob* batch = jobs.data() + batch_begin;
+    ParallelFor(batch_end - batch_begin, [batch, dump_tree, dry_run](
+                                             size_t, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        if (!batch[i].err.has_error())
+          FormatFile(dump_tree, dry_run, &batch[i]);
+      }
+    });
+
+    for (size_t i = batch_begin; i < batch_end; i++) {
+      FormatFileJob& job = jobs[i];
+      if (job.err.has_error()) {
+        job.err.PrintToStdout();
+        result.exit_code = 1;
+        result.failed_count++;
+      } else {
+        printf("%s", job.dump_output.c_str());
+        if (job.changed) {
+          result.changed_count++;
+          if (dry_run) {
+            printf("%s\n", job.arg.c_str());
+            result.exit_code = 2;
+          } else if (!quiet) {
+            printf("Wrote formatted to '%s'.\n",
+                   FilePathToUTF8(job.path).c_str());
+          }
+        }
+      }
+      // Releases the contents of the file.
+      job = FormatFileJob();
+    }
+  }
+
+  return result;
+}
+
+std::string FormatFilesSummary(const FormatFilesResult& result, bool dry_run) {
+  return base::StringPrintf(
+      "%zu file%s checked, %zu %s, %zu failed.", result.checked_count,
+      result.checked_count == 1 ? "" : "s", result.changed_count,
+      dry_run ? "would be reformatted" : "reformatted", result.failed_count);
+}
+
 int RunFormat(const std::vector<std::string>& args) {
 #if defined(OS_WIN)
   // Set to binary mode to prevent converting newlines to \r\n.
@@ -1332,7 +1514,8 @@ int RunFormat(const std::vector<std::string>& args) {
       base::CommandLine::ForCurrentProcess()->HasSwitch(switches::kQuiet);
 
   if (from_stdin) {
-    if (args.size() != 0) {
+    if (args.size() != 0 ||
+        base::CommandLine::ForCurrentProcess()->HasSwitch(kSwitchFileList)) {
       Err(Location(), "Expecting no arguments when reading from stdin.\n")
           .PrintToStdout();
       return 1;
@@ -1347,7 +1530,21 @@ int RunFormat(const std::vector<std::string>& args) {
     return 0;
   }
 
-  if (args.size() == 0) {
+  std::vector<std::string> files = args;
+  bool has_file_list =
+      base::CommandLine::ForCurrentProcess()->HasSwitch(kSwitchFileList);
+  if (has_file_list) {
+    Err err;
+    if (!ReadFileList(
+            base::CommandLine::ForCurrentProcess()->GetSwitchValueString(
+                kSwitchFileList),
+            &files, &err)) {
+      err.PrintToStdout();
+      return 1;
+    }
+  }
+
+  if (files.size() == 0) {
     Err(Location(), "Expecting one or more arguments, see `gn help format`.\n")
         .PrintToStdout();
     return 1;
@@ -1366,7 +1563,7 @@ int RunFormat(const std::vector<std::string>& args) {
       return 1;
     }
 
-    if (args.size() != 1) {
+    if (files.size() != 1) {
       Err(Location(),
           "Expect exactly one .gn when reading tree from json on stdin.\n")
           .PrintToStdout();
@@ -1374,7 +1571,7 @@ int RunFormat(const std::vector<std::string>& args) {
     }
     Err err;
     SourceFile file =
-        source_dir.ResolveRelativeFile(Value(nullptr, args[0]), &err);
+        source_dir.ResolveRelativeFile(Value(nullptr, files[0]), &err);
     if (err.has_error()) {
       err.PrintToStdout();
       return 1;
@@ -1396,64 +1593,15 @@ int RunFormat(const std::vector<std::string>& args) {
     return 0;
   }
 
-  // TODO(scottmg): Eventually, this list of files should be processed in
-  // parallel.
-  int exit_code = 0;
-  for (const auto& arg : args) {
-    Err err;
-    SourceFile file = source_dir.ResolveRelativeFile(Value(nullptr, arg), &err);
-    if (err.has_error()) {
-      err.PrintToStdout();
-      exit_code = 1;
-      continue;
-    }
-
-    base::FilePath to_format = setup.build_settings().GetFullPath(file);
-    std::string original_contents;
-    if (!base::ReadFileToString(to_format, &original_contents)) {
-      Err(Location(),
-          std::string("Couldn't read \"") + FilePathToUTF8(to_format))
-          .PrintToStdout();
-      exit_code = 1;
-      continue;
-    }
+  FormatFilesResult result = FormatFiles(setup.build_settings(), source_dir,
+                                         files, dump_tree, dry_run, quiet);
 
-    std::string output_string;
-    std::string dump_output_string;
-    if (!FormatStringToString(original_contents, dump_tree, &output_string,
-                              &dump_output_string)) {
-      exit_code = 1;
-      continue;
-    }
-    printf("%s", dump_output_string.c_str());
-    if (dump_tree == TreeDumpMode::kInactive) {
-      if (dry_run) {
-        if (original_contents != output_string) {
-          printf("%s\n", arg.c_str());
-          exit_code = 2;
-        }
-        continue;
-      }
-      // Update the file in-place.
-      if (original_contents != output_string) {
-        if (base::WriteFile(to_format, output_string.data(),
-                            static_cast<int>(output_string.size())) == -1) {
-          Err(Location(),
-              std::string("Failed to write formatted output back to \"") +
-                  FilePathToUTF8(to_format) + std::string("\"."))
-              .PrintToStdout();
-          exit_code = 1;
-          continue;
-        }
-        if (!quiet) {
-          printf("Wrote formatted to '%s'.\n",
-                 FilePathToUTF8(to_format).c_str());
-        }
-      }
-    }
-  }
+  // Only files listed with --file-list get a summary, so that the output of
+  // existing invocations is unchanged.
+  if (has_file_list && !quiet && dump_tree == TreeDumpMode::kInactive)
+    printf("%s\n", FormatFilesSummary(result, dry_run).c_str());
 
-  return exit_code;
+  return result.exit_code;
 }
 
 }  // namespace commands
@@ -5,9 +5,15 @@
 #ifndef TOOLS_GN_COMAND_FORMAT_H_
 #define TOOLS_GN_COMAND_FORMAT_H_
 
+#include <stddef.h>
+
 #include <string>
+#include <vector>
 
+class BuildSettings;
+class Err;
 class Setup;
+class SourceDir;
 class SourceFile;
 
 namespace commands {
@@ -31,6 +37,36 @@ bool FormatStringToString(const std::string& input,
                           std::string* output,
                           std::string* dump_output);
 
+// Appends the files listed in |list_file|, one per line, to |files|. Reads
+// the list from stdin if |list_file| is "-".
+bool ReadFileList(const std::string& list_file,
+                  std::vector<std::string>* files,
+                  Err* err);
+
+struct FormatFilesResult {
+  // The exit code of "gn format", see its help.
+  int exit_code = 0;
+
+  // Numbers of distinct files formatted, of files that were (or, for a dry
+  // run, would be) reformatted, and of files that couldn't be formatted.
+  size_t checked_count = 0;
+  size_t changed_count = 0;
+  size_t failed_count = 0;
+};
+
+// Formats the given build files, resolved against |source_dir|, and prints
+// their results in order. A file given more than once is formatted once.
+// Unless this is a |dry_run|, the files are updated in place.
+FormatFilesResult FormatFiles(const BuildSettings& build_settings,
+                              const SourceDir& source_dir,
+                              const std::vector<std::string>& files,
+                              TreeDumpMode dump_tree,
+                              bool dry_run,
+                              bool quiet);
+
+// Returns the summary printed after formatting the files of --file-list.
+std::string FormatFilesSummary(const FormatFilesResult& result, bool dry_run);
+
 }  // namespace commands
 
 #endif  // TOOLS_GN_COMAND_FORMAT_H_
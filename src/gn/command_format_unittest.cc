@@ -4,14 +4,24 @@
 
 #include "gn/command_format.h"
 
+#include <stdio.h>
+
 #include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/strings/string_util.h"
+#include "gn/build_settings.h"
 #include "gn/commands.h"
+#include "gn/filesystem_utils.h"
 #include "gn/setup.h"
 #include "gn/test_with_scheduler.h"
+#include "util/build_config.h"
 #include "util/exe_path.h"
 #include "util/test/test.h"
 
+#if defined(OS_POSIX)
+#include <unistd.h>
+#endif
+
 using FormatTest = TestWithScheduler;
 
 #define FORMAT_TEST(n)                                                      \
@@ -137,3 +147,119 @@ FORMAT_TEST(081)
 FORMAT_TEST(082)
 FORMAT_TEST(083)
 FORMAT_TEST(084)
+
+TEST_F(FormatTest, ReadFileList) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath list_path = temp_dir.GetPath().AppendASCII("list.txt");
+  std::string list = "a/BUILD.gn\n\n  b/BUILD.gn  \r\n//c/BUILD.gn";
+  Err err;
+  ASSERT_TRUE(WriteFile(list_path, list, &err));
+  std::vector<std::string> expected = {"a/BUILD.gn", "b/BUILD.gn",
+                                       "//c/BUILD.gn"};
+
+  // Files are appended to the ones given on the command line.
+  std::vector<std::string> files = {"BUILD.gn"};
+  EXPECT_TRUE(commands::ReadFileList(FilePathToUTF8(list_path), &files, &err));
+  EXPECT_FALSE(err.has_error());
+  ASSERT_EQ(4u, files.size());
+  EXPECT_EQ("BUILD.gn", files[0]);
+  EXPECT_EQ(expected,
+            std::vector<std::string>(files.begin() + 1, files.end()));
+
+#if defined(OS_POSIX)
+  // "-" reads the list from stdin.
+  FILE* list_file = fopen(FilePathToUTF8(list_path).c_str(), "r");
+  ASSERT_TRUE(list_file);
+  int saved_stdin = dup(STDIN_FILENO);
+  ASSERT_NE(-1, dup2(fileno(list_file), STDIN_FILENO));
+  files.clear();
+  bool read = commands::ReadFileList("-", &files, &err);
+  dup2(saved_stdin, STDIN_FILENO);
+  close(saved_stdin);
+  fclose(list_file);
+  clearerr(stdin);
+  EXPECT_TRUE(read);
+  EXPECT_EQ(expected, files);
+#endif
+
+  EXPECT_FALSE(commands::ReadFileList(
+      FilePathToUTF8(temp_dir.GetPath().AppendASCII("missing.txt")), &files,
+      &err));
+  EXPECT_TRUE(err.has_error());
+}
+
+TEST_F(FormatTest, FormatFiles) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  BuildSettings build_settings;
+  build_settings.SetRootPath(temp_dir.GetPath());
+  SourceDir source_dir("//");
+
+  std::string unformatted = "group(\"b\"){deps=[\":a\"]}";
+  std::string formatted;
+  ASSERT_TRUE(commands::FormatStringToString(
+      unformatted, commands::TreeDumpMode::kInactive, &formatted, nullptr));
+  ASSERT_NE(unformatted, formatted);
+  Err err;
+  for (const char* dir : {"a", "b", "c"})
+    ASSERT_TRUE(base::CreateDirectory(temp_dir.GetPath().AppendASCII(dir)));
+  base::FilePath a_path =
+      temp_dir.GetPath().AppendASCII("a").AppendASCII("BUILD.gn");
+  base::FilePath b_path =
+      temp_dir.GetPath().AppendASCII("b").AppendASCII("BUILD.gn");
+  ASSERT_TRUE(WriteFile(a_path, formatted, &err));
+  ASSERT_TRUE(WriteFile(b_path, unformatted, &err));
+  ASSERT_TRUE(WriteFile(
+      temp_dir.GetPath().AppendASCII("c").AppendASCII("BUILD.gn"), "group(",
+      &err));
+  auto format = [&](const std::vector<std::string>& files, bool dry_run) {
+    return commands::FormatFiles(build_settings, source_dir, files,
+                                 commands::TreeDumpMode::kInactive, dry_run,
+                                 true);
+  };
+
+  // Files spelled differently but resolving to the same path are formatted
+  // once.
+  commands::FormatFilesResult result =
+      format({"a/BUILD.gn", "//a/BUILD.gn", "b/../a/BUILD.gn",
+              FilePathToUTF8(a_path)},
+             true);
+  EXPECT_EQ(0, result.exit_code);
+  EXPECT_EQ(1u, result.checked_count);
+  EXPECT_EQ(0u, result.changed_count);
+  EXPECT_EQ(0u, result.failed_count);
+  EXPECT_EQ("1 file checked, 0 would be reformatted, 0 failed.",
+            commands::FormatFilesSummary(result, true));
+
+  // A dry run reports the files to reformat without writing them.
+  result = format({"a/BUILD.gn", "b/BUILD.gn", "//b/BUILD.gn"}, true);
+  EXPECT_EQ(2, result.exit_code);
+  EXPECT_EQ(2u, result.checked_count);
+  EXPECT_EQ(1u, result.changed_count);
+  EXPECT_EQ(0u, result.failed_count);
+  EXPECT_EQ("2 files checked, 1 would be reformatted, 0 failed.",
+            commands::FormatFilesSummary(result, true));
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(b_path, &contents));
+  EXPECT_EQ(unformatted, contents);
+
+  // Files that can't be formatted fail the batch, and the others are still
+  // formatted.
+  result = format({"c/BUILD.gn", "a/BUILD.gn", "missing/BUILD.gn"}, true);
+  EXPECT_EQ(1, result.exit_code);
+  EXPECT_EQ(3u, result.checked_count);
+  EXPECT_EQ(0u, result.changed_count);
+  EXPECT_EQ(2u, result.failed_count);
+  EXPECT_EQ("3 files checked, 0 would be reformatted, 2 failed.",
+            commands::FormatFilesSummary(result, true));
+
+  // Otherwise, the files are updated.
+  result = format({"a/BUILD.gn", "b/BUILD.gn"}, false);
+  EXPECT_EQ(0, result.exit_code);
+  EXPECT_EQ(1u, result.changed_count);
+  EXPECT_EQ("2 files checked, 1 reformatted, 0 failed.",
+            commands::FormatFilesSummary(result, false));
+  ASSERT_TRUE(base::ReadFileToString(b_path, &contents));
+  EXPECT_EQ(formatted, contents);
+}
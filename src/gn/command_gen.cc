@@ -4,11 +4,13 @@
 
 #include <inttypes.h>
 
+#include <deque>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
 
 #include "base/command_line.h"
+#include "base/files/file_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/timer/elapsed_timer.h"
@@ -17,12 +19,17 @@
 #include "gn/compile_commands_writer.h"
 #include "gn/eclipse_writer.h"
 #include "gn/filesystem_utils.h"
+#include "gn/graph_snapshot.h"
+#include "gn/input_file_manager.h"
 #include "gn/json_project_writer.h"
 #include "gn/label_pattern.h"
+#include "gn/ninja_logs.h"
 #include "gn/ninja_outputs_writer.h"
 #include "gn/ninja_target_writer.h"
 #include "gn/ninja_tools.h"
 #include "gn/ninja_writer.h"
+#include "gn/output_sink.h"
+#include "gn/path_output_cache.h"
 #include "gn/qt_creator_writer.h"
 #include "gn/runtime_deps.h"
 #include "gn/rust_project_writer.h"
@@ -40,6 +47,7 @@ namespace {
 
 const char kSwitchCheck[] = "check";
 const char kSwitchCleanStale[] = "clean-stale";
+const char kSwitchGraphSnapshot[] = "graph-snapshot";
 const char kSwitchFilters[] = "filters";
 const char kSwitchIde[] = "ide";
 const char kSwitchIdeValueEclipse[] = "eclipse";
@@ -74,51 +82,106 @@ const char kSwitchJsonFileName[] = "json-file-name";
 const char kSwitchJsonIdeScript[] = "json-ide-script";
 const char kSwitchJsonIdeScriptArgs[] = "json-ide-script-args";
 const char kSwitchExportCompileCommands[] = "export-compile-commands";
+const char kSwitchShardCompileCommands[] = "shard-compile-commands";
 const char kSwitchExportRustProject[] = "export-rust-project";
 
-// A map type used to implement --ide=ninja_outputs
-using NinjaOutputsMap = NinjaOutputsWriter::MapType;
+// The result of writing the ninja file of one target. Slots are allocated on
+// the main thread when the target is scheduled for writing, and only written
+// by the worker thread that handles that target, so collecting the results
+// doesn't require any locking.
+struct TargetWriteSlot {
+  explicit TargetWriteSlot(const Target* t) : target(t) {}
+
+  const Target* target;
+  std::string rule;
+  NinjaOutputsWriter::TargetEntry ninja_outputs;
+  std::vector<std::string> live_outputs;
+};
 
-// Collects Ninja rules for each toolchain. The lock protects the rules
+// Collects Ninja rules for each toolchain. The lock protects |resolved_map|.
 struct TargetWriteInfo {
-  // Set this to true to populate |ninja_outputs_map| below.
+  // Set this to true to populate |ninja_outputs| below.
   bool want_ninja_outputs = false;
 
-  std::mutex lock;
+  // Set this to true to populate |live_outputs| below.
+  bool want_live_outputs = false;
+
+  // Only modified on the main thread. A deque is used so that the slots
+  // handed to worker threads stay at a stable address.
+  std::deque<TargetWriteSlot> slots;
+
+  // Filled from |slots| by CollectSlots() once all targets have been
+  // written.
   NinjaWriter::PerToolchainRules rules;
+  NinjaOutputsWriter::EntryList ninja_outputs;
 
-  NinjaOutputsMap ninja_outputs_map;
+  // Canonical paths of all the nodes of the generated Ninja graph, which
+  // --clean-stale must not delete.
+  NinjaOutputSet live_outputs;
 
+  // Writes the per-target .ninja files in the background.
+  OutputSink sink;
+
+  std::mutex lock;
   using ResolvedMap = std::unordered_map<std::thread::id, ResolvedTargetData>;
   std::unique_ptr<ResolvedMap> resolved_map = std::make_unique<ResolvedMap>();
 
+  // Moves the results from |slots| to the per-toolchain containers above,
+  // in a deterministic order. Called on the main thread once all the
+  // background writes have completed.
+  void CollectSlots() {
+    for (TargetWriteSlot& slot : slots) {
+      rules[slot.target->toolchain()].emplace_back(slot.target,
+                                                   std::move(slot.rule));
+      for (std::string& output : slot.live_outputs)
+        live_outputs.insert(std::move(output));
+      if (want_ninja_outputs)
+        ninja_outputs.push_back(std::move(slot.ninja_outputs));
+    }
+    slots.clear();
+
+    // This makes the ninja files have deterministic content.
+    NinjaWriter::SortRules(&rules);
+  }
+
   void LeakOnPurpose() { (void)resolved_map.release(); }
 };
 
 // Called on worker thread to write the ninja file.
-void BackgroundDoWrite(TargetWriteInfo* write_info, const Target* target) {
+void BackgroundDoWrite(TargetWriteInfo* write_info, TargetWriteSlot* slot) {
+  const Target* target = slot->target;
   ResolvedTargetData* resolved;
-  std::vector<OutputFile> target_ninja_outputs;
+  std::vector<OutputFile> outputs;
   std::vector<OutputFile>* ninja_outputs =
-      write_info->want_ninja_outputs ? &target_ninja_outputs : nullptr;
+      write_info->want_ninja_outputs || write_info->want_live_outputs
+          ? &outputs
+          : nullptr;
 
   {
     std::lock_guard<std::mutex> lock(write_info->lock);
     resolved = &((*write_info->resolved_map)[std::this_thread::get_id()]);
   }
-  std::string rule =
-      NinjaTargetWriter::RunAndWriteFile(target, resolved, ninja_outputs);
-
-  DCHECK(!rule.empty());
-
-  {
-    std::lock_guard<std::mutex> lock(write_info->lock);
-    write_info->rules[target->toolchain()].emplace_back(target,
-                                                        std::move(rule));
-
-    if (write_info->want_ninja_outputs) {
-      write_info->ninja_outputs_map.emplace(target,
-                                            std::move(target_ninja_outputs));
+  slot->rule = NinjaTargetWriter::RunAndWriteFile(
+      target, resolved, ninja_outputs, &write_info->sink,
+      write_info->want_live_outputs ? &slot->live_outputs : nullptr);
+
+  DCHECK(!slot->rule.empty());
+
+  // Only the rendered JSON entry is kept, rather than one OutputFile per
+  // output until all the targets have been written.
+  if (write_info->want_ninja_outputs)
+    slot->ninja_outputs = NinjaOutputsWriter::RenderEntry(target, outputs);
+
+  // Like Ninja, --clean-stale keeps the inputs and outputs of all the build
+  // statements, collected above. The files that GN itself writes for the
+  // target (e.g. generated_file outputs) must survive too.
+  if (write_info->want_live_outputs) {
+    std::vector<std::string>& live_outputs = slot->live_outputs;
+    for (const OutputFile& output : target->computed_outputs())
+      live_outputs.push_back(CanonicalizeNinjaPath(output.value()));
+    if (!target->write_runtime_deps_output().value().empty()) {
+      live_outputs.push_back(
+          CanonicalizeNinjaPath(target->write_runtime_deps_output().value()));
     }
   }
 }
@@ -129,8 +192,9 @@ void ItemResolvedAndGeneratedCallback(TargetWriteInfo* write_info,
   const Item* item = record->item();
   const Target* target = item->AsTarget();
   if (target) {
+    TargetWriteSlot* slot = &write_info->slots.emplace_back(target);
     g_scheduler->ScheduleWork(
-        [write_info, target]() { BackgroundDoWrite(write_info, target); });
+        [write_info, slot]() { BackgroundDoWrite(write_info, slot); });
   }
 }
 
@@ -404,13 +468,19 @@ bool RunCompileCommandsWriter(Setup& setup, Err* err) {
   bool quiet = command_line->HasSwitch(switches::kQuiet);
   base::ElapsedTimer timer;
 
-  // The compilation database file goes in the build directory.
+  // The compilation database file, or the directory of the shards, goes in
+  // the build directory, along with the cache of the entries of each target.
   SourceFile output_file =
       setup.build_settings().build_dir().ResolveRelativeFile(
           Value(nullptr, "compile_commands.json"), err);
   if (output_file.is_null())
     return false;
   base::FilePath output_path = setup.build_settings().GetFullPath(output_file);
+  base::FilePath cache_path =
+      output_path.DirName().AppendASCII("compile_commands.cache");
+  bool shard = command_line->HasSwitch(kSwitchShardCompileCommands);
+  if (shard)
+    output_path = output_path.DirName().AppendASCII("compile_commands");
 
   std::optional<std::string> legacy_target_filters;
   if (has_legacy_switch) {
@@ -420,7 +490,8 @@ bool RunCompileCommandsWriter(Setup& setup, Err* err) {
 
   bool ok = CompileCommandsWriter::RunAndWriteFiles(
       &setup.build_settings(), setup.builder().GetAllResolvedTargets(),
-      setup.export_compile_commands(), legacy_target_filters, output_path, err);
+      setup.export_compile_commands(), legacy_target_filters, output_path,
+      shard, cache_path, err);
   if (ok && !quiet) {
     OutputString("Generating compile_commands took " +
                  base::Int64ToString(timer.Elapsed().InMilliseconds()) +
@@ -429,10 +500,61 @@ bool RunCompileCommandsWriter(Setup& setup, Err* err) {
   return ok;
 }
 
+void LogNinjaToolFallback(const char* tool, const Err& reason) {
+  if (g_scheduler->verbose_logging()) {
+    g_scheduler->Log("Running ninja -t " + std::string(tool),
+                     reason.message() + " " + reason.help_text());
+  }
+}
+
+// Writes the snapshot of the resolved graph used by the query commands. It
+// depends on the same files as build.ninja, see NinjaBuildWriter.
+bool WriteGraphSnapshot(const BuildSettings* build_settings,
+                        const Builder& builder,
+                        Err* err) {
+  std::vector<base::FilePath> other_files = g_scheduler->GetGenDependencies();
+  const InputFileManager* input_file_manager =
+      g_scheduler->input_file_manager();
+
+  VectorSetSorter<base::FilePath> sorter(
+      input_file_manager->GetInputFileCount() + other_files.size());
+  input_file_manager->AddAllPhysicalInputFileNamesToVectorSetSorter(&sorter);
+  sorter.Add(other_files.begin(), other_files.end());
+
+  std::vector<base::FilePath> input_files;
+  sorter.IterateOver([&input_files](const base::FilePath& input_file) {
+    input_files.push_back(input_file);
+  });
+
+  GraphSnapshot snapshot;
+  GraphSnapshot::Create(build_settings, builder, input_files, &snapshot);
+  return snapshot.WriteToFile(GraphSnapshot::GetPath(build_settings), err);
+}
+
+// Adds the nodes of the build statements of build.ninja to |live_outputs|.
+bool AddBuildNinjaNodes(const BuildSettings* build_settings,
+                        NinjaOutputSet* live_outputs,
+                        Err* err) {
+  base::FilePath build_ninja = build_settings->GetFullPath(
+      SourceFile(build_settings->build_dir().value() + "build.ninja"));
+  std::string contents;
+  if (!base::ReadFileToString(build_ninja, &contents)) {
+    *err =
+        Err(Location(), "Could not read " + FilePathToUTF8(build_ninja) + ".");
+    return false;
+  }
+  std::vector<std::string> nodes;
+  AppendNinjaBuildNodes(contents, &nodes);
+  for (std::string& node : nodes)
+    live_outputs->insert(std::move(node));
+  return true;
+}
+
 bool RunNinjaPostProcessTools(const BuildSettings* build_settings,
                               base::FilePath ninja_executable,
                               bool is_regeneration,
                               bool clean_stale,
+                              const NinjaOutputSet& live_outputs,
                               Err* err) {
   // If the user did not specify an executable, skip running the post processing
   // tools. Since these tools can re-write ninja build log and dep logs, it is
@@ -460,12 +582,19 @@ bool RunNinjaPostProcessTools(const BuildSettings* build_settings,
       return false;
     }
 
-    if (!InvokeNinjaCleanDeadTool(ninja_executable, build_dir, err)) {
-      return false;
-    }
+    // Prefer handling the logs in-process, which avoids having Ninja load
+    // the whole build graph twice. Fall back to the Ninja tools if the logs
+    // use a format GN doesn't know about.
+    Err in_process_err;
+    if (!CleanDeadNinjaOutputs(build_dir, live_outputs, &in_process_err)) {
+      LogNinjaToolFallback("cleandead", in_process_err);
+      if (!InvokeNinjaCleanDeadTool(ninja_executable, build_dir, err)) {
+        return false;
+      }
 
-    if (!InvokeNinjaRecompactTool(ninja_executable, build_dir, err)) {
-      return false;
+      if (!InvokeNinjaRecompactTool(ninja_executable, build_dir, err)) {
+        return false;
+      }
     }
   }
 
@@ -476,13 +605,18 @@ bool RunNinjaPostProcessTools(const BuildSettings* build_settings,
   // ninja will restat the appropriate file anyways after it is complete.
   if (!is_regeneration &&
       build_settings->ninja_required_version() >= Version{1, 10, 0}) {
-    std::vector<base::FilePath> files_to_restat{
-        base::FilePath(FILE_PATH_LITERAL("build.ninja")),
-        base::FilePath(FILE_PATH_LITERAL("build.ninja.stamp")),
-    };
-    if (!InvokeNinjaRestatTool(ninja_executable, build_dir, files_to_restat,
-                               err)) {
-      return false;
+    Err in_process_err;
+    if (!RestatNinjaLog(build_dir, {"build.ninja", "build.ninja.stamp"},
+                        &in_process_err)) {
+      LogNinjaToolFallback("restat", in_process_err);
+      std::vector<base::FilePath> files_to_restat{
+          base::FilePath(FILE_PATH_LITERAL("build.ninja")),
+          base::FilePath(FILE_PATH_LITERAL("build.ninja.stamp")),
+      };
+      if (!InvokeNinjaRestatTool(ninja_executable, build_dir, files_to_restat,
+                                 err)) {
+        return false;
+      }
     }
   }
   return true;
@@ -517,6 +651,11 @@ General options
       executable will also be used as part of the gen process for triggering a
       restat on generated ninja files and for use with --clean-stale.
 
+      When the ninja build log and dependency database use a format GN knows
+      about, GN updates them itself instead of running the ninja tools, which
+      avoids having ninja load the whole build graph. The ninja tools are used
+      otherwise.
+
   --clean-stale
       This option will cause no longer needed output files to be removed from
       the build directory, and their records pruned from the ninja build log and
@@ -524,6 +663,14 @@ General options
       option requires a ninja executable of at least version 1.10.0. It can be
       provided by the --ninja-executable switch. Also see "gn help clean_stale".
 
+  --graph-snapshot
+      Also write a summary of the resolved build graph to the build directory.
+      "gn ls" then answers from it instead of executing all the build files
+      again, as long as it runs the same GN binary with the same root target,
+      root patterns, dotfile and script executable, and none of the files the
+      build graph depends on changed (the snapshot records their contents).
+      Only "gn ls" uses the snapshot: the other commands load the build.
+
 IDE options
 
   GN optionally generates files for IDE. Files won't be overwritten if their
@@ -724,6 +871,15 @@ Compilation Database
        - "//foo:foo"
       and not match:
        - "//foo:bar"
+
+  --shard-compile-commands
+      Instead of a single compile_commands.json file, writes a compilation
+      database for each top-level source directory, holding the targets
+      defined in that directory, as
+      compile_commands/<dir>/compile_commands.json in the build directory.
+      The targets defined in the root build file go to
+      compile_commands/compile_commands.json. This is meant for tools that
+      can merge several databases.
 )";
 
 int RunGen(const std::vector<std::string>& args) {
@@ -768,6 +924,7 @@ int RunGen(const std::vector<std::string>& args) {
   TargetWriteInfo write_info;
   write_info.want_ninja_outputs =
       command_line->HasSwitch(kSwitchNinjaOutputsFile);
+  write_info.want_live_outputs = command_line->HasSwitch(kSwitchCleanStale);
 
   setup->builder().set_resolved_and_generated_callback(
       [&write_info](const BuilderRecord* record) {
@@ -783,17 +940,25 @@ int RunGen(const std::vector<std::string>& args) {
                  base::Int64ToString(timer.Elapsed().InMilliseconds()) +
                  "ms\n");
 
-  // Sort the targets in each toolchain according to their label. This makes
-  // the ninja files have deterministic content.
-  for (auto& cur_toolchain : write_info.rules) {
-    std::sort(cur_toolchain.second.begin(), cur_toolchain.second.end(),
-              [](const NinjaWriter::TargetRulePair& a,
-                 const NinjaWriter::TargetRulePair& b) {
-                return a.first->label() < b.first->label();
-              });
-  }
+  write_info.CollectSlots();
 
   Err err;
+  // The per-target files must be complete before the root files that load
+  // them are written.
+  if (!write_info.sink.Flush(&err)) {
+    err.PrintToStdout();
+    return 1;
+  }
+
+  if (command_line->HasSwitch(switches::kVerbose)) {
+    OutputSink::Stats sink_stats = write_info.sink.GetStats();
+    OutputString(base::StringPrintf(
+        "Target files: %" PRIu64 " written (%" PRIu64 " bytes), %" PRIu64
+        " unchanged, %" PRIu64 " batches, ~%" PRIu64 " file system calls\n",
+        sink_stats.files_written, sink_stats.bytes_written,
+        sink_stats.files_unchanged, sink_stats.batches, sink_stats.syscalls));
+  }
+
   // Write the root ninja files.
   if (!NinjaWriter::RunAndWriteFiles(&setup->build_settings(), setup->builder(),
                                      write_info.rules, &err)) {
@@ -801,11 +966,28 @@ int RunGen(const std::vector<std::string>& args) {
     return 1;
   }
 
+  // build.ninja has its own build statements, for the "gn" rule and the
+  // phony aliases of the targets.
+  if (write_info.want_live_outputs &&
+      !AddBuildNinjaNodes(&setup->build_settings(), &write_info.live_outputs,
+                          &err)) {
+    err.PrintToStdout();
+    return 1;
+  }
+
+  if (command_line->HasSwitch(switches::kVerbose)) {
+    PathOutputCache::Stats path_stats = PathOutputCache::GetStats();
+    OutputString(base::StringPrintf(
+        "Path output cache: %" PRIu64 " hits, %" PRIu64 " misses\n",
+        path_stats.hits, path_stats.misses));
+  }
+
   if (!RunNinjaPostProcessTools(
           &setup->build_settings(),
           command_line->GetSwitchValuePath(switches::kNinjaExecutable),
           command_line->HasSwitch(switches::kRegeneration),
-          command_line->HasSwitch(kSwitchCleanStale), &err)) {
+          command_line->HasSwitch(kSwitchCleanStale), write_info.live_outputs,
+          &err)) {
     err.PrintToStdout();
     return 1;
   }
@@ -829,8 +1011,8 @@ int RunGen(const std::vector<std::string>& args) {
         command_line->GetSwitchValueString(kSwitchNinjaOutputsScriptArgs);
 
     bool res = NinjaOutputsWriter::RunAndWriteFiles(
-        write_info.ninja_outputs_map, &setup->build_settings(), file_name,
-        exec_script, exec_script_extra_args, quiet, &err);
+        std::move(write_info.ninja_outputs), &setup->build_settings(),
+        file_name, exec_script, exec_script_extra_args, quiet, &err);
     if (!res) {
       err.PrintToStdout();
       return 1;
@@ -851,6 +1033,12 @@ int RunGen(const std::vector<std::string>& args) {
   if (!CheckForInvalidGeneratedInputs(setup))
     return 1;
 
+  if (command_line->HasSwitch(kSwitchGraphSnapshot) &&
+      !WriteGraphSnapshot(&setup->build_settings(), setup->builder(), &err)) {
+    err.PrintToStdout();
+    return 1;
+  }
+
   for (auto&& ide : command_line->GetSwitchValueStrings(kSwitchIde)) {
     if (!RunIdeWriter(ide, &setup->build_settings(), setup->builder(), &err)) {
       err.PrintToStdout();
@@ -4,17 +4,171 @@
 
 #include <algorithm>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "base/command_line.h"
 #include "gn/commands.h"
+#include "gn/filesystem_utils.h"
+#include "gn/graph_snapshot.h"
 #include "gn/label_pattern.h"
 #include "gn/setup.h"
 #include "gn/standard_out.h"
 #include "gn/switches.h"
 #include "gn/target.h"
+#include "gn/value.h"
 
 namespace commands {
 
+namespace {
+
+using TargetRecord = GraphSnapshot::TargetRecord;
+
+// Equivalent of FilterAndPrintTargets() for snapshot records.
+void FilterAndPrintTargetRecords(
+    const GraphSnapshot& snapshot,
+    const std::vector<const TargetRecord*>& records) {
+  const CommandSwitches& switches = CommandSwitches::Get();
+  CommandSwitches::TestonlyMode testonly_mode = switches.testonly_mode();
+  Target::OutputType type = switches.target_type();
+
+  std::vector<const TargetRecord*> filtered;
+  for (const TargetRecord* record : records) {
+    if (testonly_mode != CommandSwitches::TESTONLY_NONE &&
+        record->testonly != (testonly_mode == CommandSwitches::TESTONLY_TRUE))
+      continue;
+    // Make "action" also apply to ACTION_FOREACH.
+    if (type != Target::UNKNOWN && record->output_type != type &&
+        !(type == Target::ACTION &&
+          record->output_type == Target::ACTION_FOREACH))
+      continue;
+    filtered.push_back(record);
+  }
+
+  std::vector<std::string> lines;
+  switch (switches.target_print_mode()) {
+    case CommandSwitches::TARGET_PRINT_BUILDFILE: {
+      std::set<std::string> unique_files;
+      for (const TargetRecord* record : filtered)
+        unique_files.insert(record->build_file);
+      lines.assign(unique_files.begin(), unique_files.end());
+      break;
+    }
+    case CommandSwitches::TARGET_PRINT_LABEL: {
+      std::set<Label> unique_labels;
+      for (const TargetRecord* record : filtered)
+        unique_labels.insert(record->label);
+      for (const Label& label : unique_labels) {
+        // Print toolchain only for ones not in the default toolchain.
+        lines.push_back(label.GetUserVisibleName(
+            label.GetToolchainLabel() != snapshot.default_toolchain()));
+      }
+      break;
+    }
+    case CommandSwitches::TARGET_PRINT_OUTPUT:
+      for (const TargetRecord* record : filtered) {
+        if (!record->output.empty())
+          lines.push_back(record->output);
+      }
+      break;
+  }
+
+  for (const std::string& line : lines)
+    OutputString(line + "\n");
+}
+
+// Answers the query from the snapshot written by "gn gen --graph-snapshot"
+// instead of loading the build. Returns false without printing anything if
+// the snapshot is missing or stale, or if an input may not refer to a target
+// (that requires resolving it against the full build graph).
+bool RunLsFromSnapshot(Setup* setup,
+                       const std::vector<std::string>& inputs,
+                       bool default_toolchain_only) {
+  // Arguments passed on the command line override the ones of the build.
+  if (base::CommandLine::ForCurrentProcess()->HasSwitch(switches::kArgs))
+    return false;
+
+  const BuildSettings& build_settings = setup->build_settings();
+  GraphSnapshot snapshot;
+  if (!GraphSnapshot::LoadIfFresh(&build_settings, &snapshot))
+    return false;
+
+  const std::vector<TargetRecord>& targets = snapshot.targets();
+  const Label& default_toolchain = snapshot.default_toolchain();
+  SourceDir current_dir =
+      SourceDirForCurrentDirectory(build_settings.root_path());
+
+  std::vector<const TargetRecord*> matches;
+  std::set<const TargetRecord*> seen;
+  auto add_match = [&matches, &seen](const TargetRecord* record) {
+    if (seen.insert(record).second)
+      matches.push_back(record);
+  };
+
+  if (inputs.empty()) {
+    for (const TargetRecord& record : targets) {
+      if (!default_toolchain_only ||
+          record.label.GetToolchainLabel() == default_toolchain)
+        matches.push_back(&record);
+    }
+  }
+  // The patterns are matched against the records in a single pass, and the
+  // records of each input are then added in the order of the inputs.
+  std::vector<LabelPattern> patterns;
+  std::vector<size_t> pattern_inputs;
+  std::vector<std::vector<const TargetRecord*>> input_records(inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++) {
+    Err err;
+    if (LabelPattern::HasWildcard(inputs[i])) {
+      LabelPattern pattern = LabelPattern::GetPattern(
+          current_dir, build_settings.root_path_utf8(),
+          Value(nullptr, inputs[i]), &err);
+      if (err.has_error())
+        return false;
+      if (default_toolchain_only && pattern.toolchain().is_null())
+        pattern.set_toolchain(default_toolchain);
+      patterns.push_back(std::move(pattern));
+      pattern_inputs.push_back(i);
+      continue;
+    }
+
+    Label label =
+        Label::Resolve(current_dir, build_settings.root_path_utf8(),
+                       default_toolchain, Value(nullptr, inputs[i]), &err);
+    if (err.has_error())
+      return false;
+    auto found = std::lower_bound(
+        targets.begin(), targets.end(), label,
+        [](const TargetRecord& record, const Label& label) {
+          return record.label < label;
+        });
+    if (found == targets.end() || found->label != label)
+      return false;
+    input_records[i].push_back(&*found);
+  }
+
+  if (!patterns.empty()) {
+    LabelPatternMatcher matcher(std::move(patterns));
+    std::vector<size_t> pattern_matches;
+    for (const TargetRecord& record : targets) {
+      pattern_matches.clear();
+      matcher.GetMatches(record.label, &pattern_matches);
+      for (size_t pattern : pattern_matches)
+        input_records[pattern_inputs[pattern]].push_back(&record);
+    }
+  }
+
+  for (const std::vector<const TargetRecord*>& records : input_records) {
+    for (const TargetRecord* record : records)
+      add_match(record);
+  }
+
+  FilterAndPrintTargetRecords(snapshot, matches);
+  return true;
+}
+
+}  // namespace
+
 const char kLs[] = "ls";
 const char kLs_HelpShort[] = "ls: List matching targets.";
 const char kLs_Help[] =
@@ -29,6 +183,10 @@ const char kLs_Help[] =
   not a general regular expression (see "gn help label_pattern"). If you need
   more complex expressions, pipe the result through grep.
 
+  When the build directory has an up-to-date graph snapshot (see
+  "--graph-snapshot" in "gn help gen"), targets are listed from it without
+  loading the build files. "gn ls" is the only command using the snapshot.
+
 Options
 
 )" TARGET_PRINTING_MODE_COMMAND_LINE_HELP "\n" DEFAULT_TOOLCHAIN_SWITCH_HELP
@@ -66,12 +224,20 @@ int RunLs(const std::vector<std::string>& args) {
 
   // Deliberately leaked to avoid expensive process teardown.
   Setup* setup = new Setup;
-  if (!setup->DoSetup(args[0], false) || !setup->Run())
+  if (!setup->DoSetup(args[0], false))
     return 1;
 
   const base::CommandLine* cmdline = base::CommandLine::ForCurrentProcess();
   bool default_toolchain_only = cmdline->HasSwitch(switches::kDefaultToolchain);
 
+  if (RunLsFromSnapshot(
+          setup, std::vector<std::string>(args.begin() + 1, args.end()),
+          default_toolchain_only))
+    return 0;
+
+  if (!setup->Run())
+    return 1;
+
   std::vector<const Target*> matches;
   if (args.size() > 1) {
     // Some patterns or explicit labels were specified.
@@ -5,12 +5,15 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <vector>
 
 #include "base/command_line.h"
 #include "base/strings/stringprintf.h"
 #include "gn/commands.h"
 #include "gn/setup.h"
 #include "gn/standard_out.h"
+#include "gn/target_graph_index.h"
+#include "util/worker_pool.h"
 
 namespace commands {
 
@@ -102,11 +105,10 @@ int RunOutputs(const std::vector<std::string>& args) {
   std::vector<OutputFile> outputs;
 
   // Files. This must go first because it may add to the "targets" list.
-  std::vector<const Target*> all_targets =
-      setup->builder().GetAllResolvedTargets();
+  TargetGraphIndex index(setup->builder().GetAllResolvedTargets());
   for (const SourceFile& file : file_matches) {
     std::vector<TargetContainingFile> targets;
-    GetTargetsContainingFile(setup, all_targets, file, false, &targets);
+    GetTargetsContainingFile(setup, index, file, false, &targets);
     if (targets.empty()) {
       Err(Location(), base::StringPrintf("No targets reference the file '%s'.",
                                          file.value().c_str()))
@@ -131,19 +133,31 @@ int RunOutputs(const std::vector<std::string>& args) {
     }
   }
 
-  // Targets.
-  for (const Target* target : target_matches) {
+  // Targets. Their outputs are computed in parallel and added in order.
+  std::vector<std::vector<OutputFile>> target_outputs(target_matches.size());
+  std::vector<Err> errors(target_matches.size());
+  ParallelFor(target_matches.size(), [&target_matches, &target_outputs,
+                                      &errors, setup](size_t, size_t begin,
+                                                      size_t end) {
     std::vector<SourceFile> output_files;
-    Err err;
-    if (!target->GetOutputsAsSourceFiles(LocationRange(), true, &output_files,
-                                         &err)) {
-      err.PrintToStdout();
+    for (size_t i = begin; i < end; i++) {
+      output_files.clear();
+      if (!target_matches[i]->GetOutputsAsSourceFiles(
+              LocationRange(), true, &output_files, &errors[i]))
+        continue;
+
+      // Convert to OutputFiles.
+      for (const SourceFile& file : output_files)
+        target_outputs[i].emplace_back(&setup->build_settings(), file);
+    }
+  });
+  for (size_t i = 0; i < target_matches.size(); i++) {
+    if (errors[i].has_error()) {
+      errors[i].PrintToStdout();
       return 1;
     }
-
-    // Convert to OutputFiles.
-    for (const SourceFile& file : output_files)
-      outputs.emplace_back(&setup->build_settings(), file);
+    outputs.insert(outputs.end(), target_outputs[i].begin(),
+                   target_outputs[i].end());
   }
 
   // Print.
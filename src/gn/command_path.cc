@@ -2,11 +2,18 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "gn/command_path.h"
+
 #include <stddef.h>
+#include <stdint.h>
 
 #include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "base/command_line.h"
+#include "base/containers/span.h"
 #include "base/strings/stringprintf.h"
 #include "gn/commands.h"
 #include "gn/setup.h"
@@ -16,32 +23,16 @@ namespace commands {
 
 namespace {
 
-enum class DepType { NONE, PUBLIC, PRIVATE, DATA };
+using DepType = PathDepType;
 
-// The dependency paths are stored in a vector. Assuming the chain:
-//    A --[public]--> B --[private]--> C
-// The stack will look like:
-//    [0] = A, NONE (this has no dep type since nobody depends on it)
-//    [1] = B, PUBLIC
-//    [2] = C, PRIVATE
-using TargetDep = std::pair<const Target*, DepType>;
+// The dependency paths are stored like DependencyPath::targets, with DepGraph
+// target indices instead of targets.
+using TargetDep = std::pair<uint32_t, DepType>;
 using PathVector = std::vector<TargetDep>;
 
 // How to search.
 enum class PrivateDeps { INCLUDE, EXCLUDE };
 enum class DataDeps { INCLUDE, EXCLUDE };
-enum class PrintWhat { ONE, ALL };
-
-struct Options {
-  Options()
-      : print_what(PrintWhat::ONE), public_only(false), with_data(false) {}
-
-  PrintWhat print_what;
-  bool public_only;
-  bool with_data;
-};
-
-using WorkQueue = std::list<PathVector>;
 
 struct Stats {
   Stats() : public_paths(0), other_paths(0) {}
@@ -51,11 +42,149 @@ struct Stats {
   int public_paths;
   int other_paths;
 
-  // Stores targets that have a path to the destination, and whether that
-  // path is public, private, or data.
-  std::map<const Target*, DepType> found_paths;
+  // Stores, for each target index of the DepGraph, whether the target has a
+  // path to the destination and whether that path is public, private, or
+  // data. NONE means no path was found yet.
+  std::vector<DepType> found_paths;
+
+  // The paths to print, in the order they were found.
+  std::vector<DependencyPath> printed_paths;
+};
+
+// The dependency edges of all the resolved targets, indexed by dense target
+// indices so that searches can use flat vectors instead of maps for their
+// state. Built once per "gn path" run, after the graph is resolved, and
+// shared by all the searches of that run.
+class DepGraph {
+ public:
+  struct Edge {
+    uint32_t target;
+    DepType type;
+  };
+
+  explicit DepGraph(std::vector<const Target*> targets)
+      : targets_(std::move(targets)) {
+    indices_.reserve(targets_.size());
+    for (size_t i = 0; i < targets_.size(); i++)
+      indices_.emplace(targets_[i], static_cast<uint32_t>(i));
+
+    // Edges are stored in the order in which the search follows them: public
+    // deps, then private deps, then data deps.
+    std::vector<std::pair<uint32_t, Edge>> reverse_edges;
+    deps_offsets_.reserve(targets_.size() + 1);
+    deps_offsets_.push_back(0);
+    for (size_t i = 0; i < targets_.size(); i++) {
+      AddEdges(i, targets_[i]->public_deps(), DepType::PUBLIC, &reverse_edges);
+      AddEdges(i, targets_[i]->private_deps(), DepType::PRIVATE,
+               &reverse_edges);
+      AddEdges(i, targets_[i]->data_deps(), DepType::DATA, &reverse_edges);
+      deps_offsets_.push_back(deps_.size());
+    }
+
+    dependents_offsets_.assign(targets_.size() + 1, 0);
+    for (const auto& edge : reverse_edges)
+      dependents_offsets_[edge.first + 1]++;
+    for (size_t i = 0; i < targets_.size(); i++)
+      dependents_offsets_[i + 1] += dependents_offsets_[i];
+    dependents_.resize(reverse_edges.size());
+    std::vector<size_t> next(dependents_offsets_.begin(),
+                             dependents_offsets_.end() - 1);
+    for (const auto& edge : reverse_edges)
+      dependents_[next[edge.first]++] = edge.second;
+  }
+
+  size_t size() const { return targets_.size(); }
+  const Target* target(uint32_t index) const { return targets_[index]; }
+  uint32_t IndexOf(const Target* target) const {
+    return indices_.find(target)->second;
+  }
+
+  base::span<const Edge> deps(uint32_t index) const {
+    return base::span<const Edge>(deps_.data() + deps_offsets_[index],
+                                  deps_offsets_[index + 1] -
+                                      deps_offsets_[index]);
+  }
+  base::span<const Edge> dependents(uint32_t index) const {
+    return base::span<const Edge>(
+        dependents_.data() + dependents_offsets_[index],
+        dependents_offsets_[index + 1] - dependents_offsets_[index]);
+  }
+
+ private:
+  void AddEdges(size_t from,
+                const LabelTargetVector& deps,
+                DepType type,
+                std::vector<std::pair<uint32_t, Edge>>* reverse_edges) {
+    for (const auto& pair : deps) {
+      uint32_t to = indices_.find(pair.ptr)->second;
+      deps_.push_back(Edge{to, type});
+      reverse_edges->emplace_back(to,
+                                  Edge{static_cast<uint32_t>(from), type});
+    }
+  }
+
+  std::vector<const Target*> targets_;
+  std::unordered_map<const Target*, uint32_t> indices_;
+
+  std::vector<size_t> deps_offsets_;
+  std::vector<Edge> deps_;
+  std::vector<size_t> dependents_offsets_;
+  std::vector<Edge> dependents_;
 };
 
+bool ShouldFollow(DepType type, PrivateDeps private_deps, DataDeps data_deps) {
+  switch (type) {
+    case DepType::PUBLIC:
+      return true;
+    case DepType::PRIVATE:
+      return private_deps == PrivateDeps::INCLUDE;
+    case DepType::DATA:
+      return data_deps == DataDeps::INCLUDE;
+    case DepType::NONE:
+    default:
+      return false;
+  }
+}
+
+// Returns, for each target, the kind of deps needed to reach |to| from it,
+// found by searching backwards from |to|: PUBLIC if public deps are enough,
+// PRIVATE if private deps are needed too, DATA if data deps are needed too,
+// and NONE if |to| can't be reached. So a search following some kinds of deps
+// can only reach |to| through the targets for which ShouldFollow() returns
+// true, since the searches following data deps also follow private deps.
+//
+// This serves all the searches towards |to|, whatever deps they follow.
+std::vector<DepType> GetTargetsReaching(const DepGraph& graph, uint32_t to) {
+  std::vector<DepType> reaching(graph.size(), DepType::NONE);
+
+  // One work list per kind of deps, indexed by DepType. All the targets
+  // reached through public deps are found before following any private dep,
+  // and so on, so that each target is expanded once, with the first kind that
+  // reaches it.
+  std::vector<uint32_t> work_lists[4];
+  reaching[to] = DepType::PUBLIC;
+  work_lists[static_cast<size_t>(DepType::PUBLIC)].push_back(to);
+  for (DepType type : {DepType::PUBLIC, DepType::PRIVATE, DepType::DATA}) {
+    std::vector<uint32_t>& work_list = work_lists[static_cast<size_t>(type)];
+    while (!work_list.empty()) {
+      uint32_t current = work_list.back();
+      work_list.pop_back();
+      // Already expanded with a more restrictive kind.
+      if (reaching[current] != type)
+        continue;
+      for (const DepGraph::Edge& edge : graph.dependents(current)) {
+        DepType needed = std::max(type, edge.type);
+        DepType& dependent = reaching[edge.target];
+        if (dependent == DepType::NONE || needed < dependent) {
+          dependent = needed;
+          work_lists[static_cast<size_t>(needed)].push_back(edge.target);
+        }
+      }
+    }
+  }
+  return reaching;
+}
+
 // If the implicit_last_dep is not "none", this type indicates the
 // classification of the elided last part of path.
 DepType ClassifyPath(const PathVector& path, DepType implicit_last_dep) {
@@ -96,30 +225,33 @@ const char* StringForDepType(DepType type) {
 
 // Prints the given path. If the implicit_last_dep is not "none", the last
 // dependency will show an elided dependency with the given annotation.
-void PrintPath(const PathVector& path, DepType implicit_last_dep) {
-  if (path.empty())
+void PrintPath(const DependencyPath& path) {
+  const auto& targets = path.targets;
+  if (targets.empty())
     return;
 
   // Don't print toolchains unless they differ from the first target.
-  const Label& default_toolchain = path[0].first->label().GetToolchainLabel();
+  const Label& default_toolchain =
+      targets[0].first->label().GetToolchainLabel();
 
-  for (size_t i = 0; i < path.size(); i++) {
-    OutputString(path[i].first->label().GetUserVisibleName(default_toolchain));
+  for (size_t i = 0; i < targets.size(); i++) {
+    OutputString(targets[i].first->label().GetUserVisibleName(
+        default_toolchain));
 
     // Output dependency type.
-    if (i == path.size() - 1) {
+    if (i == targets.size() - 1) {
       // Last one either gets the implicit last dep type or nothing.
-      if (implicit_last_dep != DepType::NONE) {
+      if (path.implicit_last_dep != DepType::NONE) {
         OutputString(std::string(" --> see ") +
-                         StringForDepType(implicit_last_dep) +
+                         StringForDepType(path.implicit_last_dep) +
                          " chain printed above...",
                      DECORATION_DIM);
       }
     } else {
       // Take type from the next entry.
-      OutputString(
-          std::string(" --[") + StringForDepType(path[i + 1].second) + "]-->",
-          DECORATION_DIM);
+      OutputString(std::string(" --[") +
+                       StringForDepType(targets[i + 1].second) + "]-->",
+                   DECORATION_DIM);
     }
     OutputString("\n");
   }
@@ -127,6 +259,18 @@ void PrintPath(const PathVector& path, DepType implicit_last_dep) {
   OutputString("\n");
 }
 
+// Adds the given path to the paths to print.
+void AddPrintedPath(const DepGraph& graph,
+                    const PathVector& path,
+                    DepType implicit_last_dep,
+                    Stats* stats) {
+  DependencyPath& printed = stats->printed_paths.emplace_back();
+  printed.targets.reserve(path.size());
+  for (const TargetDep& dep : path)
+    printed.targets.emplace_back(graph.target(dep.first), dep.second);
+  printed.implicit_last_dep = implicit_last_dep;
+}
+
 void InsertTargetsIntoFoundPaths(const PathVector& path,
                                  DepType implicit_last_dep,
                                  Stats* stats) {
@@ -151,8 +295,8 @@ void InsertTargetsIntoFoundPaths(const PathVector& path,
     // Don't overwrite an existing one. The algorithm works by first doing
     // public, then private, then data, so anything already there is guaranteed
     // at least as good as our addition.
-    if (stats->found_paths.find(pair.first) == stats->found_paths.end()) {
-      stats->found_paths.insert(std::make_pair(pair.first, type));
+    if (stats->found_paths[pair.first] == DepType::NONE) {
+      stats->found_paths[pair.first] = type;
       inserted = true;
     }
   }
@@ -166,31 +310,58 @@ void InsertTargetsIntoFoundPaths(const PathVector& path,
   }
 }
 
-void BreadthFirstSearch(const Target* from,
-                        const Target* to,
+// A path being explored by BreadthFirstSearch(). Paths are stored as a tree:
+// each one extends the path of its |parent| with one dependency.
+struct PathNode {
+  uint32_t target;
+  DepType type;
+  size_t parent;
+};
+
+PathVector GetPath(const std::vector<PathNode>& nodes, size_t index) {
+  PathVector path;
+  for (;;) {
+    path.emplace_back(nodes[index].target, nodes[index].type);
+    if (nodes[index].type == DepType::NONE)
+      break;
+    index = nodes[index].parent;
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+// Only the targets from which |to| can be reached can be part of a path, so
+// the search never queues the others, using |reaching| as returned by
+// GetTargetsReaching() for |to|. This is a reachability prune rather than half
+// of a bidirectional search: the search still runs forward from |from|, and
+// visits the same paths in the same order as an unpruned search.
+void BreadthFirstSearch(const DepGraph& graph,
+                        uint32_t from,
+                        uint32_t to,
+                        const std::vector<DepType>& reaching,
                         PrivateDeps private_deps,
                         DataDeps data_deps,
-                        PrintWhat print_what,
+                        bool print_all,
                         Stats* stats) {
-  // Seed the initial stack with just the "from" target.
-  PathVector initial_stack;
-  initial_stack.emplace_back(from, DepType::NONE);
-  WorkQueue work_queue;
-  work_queue.push_back(initial_stack);
+  if (!ShouldFollow(reaching[from], private_deps, data_deps))
+    return;
 
-  // Track checked targets to avoid checking the same once more than once.
-  TargetSet visited;
+  // The nodes are appended in the order in which they are queued, so the
+  // vector is also the work queue. Seed it with just the "from" target.
+  std::vector<PathNode> nodes;
+  nodes.push_back(PathNode{from, DepType::NONE, 0});
 
-  while (!work_queue.empty()) {
-    PathVector current_path = work_queue.front();
-    work_queue.pop_front();
+  // Track checked targets to avoid checking the same once more than once.
+  std::vector<bool> visited(graph.size());
 
-    const Target* current_target = current_path.back().first;
+  for (size_t current = 0; current < nodes.size(); current++) {
+    uint32_t current_target = nodes[current].target;
 
     if (current_target == to) {
       // Found a new path.
-      if (stats->total_paths() == 0 || print_what == PrintWhat::ALL)
-        PrintPath(current_path, DepType::NONE);
+      PathVector current_path = GetPath(nodes, current);
+      if (stats->total_paths() == 0 || print_all)
+        AddPrintedPath(graph, current_path, DepType::NONE, stats);
 
       // Insert all nodes on the path into the found paths list. Since we're
       // doing search breadth first, we know that the current path is the best
@@ -203,16 +374,15 @@ void BreadthFirstSearch(const Target* from,
       // Doing this here will mean that the output is sorted by length of items
       // printed (with the redundant parts of the path omitted) rather than
       // complete path length.
-      const auto& found_current_target =
-          stats->found_paths.find(current_target);
-      if (found_current_target != stats->found_paths.end()) {
-        if (stats->total_paths() == 0 || print_what == PrintWhat::ALL)
-          PrintPath(current_path, found_current_target->second);
+      DepType found_type = stats->found_paths[current_target];
+      if (found_type != DepType::NONE) {
+        PathVector current_path = GetPath(nodes, current);
+        if (stats->total_paths() == 0 || print_all)
+          AddPrintedPath(graph, current_path, found_type, stats);
 
         // Insert all nodes on the path into the found paths list since we know
         // everything along this path also leads to the destination.
-        InsertTargetsIntoFoundPaths(current_path, found_current_target->second,
-                                    stats);
+        InsertTargetsIntoFoundPaths(current_path, found_type, stats);
         continue;
       }
     }
@@ -220,53 +390,68 @@ void BreadthFirstSearch(const Target* from,
     // If we've already checked this one, stop. This should be after the above
     // check for a known-good check, because known-good ones will always have
     // been previously visited.
-    if (!visited.add(current_target))
+    if (visited[current_target])
       continue;
+    visited[current_target] = true;
 
-    // Add public deps for this target to the queue.
-    for (const auto& pair : current_target->public_deps()) {
-      work_queue.push_back(current_path);
-      work_queue.back().push_back(TargetDep(pair.ptr, DepType::PUBLIC));
-    }
-
-    if (private_deps == PrivateDeps::INCLUDE) {
-      // Add private deps.
-      for (const auto& pair : current_target->private_deps()) {
-        work_queue.push_back(current_path);
-        work_queue.back().push_back(TargetDep(pair.ptr, DepType::PRIVATE));
-      }
-    }
-
-    if (data_deps == DataDeps::INCLUDE) {
-      // Add data deps.
-      for (const auto& pair : current_target->data_deps()) {
-        work_queue.push_back(current_path);
-        work_queue.back().push_back(TargetDep(pair.ptr, DepType::DATA));
-      }
+    // Add the deps for this target to the queue, public deps first.
+    for (const DepGraph::Edge& edge : graph.deps(current_target)) {
+      if (ShouldFollow(reaching[edge.target], private_deps, data_deps) &&
+          ShouldFollow(edge.type, private_deps, data_deps))
+        nodes.push_back(PathNode{edge.target, edge.type, current});
     }
   }
 }
 
-void DoSearch(const Target* from,
+void DoSearch(const DepGraph& graph,
+              const Target* from,
               const Target* to,
-              const Options& options,
+              const PathSearchOptions& options,
               Stats* stats) {
-  BreadthFirstSearch(from, to, PrivateDeps::EXCLUDE, DataDeps::EXCLUDE,
-                     options.print_what, stats);
+  uint32_t from_index = graph.IndexOf(from);
+  uint32_t to_index = graph.IndexOf(to);
+  std::vector<DepType> reaching = GetTargetsReaching(graph, to_index);
+  BreadthFirstSearch(graph, from_index, to_index, reaching,
+                     PrivateDeps::EXCLUDE, DataDeps::EXCLUDE, options.all,
+                     stats);
   if (!options.public_only) {
     // Check private deps.
-    BreadthFirstSearch(from, to, PrivateDeps::INCLUDE, DataDeps::EXCLUDE,
-                       options.print_what, stats);
+    BreadthFirstSearch(graph, from_index, to_index, reaching,
+                       PrivateDeps::INCLUDE, DataDeps::EXCLUDE, options.all,
+                       stats);
     if (options.with_data) {
       // Check data deps.
-      BreadthFirstSearch(from, to, PrivateDeps::INCLUDE, DataDeps::INCLUDE,
-                         options.print_what, stats);
+      BreadthFirstSearch(graph, from_index, to_index, reaching,
+                         PrivateDeps::INCLUDE, DataDeps::INCLUDE, options.all,
+                         stats);
     }
   }
 }
 
 }  // namespace
 
+PathSearchResult FindDependencyPaths(std::vector<const Target*> targets,
+                                     const Target* target1,
+                                     const Target* target2,
+                                     const PathSearchOptions& options) {
+  DepGraph graph(std::move(targets));
+  Stats stats;
+  stats.found_paths.resize(graph.size(), DepType::NONE);
+  DoSearch(graph, target1, target2, options, &stats);
+  if (stats.total_paths() == 0) {
+    // If we don't find a path going "forwards", try the reverse direction.
+    // Deps can only go in one direction without having a cycle, which will
+    // have caused a run failure above.
+    DoSearch(graph, target2, target1, options, &stats);
+  }
+
+  PathSearchResult result;
+  result.paths = std::move(stats.printed_paths);
+  result.public_paths = stats.public_paths;
+  result.other_paths = stats.other_paths;
+  return result;
+}
+
 const char kPath[] = "path";
 const char kPath_HelpShort[] = "path: Find paths between two targets.";
 const char kPath_Help[] =
@@ -331,10 +516,8 @@ int RunPath(const std::vector<std::string>& args) {
   if (!target2)
     return 1;
 
-  Options options;
-  options.print_what = base::CommandLine::ForCurrentProcess()->HasSwitch("all")
-                           ? PrintWhat::ALL
-                           : PrintWhat::ONE;
+  PathSearchOptions options;
+  options.all = base::CommandLine::ForCurrentProcess()->HasSwitch("all");
   options.public_only =
       base::CommandLine::ForCurrentProcess()->HasSwitch("public");
   options.with_data =
@@ -347,14 +530,10 @@ int RunPath(const std::vector<std::string>& args) {
     return 1;
   }
 
-  Stats stats;
-  DoSearch(target1, target2, options, &stats);
-  if (stats.total_paths() == 0) {
-    // If we don't find a path going "forwards", try the reverse direction.
-    // Deps can only go in one direction without having a cycle, which will
-    // have caused a run failure above.
-    DoSearch(target2, target1, options, &stats);
-  }
+  PathSearchResult result = FindDependencyPaths(
+      setup->builder().GetAllResolvedTargets(), target1, target2, options);
+  for (const DependencyPath& path : result.paths)
+    PrintPath(path);
 
   // This string is inserted in the results to annotate whether the result
   // is only public or includes data deps or not.
@@ -364,43 +543,43 @@ int RunPath(const std::vector<std::string>& args) {
   else if (!options.with_data)
     path_annotation = "non-data ";
 
-  if (stats.total_paths() == 0) {
+  if (result.total_paths() == 0) {
     // No results.
     OutputString(
         base::StringPrintf("No %spaths found between these two targets.\n",
                            path_annotation),
         DECORATION_YELLOW);
-  } else if (stats.total_paths() == 1) {
+  } else if (result.total_paths() == 1) {
     // Exactly one result.
     OutputString(base::StringPrintf("1 %spath found.", path_annotation),
                  DECORATION_YELLOW);
     if (!options.public_only) {
-      if (stats.public_paths)
+      if (result.public_paths)
         OutputString(" It is public.");
       else
         OutputString(" It is not public.");
     }
     OutputString("\n");
   } else {
-    if (options.print_what == PrintWhat::ALL) {
+    if (options.all) {
       // Showing all paths when there are many.
       OutputString(base::StringPrintf("%d \"interesting\" %spaths found.",
-                                      stats.total_paths(), path_annotation),
+                                      result.total_paths(), path_annotation),
                    DECORATION_YELLOW);
       if (!options.public_only) {
         OutputString(
-            base::StringPrintf(" %d of them are public.", stats.public_paths));
+            base::StringPrintf(" %d of them are public.", result.public_paths));
       }
       OutputString("\n");
     } else {
       // Showing one path when there are many.
       OutputString(
           base::StringPrintf("Showing one of %d \"interesting\" %spaths.",
-                             stats.total_paths(), path_annotation),
+                             result.total_paths(), path_annotation),
           DECORATION_YELLOW);
       if (!options.public_only) {
         OutputString(
-            base::StringPrintf(" %d of them are public.", stats.public_paths));
+            base::StringPrintf(" %d of them are public.", result.public_paths));
       }
       OutputString("\nUse --all to print all paths.\n");
     }
@@ -0,0 +1,59 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_COMMAND_PATH_H_
+#define TOOLS_GN_COMMAND_PATH_H_
+
+#include <utility>
+#include <vector>
+
+class Target;
+
+namespace commands {
+
+enum class PathDepType { NONE, PUBLIC, PRIVATE, DATA };
+
+// A dependency path printed by "gn path". Assuming the chain:
+//    A --[public]--> B --[private]--> C
+// |targets| will be:
+//    [0] = A, NONE (this has no dep type since nobody depends on it)
+//    [1] = B, PUBLIC
+//    [2] = C, PRIVATE
+// If |implicit_last_dep| is not NONE, the path continues with a chain of that
+// type printed before, which is elided.
+struct DependencyPath {
+  std::vector<std::pair<const Target*, PathDepType>> targets;
+  PathDepType implicit_last_dep = PathDepType::NONE;
+};
+
+struct PathSearchOptions {
+  // Finds all the "interesting" paths rather than just the first one.
+  bool all = false;
+
+  bool public_only = false;
+  bool with_data = false;
+};
+
+struct PathSearchResult {
+  int total_paths() const { return public_paths + other_paths; }
+
+  // The paths to print, in order.
+  std::vector<DependencyPath> paths;
+
+  // The number of "interesting" paths found, even if not printed.
+  int public_paths = 0;
+  int other_paths = 0;
+};
+
+// Finds the dependency paths from |target1| to |target2| the way "gn path"
+// does, or from |target2| to |target1| if there are none. |targets| are all
+// the resolved targets of the build.
+PathSearchResult FindDependencyPaths(std::vector<const Target*> targets,
+                                     const Target* target1,
+                                     const Target* target2,
+                                     const PathSearchOptions& options);
+
+}  // namespace commands
+
+#endif  // TOOLS_GN_COMMAND_PATH_H_
@@ -0,0 +1,195 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/command_path.h"
+
+#include <stdint.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gn/test_with_scope.h"
+#include "util/test/test.h"
+
+namespace commands {
+
+namespace {
+
+using Path = std::vector<std::pair<const Target*, PathDepType>>;
+
+// The search of "gn path" as it was before it was restricted to the targets
+// reaching the destination, to check that the results didn't change.
+class ReferenceSearch {
+ public:
+  explicit ReferenceSearch(const PathSearchOptions& options)
+      : options_(options) {}
+
+  PathSearchResult Run(const Target* target1, const Target* target2) {
+    DoSearch(target1, target2);
+    if (result_.total_paths() == 0)
+      DoSearch(target2, target1);
+    return std::move(result_);
+  }
+
+ private:
+  void DoSearch(const Target* from, const Target* to) {
+    BreadthFirstSearch(from, to, false, false);
+    if (!options_.public_only) {
+      BreadthFirstSearch(from, to, true, false);
+      if (options_.with_data)
+        BreadthFirstSearch(from, to, true, true);
+    }
+  }
+
+  void BreadthFirstSearch(const Target* from,
+                          const Target* to,
+                          bool private_deps,
+                          bool data_deps) {
+    std::list<Path> work_queue;
+    work_queue.push_back(Path{{from, PathDepType::NONE}});
+    std::set<const Target*> visited;
+    while (!work_queue.empty()) {
+      Path current_path = work_queue.front();
+      work_queue.pop_front();
+      const Target* current_target = current_path.back().first;
+
+      if (current_target == to) {
+        AddPath(current_path, PathDepType::NONE);
+      } else {
+        auto found = found_paths_.find(current_target);
+        if (found != found_paths_.end()) {
+          AddPath(current_path, found->second);
+          continue;
+        }
+      }
+
+      if (!visited.insert(current_target).second)
+        continue;
+      auto add_deps = [&work_queue, &current_path](
+                          const LabelTargetVector& deps, PathDepType type) {
+        for (const auto& pair : deps) {
+          work_queue.push_back(current_path);
+          work_queue.back().emplace_back(pair.ptr, type);
+        }
+      };
+      add_deps(current_target->public_deps(), PathDepType::PUBLIC);
+      if (private_deps)
+        add_deps(current_target->private_deps(), PathDepType::PRIVATE);
+      if (data_deps)
+        add_deps(current_target->data_deps(), PathDepType::DATA);
+    }
+  }
+
+  void AddPath(const Path& path, PathDepType implicit_last_dep) {
+    if (result_.total_paths() == 0 || options_.all)
+      result_.paths.push_back(DependencyPath{path, implicit_last_dep});
+
+    PathDepType type = implicit_last_dep == PathDepType::NONE
+                           ? PathDepType::PUBLIC
+                           : implicit_last_dep;
+    for (size_t i = 1; i < path.size(); i++) {
+      if (path[i].second == PathDepType::PRIVATE) {
+        if (type == PathDepType::PUBLIC)
+          type = PathDepType::PRIVATE;
+      } else if (path[i].second == PathDepType::DATA) {
+        type = PathDepType::DATA;
+      }
+    }
+
+    bool inserted = false;
+    for (size_t i = 1; i < path.size(); i++)
+      inserted |= found_paths_.emplace(path[i].first, type).second;
+    if (inserted) {
+      if (type == PathDepType::PUBLIC)
+        result_.public_paths++;
+      else
+        result_.other_paths++;
+    }
+  }
+
+  PathSearchOptions options_;
+  PathSearchResult result_;
+  std::map<const Target*, PathDepType> found_paths_;
+};
+
+std::string Describe(const PathSearchResult& result) {
+  const char* kDepTypes[] = {"", "public", "private", "data"};
+  std::string out;
+  for (const DependencyPath& path : result.paths) {
+    for (const auto& [target, type] : path.targets) {
+      if (type != PathDepType::NONE)
+        out += std::string(" --[") + kDepTypes[static_cast<int>(type)] +
+               "]--> ";
+      out += target->label().name();
+    }
+    if (path.implicit_last_dep != PathDepType::NONE) {
+      out += std::string(" --> see ") +
+             kDepTypes[static_cast<int>(path.implicit_last_dep)] + " chain";
+    }
+    out += "\n";
+  }
+  out += std::to_string(result.public_paths) + " public, " +
+         std::to_string(result.other_paths) + " other\n";
+  return out;
+}
+
+}  // namespace
+
+TEST(CommandPath, SameResultsAsUnprunedSearch) {
+  TestWithScope setup;
+
+  // A pseudo-random graph where targets only depend on the following ones,
+  // with all the kinds of deps, and many targets not leading anywhere.
+  constexpr size_t kTargetCount = 40;
+  std::vector<std::unique_ptr<TestTarget>> targets;
+  std::vector<const Target*> all_targets;
+  for (size_t i = 0; i < kTargetCount; i++) {
+    targets.push_back(std::make_unique<TestTarget>(
+        setup, "//:t" + std::to_string(i), Target::GROUP));
+    all_targets.push_back(targets.back().get());
+  }
+  uint32_t random = 1;
+  for (size_t i = 0; i < kTargetCount; i++) {
+    for (size_t j = i + 1; j < kTargetCount; j++) {
+      random = random * 1103515245 + 12345;
+      uint32_t value = (random >> 16) % 32;
+      LabelTargetPair dep(targets[j].get());
+      if (value < 2)
+        targets[i]->public_deps().push_back(dep);
+      else if (value < 3)
+        targets[i]->private_deps().push_back(dep);
+      else if (value < 4)
+        targets[i]->data_deps().push_back(dep);
+    }
+  }
+
+  int paths_found = 0;
+  for (bool all : {false, true}) {
+    for (int kinds = 0; kinds < 3; kinds++) {
+      PathSearchOptions options;
+      options.all = all;
+      options.public_only = kinds == 0;
+      options.with_data = kinds == 2;
+      for (size_t from = 0; from < kTargetCount; from += 3) {
+        for (size_t to = 0; to < kTargetCount; to += 5) {
+          PathSearchResult result = FindDependencyPaths(
+              all_targets, targets[from].get(), targets[to].get(), options);
+          PathSearchResult expected = ReferenceSearch(options).Run(
+              targets[from].get(), targets[to].get());
+          EXPECT_EQ(Describe(expected), Describe(result))
+              << "t" << from << " to t" << to << ", all: " << all
+              << ", kinds: " << kinds;
+          paths_found += result.total_paths();
+        }
+      }
+    }
+  }
+  EXPECT_GT(paths_found, 0);
+}
+
+}  // namespace commands
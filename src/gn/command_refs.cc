@@ -4,7 +4,6 @@
 
 #include <stddef.h>
 
-#include <map>
 #include <set>
 
 #include "base/command_line.h"
@@ -21,6 +20,7 @@
 #include "gn/standard_out.h"
 #include "gn/switches.h"
 #include "gn/target.h"
+#include "gn/target_graph_index.h"
 
 namespace commands {
 
@@ -29,19 +29,8 @@ namespace {
 using TargetSet = TargetSet;
 using TargetVector = std::vector<const Target*>;
 
-// Maps targets to the list of targets that depend on them.
-using DepMap = std::multimap<const Target*, const Target*>;
-
-// Populates the reverse dependency map for the targets in the Setup.
-void FillDepMap(Setup* setup, DepMap* dep_map) {
-  for (auto* target : setup->builder().GetAllResolvedTargets()) {
-    for (const auto& dep_pair : target->GetDeps(Target::DEPS_ALL))
-      dep_map->insert(std::make_pair(dep_pair.ptr, target));
-  }
-}
-
 // Forward declaration for function below.
-size_t RecursivePrintTargetDeps(const DepMap& dep_map,
+size_t RecursivePrintTargetDeps(const TargetGraphIndex& index,
                                 const Target* target,
                                 TargetSet* seen_targets,
                                 int indent_level);
@@ -52,7 +41,7 @@ size_t RecursivePrintTargetDeps(const DepMap& dep_map,
 // printed.
 //
 // Returns the number of items printed.
-size_t RecursivePrintTarget(const DepMap& dep_map,
+size_t RecursivePrintTarget(const TargetGraphIndex& index,
                             const Target* target,
                             TargetSet* seen_targets,
                             int indent_level) {
@@ -70,14 +59,14 @@ size_t RecursivePrintTarget(const DepMap& dep_map,
       print_children = false;
       // Only print "..." if something is actually elided, which means that
       // the current target has children.
-      if (dep_map.lower_bound(target) != dep_map.upper_bound(target))
+      if (!index.GetDependents(target).empty())
         OutputString("...");
     }
   }
 
   OutputString("\n");
   if (print_children) {
-    count += RecursivePrintTargetDeps(dep_map, target, seen_targets,
+    count += RecursivePrintTargetDeps(index, target, seen_targets,
                                       indent_level + 1);
   }
   return count;
@@ -85,77 +74,58 @@ size_t RecursivePrintTarget(const DepMap& dep_map,
 
 // Prints refs of the given target (not the target itself). See
 // RecursivePrintTarget.
-size_t RecursivePrintTargetDeps(const DepMap& dep_map,
+size_t RecursivePrintTargetDeps(const TargetGraphIndex& index,
                                 const Target* target,
                                 TargetSet* seen_targets,
                                 int indent_level) {
-  DepMap::const_iterator dep_begin = dep_map.lower_bound(target);
-  DepMap::const_iterator dep_end = dep_map.upper_bound(target);
   size_t count = 0;
-  for (DepMap::const_iterator cur_dep = dep_begin; cur_dep != dep_end;
-       cur_dep++) {
-    count += RecursivePrintTarget(dep_map, cur_dep->second, seen_targets,
-                                  indent_level);
+  for (const Target* dependent : index.GetDependents(target)) {
+    count +=
+        RecursivePrintTarget(index, dependent, seen_targets, indent_level);
   }
   return count;
 }
 
-void RecursiveCollectChildRefs(const DepMap& dep_map,
+void RecursiveCollectChildRefs(const TargetGraphIndex& index,
                                const Target* target,
                                TargetSet* results);
 
 // Recursively finds all targets that reference the given one, and additionally
 // adds the current one to the list.
-void RecursiveCollectRefs(const DepMap& dep_map,
+void RecursiveCollectRefs(const TargetGraphIndex& index,
                           const Target* target,
                           TargetSet* results) {
   if (!results->add(target))
     return;  // Already found this target.
-  RecursiveCollectChildRefs(dep_map, target, results);
+  RecursiveCollectChildRefs(index, target, results);
 }
 
 // Recursively finds all targets that reference the given one.
-void RecursiveCollectChildRefs(const DepMap& dep_map,
+void RecursiveCollectChildRefs(const TargetGraphIndex& index,
                                const Target* target,
                                TargetSet* results) {
-  DepMap::const_iterator dep_begin = dep_map.lower_bound(target);
-  DepMap::const_iterator dep_end = dep_map.upper_bound(target);
-  for (DepMap::const_iterator cur_dep = dep_begin; cur_dep != dep_end;
-       cur_dep++)
-    RecursiveCollectRefs(dep_map, cur_dep->second, results);
-}
-
-bool TargetReferencesConfig(const Target* target, const Config* config) {
-  for (const LabelConfigPair& cur : target->configs()) {
-    if (cur.ptr == config)
-      return true;
-  }
-  for (const LabelConfigPair& cur : target->public_configs()) {
-    if (cur.ptr == config)
-      return true;
-  }
-  return false;
+  for (const Target* dependent : index.GetDependents(target))
+    RecursiveCollectRefs(index, dependent, results);
 }
 
 void GetTargetsReferencingConfig(Setup* setup,
-                                 const std::vector<const Target*>& all_targets,
+                                 const TargetGraphIndex& index,
                                  const Config* config,
                                  bool default_toolchain_only,
                                  UniqueVector<const Target*>* matches) {
   Label default_toolchain = setup->loader()->default_toolchain_label();
-  for (auto* target : all_targets) {
+  for (const Target* target : index.GetTargetsReferencingConfig(config)) {
     if (default_toolchain_only) {
       // Only check targets in the default toolchain.
       if (target->label().GetToolchainLabel() != default_toolchain)
         continue;
     }
-    if (TargetReferencesConfig(target, config))
-      matches->push_back(target);
+    matches->push_back(target);
   }
 }
 
 // Returns the number of matches printed.
-size_t DoTreeOutput(const DepMap& dep_map,
+size_t DoTreeOutput(const TargetGraphIndex& index,
                     const UniqueVector<const Target*>& implicit_target_matches,
                     const UniqueVector<const Target*>& explicit_target_matches,
                     bool all) {
@@ -165,17 +135,17 @@ size_t DoTreeOutput(const DepMap& dep_map,
   // Implicit targets don't get printed themselves.
   for (const Target* target : implicit_target_matches) {
     if (all)
-      count += RecursivePrintTargetDeps(dep_map, target, nullptr, 0);
+      count += RecursivePrintTargetDeps(index, target, nullptr, 0);
     else
-      count += RecursivePrintTargetDeps(dep_map, target, &seen_targets, 0);
+      count += RecursivePrintTargetDeps(index, target, &seen_targets, 0);
   }
 
   // Explicit targets appear in the output.
   for (const Target* target : implicit_target_matches) {
     if (all)
-      count += RecursivePrintTarget(dep_map, target, nullptr, 0);
+      count += RecursivePrintTarget(index, target, nullptr, 0);
     else
-      count += RecursivePrintTarget(dep_map, target, &seen_targets, 0);
+      count += RecursivePrintTarget(index, target, &seen_targets, 0);
   }
 
   return count;
@@ -183,18 +153,18 @@ size_t DoTreeOutput(const DepMap& dep_map,
 
 // Returns the number of matches printed.
 size_t DoAllListOutput(
-    const DepMap& dep_map,
+    const TargetGraphIndex& index,
     const UniqueVector<const Target*>& implicit_target_matches,
     const UniqueVector<const Target*>& explicit_target_matches) {
   // Output recursive dependencies, uniquified and flattened.
   TargetSet results;
 
   for (const Target* target : implicit_target_matches)
-    RecursiveCollectChildRefs(dep_map, target, &results);
+    RecursiveCollectChildRefs(index, target, &results);
   for (const Target* target : explicit_target_matches) {
     // Explicit targets also get added to the output themselves.
     results.insert(target);
-    RecursiveCollectChildRefs(dep_map, target, &results);
+    RecursiveCollectChildRefs(index, target, &results);
   }
 
   FilterAndPrintTargetSet(false, results);
@@ -203,18 +173,15 @@ size_t DoAllListOutput(
 
 // Returns the number of matches printed.
 size_t DoDirectListOutput(
-    const DepMap& dep_map,
+    const TargetGraphIndex& index,
     const UniqueVector<const Target*>& implicit_target_matches,
     const UniqueVector<const Target*>& explicit_target_matches) {
   TargetSet results;
 
   // Output everything that refers to the implicit ones.
   for (const Target* target : implicit_target_matches) {
-    DepMap::const_iterator dep_begin = dep_map.lower_bound(target);
-    DepMap::const_iterator dep_end = dep_map.upper_bound(target);
-    for (DepMap::const_iterator cur_dep = dep_begin; cur_dep != dep_end;
-         cur_dep++)
-      results.insert(cur_dep->second);
+    for (const Target* dependent : index.GetDependents(target))
+      results.insert(dependent);
   }
 
   // And just output the explicit ones directly (these are the target matches
@@ -395,12 +362,11 @@ int RunRefs(const std::vector<std::string>& args) {
   // target_matches, however, since these targets should actually be listed in
   // the output, while for normal targets you don't want to see the inputs,
   // only what refers to them.
-  std::vector<const Target*> all_targets =
-      setup->builder().GetAllResolvedTargets();
+  TargetGraphIndex index(setup->builder().GetAllResolvedTargets());
   UniqueVector<const Target*> explicit_target_matches;
   for (const auto& file : file_matches) {
     std::vector<TargetContainingFile> target_containing;
-    GetTargetsContainingFile(setup, all_targets, file, default_toolchain_only,
+    GetTargetsContainingFile(setup, index, file, default_toolchain_only,
                              &target_containing);
 
     // Extract just the Target*.
@@ -408,7 +374,7 @@ int RunRefs(const std::vector<std::string>& args) {
       explicit_target_matches.push_back(pair.first);
   }
   for (auto* config : config_matches) {
-    GetTargetsReferencingConfig(setup, all_targets, config,
+    GetTargetsReferencingConfig(setup, index, config,
                                 default_toolchain_only,
                                 &explicit_target_matches);
   }
@@ -426,17 +392,13 @@ int RunRefs(const std::vector<std::string>& args) {
     return 1;
   }
 
-  // Construct the reverse dependency tree.
-  DepMap dep_map;
-  FillDepMap(setup, &dep_map);
-
   size_t cnt = 0;
   if (tree)
-    cnt = DoTreeOutput(dep_map, target_matches, explicit_target_matches, all);
+    cnt = DoTreeOutput(index, target_matches, explicit_target_matches, all);
   else if (all)
-    cnt = DoAllListOutput(dep_map, target_matches, explicit_target_matches);
+    cnt = DoAllListOutput(index, target_matches, explicit_target_matches);
   else
-    cnt = DoDirectListOutput(dep_map, target_matches, explicit_target_matches);
+    cnt = DoDirectListOutput(index, target_matches, explicit_target_matches);
 
   // If you ask for the references of a valid target, but that target has
   // nothing referencing it, we'll get here without having printed anything.
@@ -5,7 +5,7 @@
 #include "gn/commands.h"
 
 #include <fstream>
-#include <optional>
+#include <utility>
 
 #include "base/command_line.h"
 #include "base/environment.h"
@@ -15,7 +15,6 @@
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
 #include "gn/builder.h"
-#include "gn/config_values_extractors.h"
 #include "gn/filesystem_utils.h"
 #include "gn/item.h"
 #include "gn/label.h"
@@ -25,29 +24,29 @@
 #include "gn/standard_out.h"
 #include "gn/switches.h"
 #include "gn/target.h"
+#include "gn/target_graph_index.h"
 #include "util/atomic_write.h"
 #include "util/build_config.h"
+#include "util/worker_pool.h"
 
 namespace commands {
 
 namespace {
 
-// Like above but the input string can be a pattern that matches multiple
-// targets. If the input does not parse as a pattern, prints and error and
-// returns false. If the pattern is valid, fills the vector (which might be
-// empty if there are no matches) and returns true.
+// Parses the input string as a pattern that can match multiple targets. If
+// the input does not parse as a pattern, prints an error and returns false.
 //
 // If default_toolchain_only is true, a pattern with an unspecified toolchain
-// will match the default toolchain only. If true, all toolchains will be
+// will match the default toolchain only. If false, all toolchains will be
 // matched.
-bool ResolveTargetsFromCommandLinePattern(Setup* setup,
-                                          const std::string& label_pattern,
-                                          bool default_toolchain_only,
-                                          std::vector<const Target*>* matches) {
+bool GetCommandLinePattern(Setup* setup,
+                           const std::string& label_pattern,
+                           bool default_toolchain_only,
+                           LabelPattern* pattern) {
   Value pattern_value(nullptr, label_pattern);
 
   Err err;
-  LabelPattern pattern = LabelPattern::GetPattern(
+  *pattern = LabelPattern::GetPattern(
       SourceDirForCurrentDirectory(setup->build_settings().root_path()),
       setup->build_settings().root_path_utf8(), pattern_value, &err);
   if (err.has_error()) {
@@ -59,42 +58,54 @@ bool ResolveTargetsFromCommandLinePattern(Setup* setup,
     // By default a pattern with an empty toolchain will match all toolchains.
     // If the caller wants to default to the main toolchain only, set it
     // explicitly.
-    if (pattern.toolchain().is_null()) {
+    if (pattern->toolchain().is_null()) {
       // No explicit toolchain set.
-      pattern.set_toolchain(setup->loader()->default_toolchain_label());
+      pattern->set_toolchain(setup->loader()->default_toolchain_label());
     }
   }
-
-  std::vector<LabelPattern> pattern_vector;
-  pattern_vector.push_back(pattern);
-  FilterTargetsByPatterns(setup->builder().GetAllResolvedTargets(),
-                          pattern_vector, matches);
   return true;
 }
 
-// If there's an error, it will be printed and false will be returned.
+// Returns, for each of the patterns, the targets matching it in the order of
+// |targets|. The targets are matched against all the patterns at once, in
+// parallel.
+std::vector<std::vector<const Target*>> MatchTargetsByPatterns(
+    const std::vector<const Target*>& targets,
+    std::vector<LabelPattern> patterns) {
+  LabelPatternMatcher matcher(std::move(patterns));
+
+  // The (pattern index, target) pairs found in each range of targets.
+  std::vector<std::vector<std::pair<size_t, const Target*>>> chunks(
+      ParallelForRangeCount(targets.size()));
+  ParallelFor(targets.size(), [&targets, &matcher, &chunks](
+                                  size_t range, size_t begin, size_t end) {
+    std::vector<size_t> matches;
+    for (size_t target = begin; target < end; target++) {
+      matches.clear();
+      matcher.GetMatches(targets[target]->label(), &matches);
+      for (size_t pattern : matches)
+        chunks[range].emplace_back(pattern, targets[target]);
+    }
+  });
+
+  std::vector<std::vector<const Target*>> result(matcher.patterns().size());
+  for (const auto& chunk : chunks) {
+    for (const auto& match : chunk)
+      result[match.first].push_back(match.second);
+  }
+  return result;
+}
+
+// Resolves an input without wildcards. If there's an error, it will be printed
+// and false will be returned.
 bool ResolveStringFromCommandLineInput(
     Setup* setup,
     const SourceDir& current_dir,
     const std::string& input,
-    bool default_toolchain_only,
     UniqueVector<const Target*>* target_matches,
     UniqueVector<const Config*>* config_matches,
     UniqueVector<const Toolchain*>* toolchain_matches,
     UniqueVector<SourceFile>* file_matches) {
-  if (LabelPattern::HasWildcard(input)) {
-    // For now, only match patterns against targets. It might be nice in the
-    // future to allow the user to specify which types of things they want to
-    // match, but it should probably only match targets by default.
-    std::vector<const Target*> target_match_vector;
-    if (!ResolveTargetsFromCommandLinePattern(
-            setup, input, default_toolchain_only, &target_match_vector))
-      return false;
-    for (const Target* target : target_match_vector)
-      target_matches->push_back(target);
-    return true;
-  }
-
   // Try to figure out what this thing is.
   Err err;
   Label label = Label::Resolve(
@@ -202,30 +213,6 @@ bool ApplyTypeFilter(std::vector<const Target*>* targets) {
   return true;
 }
 
-// Returns the file path of the BUILD.gn file generating this item.
-base::FilePath BuildFileForItem(const Item* item) {
-  // Find the only BUILD.gn file listed in build_dependency_files() for
-  // this Item. This may not exist if the item is defined in BUILDCONFIG.gn
-  // instead, so account for this too.
-  const SourceFile* buildconfig_gn = nullptr;
-  const SourceFile* build_gn = nullptr;
-  for (const SourceFile& build_file : item->build_dependency_files()) {
-    const std::string& name = build_file.GetName();
-    if (name == "BUILDCONFIG.gn") {
-      buildconfig_gn = &build_file;
-    } else if (name == "BUILD.gn") {
-      build_gn = &build_file;
-      break;
-    }
-  }
-  if (!build_gn)
-    build_gn = buildconfig_gn;
-
-  CHECK(build_gn) << "No BUILD.gn or BUILDCONFIG.gn file defining "
-                  << item->label().GetUserVisibleName(true);
-  return build_gn->Resolve(item->settings()->build_settings()->root_path());
-}
-
 void PrintTargetsAsBuildfiles(const std::vector<const Target*>& targets,
                               base::ListValue* out) {
   // Output the set of unique source files.
@@ -260,27 +247,10 @@ void PrintTargetsAsOutputs(const std::vector<const Target*>& targets,
   if (targets.empty())
     return;
 
-  // Grab the build settings from a random target.
-  const BuildSettings* build_settings =
-      targets[0]->settings()->build_settings();
-
   for (const Target* target : targets) {
-    // Use the link output file if there is one, otherwise fall back to the
-    // dependency output file (for actions, for example).
-    OutputFile output_file = target->link_output_file();
-    if (output_file.value().empty() && target->has_dependency_output())
-      output_file = target->dependency_output();
-
-    // This output might be an omitted phony target, but that would mean we
-    // don't have an output file to list.
-    if (output_file.value().empty())
-      continue;
-
-    SourceFile output_as_source = output_file.AsSourceFile(build_settings);
-    std::string result =
-        RebasePath(output_as_source.value(), build_settings->build_dir(),
-                   build_settings->root_path_utf8());
-    out->AppendString(result);
+    std::string result = GetTargetOutputForPrinting(target);
+    if (!result.empty())
+      out->AppendString(result);
   }
 }
 
@@ -312,47 +282,6 @@ inline std::string FixGitBashLabelEdit(const std::string& label) {
 }
 #endif
 
-std::optional<HowTargetContainsFile> TargetContainsFile(
-    const Target* target,
-    const SourceFile& file) {
-  for (const auto& cur_file : target->sources()) {
-    if (cur_file == file)
-      return HowTargetContainsFile::kSources;
-  }
-  for (const auto& cur_file : target->public_headers()) {
-    if (cur_file == file)
-      return HowTargetContainsFile::kPublic;
-  }
-  for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
-    for (const auto& cur_file : iter.cur().inputs()) {
-      if (cur_file == file)
-        return HowTargetContainsFile::kInputs;
-    }
-  }
-  for (const auto& cur_file : target->data()) {
-    if (cur_file == file.value())
-      return HowTargetContainsFile::kData;
-    if (cur_file.back() == '/' && file.value().starts_with(cur_file))
-      return HowTargetContainsFile::kData;
-  }
-
-  if (target->action_values().script().value() == file.value())
-    return HowTargetContainsFile::kScript;
-
-  std::vector<SourceFile> output_sources;
-  target->action_values().GetOutputsAsSourceFiles(target, &output_sources);
-  for (const auto& cur_file : output_sources) {
-    if (cur_file == file)
-      return HowTargetContainsFile::kOutput;
-  }
-
-  for (const auto& cur_file : target->computed_outputs()) {
-    if (cur_file.AsSourceFile(target->settings()->build_settings()) == file)
-      return HowTargetContainsFile::kOutput;
-  }
-  return std::nullopt;
-}
-
 std::string ToUTF8(base::FilePath::StringType in) {
 #if defined(OS_WIN)
   return base::UTF16ToUTF8(in);
@@ -609,13 +538,47 @@ bool ResolveFromCommandLineInput(
     return false;
   }
 
+  // The patterns are all matched against the targets in a single pass once
+  // every input is parsed, and the targets of each input are then added in
+  // the order of the inputs.
   SourceDir cur_dir =
       SourceDirForCurrentDirectory(setup->build_settings().root_path());
-  for (const auto& cur : input) {
+  std::vector<LabelPattern> patterns;
+  std::vector<size_t> pattern_inputs;
+  std::vector<std::vector<const Target*>> input_targets(input.size());
+  for (size_t i = 0; i < input.size(); i++) {
+    if (LabelPattern::HasWildcard(input[i])) {
+      // For now, only match patterns against targets. It might be nice in the
+      // future to allow the user to specify which types of things they want
+      // to match, but it should probably only match targets by default.
+      LabelPattern pattern;
+      if (!GetCommandLinePattern(setup, input[i], default_toolchain_only,
+                                 &pattern))
+        return false;
+      patterns.push_back(std::move(pattern));
+      pattern_inputs.push_back(i);
+      continue;
+    }
+
+    UniqueVector<const Target*> targets;
     if (!ResolveStringFromCommandLineInput(
-            setup, cur_dir, cur, default_toolchain_only, target_matches,
-            config_matches, toolchain_matches, file_matches))
+            setup, cur_dir, input[i], &targets, config_matches,
+            toolchain_matches, file_matches))
       return false;
+    input_targets[i].assign(targets.begin(), targets.end());
+  }
+
+  if (!patterns.empty()) {
+    std::vector<std::vector<const Target*>> pattern_matches =
+        MatchTargetsByPatterns(setup->builder().GetAllResolvedTargets(),
+                               std::move(patterns));
+    for (size_t i = 0; i < pattern_inputs.size(); i++)
+      input_targets[pattern_inputs[i]] = std::move(pattern_matches[i]);
+  }
+
+  for (const std::vector<const Target*>& targets : input_targets) {
+    for (const Target* target : targets)
+      target_matches->push_back(target);
   }
   return true;
 }
@@ -734,20 +697,62 @@ void FilterAndPrintTargetSet(const TargetSet& targets, base::ListValue* out) {
   FilterAndPrintTargets(&target_vector, out);
 }
 
+base::FilePath BuildFileForItem(const Item* item) {
+  // Find the only BUILD.gn file listed in build_dependency_files() for
+  // this Item. This may not exist if the item is defined in BUILDCONFIG.gn
+  // instead, so account for this too.
+  const SourceFile* buildconfig_gn = nullptr;
+  const SourceFile* build_gn = nullptr;
+  for (const SourceFile& build_file : item->build_dependency_files()) {
+    const std::string& name = build_file.GetName();
+    if (name == "BUILDCONFIG.gn") {
+      buildconfig_gn = &build_file;
+    } else if (name == "BUILD.gn") {
+      build_gn = &build_file;
+      break;
+    }
+  }
+  if (!build_gn)
+    build_gn = buildconfig_gn;
+
+  CHECK(build_gn) << "No BUILD.gn or BUILDCONFIG.gn file defining "
+                  << item->label().GetUserVisibleName(true);
+  return build_gn->Resolve(item->settings()->build_settings()->root_path());
+}
+
+std::string GetTargetOutputForPrinting(const Target* target) {
+  const BuildSettings* build_settings = target->settings()->build_settings();
+
+  // Use the link output file if there is one, otherwise fall back to the
+  // dependency output file (for actions, for example).
+  OutputFile output_file = target->link_output_file();
+  if (output_file.value().empty() && target->has_dependency_output())
+    output_file = target->dependency_output();
+
+  // This output might be an omitted phony target, but that would mean we
+  // don't have an output file to list.
+  if (output_file.value().empty())
+    return std::string();
+
+  SourceFile output_as_source = output_file.AsSourceFile(build_settings);
+  return RebasePath(output_as_source.value(), build_settings->build_dir(),
+                    build_settings->root_path_utf8());
+}
+
 void GetTargetsContainingFile(Setup* setup,
-                              const std::vector<const Target*>& all_targets,
+                              const TargetGraphIndex& index,
                               const SourceFile& file,
                               bool default_toolchain_only,
                               std::vector<TargetContainingFile>* matches) {
   Label default_toolchain = setup->loader()->default_toolchain_label();
-  for (auto* target : all_targets) {
+  for (const TargetContainingFile& pair :
+       index.GetTargetsContainingFile(file)) {
     if (default_toolchain_only) {
       // Only check targets in the default toolchain.
-      if (target->label().GetToolchainLabel() != default_toolchain)
+      if (pair.first->label().GetToolchainLabel() != default_toolchain)
         continue;
     }
-    if (auto how = TargetContainsFile(target, file))
-      matches->emplace_back(target, *how);
+    matches->push_back(pair);
   }
 }
 
@@ -11,6 +11,7 @@
 #include <string_view>
 #include <vector>
 
+#include "base/files/file_path.h"
 #include "base/values.h"
 #include "gn/target.h"
 #include "gn/unique_vector.h"
@@ -21,6 +22,7 @@ class LabelPattern;
 class Setup;
 class SourceFile;
 class Target;
+class TargetGraphIndex;
 class Toolchain;
 
 namespace base {
@@ -352,6 +354,14 @@ void FilterAndPrintTargets(std::vector<const Target*>* targets,
 void FilterAndPrintTargetSet(bool indent, const TargetSet& targets);
 void FilterAndPrintTargetSet(const TargetSet& targets, base::ListValue* out);
 
+// Returns the file path of the BUILD.gn file declaring |item|. This is what
+// --as=buildfile prints.
+base::FilePath BuildFileForItem(const Item* item);
+
+// Returns the output file of |target| relative to the build directory, or an
+// empty string if it doesn't have one. This is what --as=output prints.
+std::string GetTargetOutputForPrinting(const Target* target);
+
 // Computes which targets reference the given file and also stores how the
 // target references the file.
 enum class HowTargetContainsFile {
@@ -364,7 +374,7 @@ enum class HowTargetContainsFile {
 };
 using TargetContainingFile = std::pair<const Target*, HowTargetContainsFile>;
 void GetTargetsContainingFile(Setup* setup,
-                              const std::vector<const Target*>& all_targets,
+                              const TargetGraphIndex& index,
                               const SourceFile& file,
                               bool default_toolchain_only,
                               std::vector<TargetContainingFile>* matches);
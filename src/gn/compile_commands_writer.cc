@@ -4,21 +4,32 @@
 
 #include "gn/compile_commands_writer.h"
 
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
 #include <sstream>
+#include <string_view>
+#include <unordered_map>
 
+#include "base/files/file_util.h"
 #include "base/json/string_escape.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
 #include "base/strings/stringprintf.h"
 #include "gn/builder.h"
 #include "gn/c_substitution_type.h"
 #include "gn/c_tool.h"
 #include "gn/config_values_extractors.h"
-#include "gn/deps_iterator.h"
 #include "gn/escape.h"
+#include "gn/filesystem_utils.h"
 #include "gn/ninja_target_command_util.h"
 #include "gn/path_output.h"
 #include "gn/string_output_buffer.h"
 #include "gn/substitution_writer.h"
+#include "gn/target_closure.h"
+#include "util/worker_pool.h"
 
 // Structure of JSON output file
 // [
@@ -221,69 +232,311 @@ void WriteCommand(const Target* target,
   }
 }
 
-void OutputJSON(const BuildSettings* build_settings,
-                std::vector<const Target*>& all_targets,
-                std::ostream& out) {
-  out << '[';
-  out << kPrettyPrintLineEnding;
+// Renders the compilation database entries of the C, C++ and Objective C
+// sources of the given target, separated by commas. Returns an empty string
+// if the target has no such sources.
+std::string RenderTargetEntries(const Target* target,
+                                const std::string& build_dir) {
+  std::ostringstream out;
   bool first = true;
-  auto build_dir = build_settings->GetFullPath(build_settings->build_dir())
-                       .StripTrailingSeparators();
   std::vector<OutputFile> tool_outputs;  // Prevent reallocation in loop.
 
   EscapeOptions opts;
   opts.mode = ESCAPE_NINJA_PREFORMATTED_COMMAND;
 
-  for (const auto* target : all_targets) {
-    if (!target->IsBinary())
+  // Precompute values that are the same for all sources in a target to avoid
+  // computing for every source.
+  PathOutput path_output(target->settings()->build_settings()->build_dir(),
+                         target->settings()->build_settings()->root_path_utf8(),
+                         ESCAPE_NINJA_COMMAND);
+
+  CompileFlags flags;
+  SetupCompileFlags(target, path_output, opts, flags);
+
+  CompiledSubstitutionList::Cache compiled_lists(target);
+
+  for (const auto& source : target->sources()) {
+    // If this source is not a C/C++/ObjC/ObjC++ source (not header) file,
+    // continue as it does not belong in the compilation database.
+    const SourceFile::Type source_type = source.GetType();
+    if (source_type != SourceFile::SOURCE_CPP &&
+        source_type != SourceFile::SOURCE_C &&
+        source_type != SourceFile::SOURCE_M &&
+        source_type != SourceFile::SOURCE_MM)
       continue;
 
-    // Precompute values that are the same for all sources in a target to avoid
-    // computing for every source.
-
-    PathOutput path_output(
-        target->settings()->build_settings()->build_dir(),
-        target->settings()->build_settings()->root_path_utf8(),
-        ESCAPE_NINJA_COMMAND);
-
-    CompileFlags flags;
-    SetupCompileFlags(target, path_output, opts, flags);
-
-    for (const auto& source : target->sources()) {
-      // If this source is not a C/C++/ObjC/ObjC++ source (not header) file,
-      // continue as it does not belong in the compilation database.
-      const SourceFile::Type source_type = source.GetType();
-      if (source_type != SourceFile::SOURCE_CPP &&
-          source_type != SourceFile::SOURCE_C &&
-          source_type != SourceFile::SOURCE_M &&
-          source_type != SourceFile::SOURCE_MM)
-        continue;
-
-      const char* tool_name = Tool::kToolNone;
-      if (!target->GetOutputFilesForSource(source, &tool_name, &tool_outputs))
-        continue;
-
-      if (!first) {
-        out << ',';
-        out << kPrettyPrintLineEnding;
-      }
-      first = false;
-      out << "  {";
-      out << kPrettyPrintLineEnding;
+    const char* tool_name = Tool::kToolNone;
+    if (!target->GetOutputFilesForSource(source, &tool_name, &tool_outputs,
+                                         &compiled_lists))
+      continue;
 
-      WriteFile(source, path_output, out);
-      WriteDirectory(base::StringPrintf("%" PRIsFP, PATH_CSTR(build_dir)), out);
-      WriteCommand(target, source, flags, tool_outputs, path_output,
-                   source_type, tool_name, opts, out);
-      out << "\"";
+    if (!first) {
+      out << ',';
       out << kPrettyPrintLineEnding;
-      out << "  }";
     }
+    first = false;
+    out << "  {";
+    out << kPrettyPrintLineEnding;
+
+    WriteFile(source, path_output, out);
+    WriteDirectory(build_dir, out);
+    WriteCommand(target, source, flags, tool_outputs, path_output, source_type,
+                 tool_name, opts, out);
+    out << "\"";
+    out << kPrettyPrintLineEnding;
+    out << "  }";
   }
+  return out.str();
+}
 
-  out << kPrettyPrintLineEnding;
-  out << "]";
-  out << kPrettyPrintLineEnding;
+void AppendField(std::string_view field, std::string* out) {
+  out->append(field);
+  out->push_back('\n');
+}
+
+std::string_view ValueOf(const std::string& value) {
+  return value;
+}
+std::string_view ValueOf(const SourceDir& dir) {
+  return dir.value();
+}
+std::string_view ValueOf(const SourceFile& file) {
+  return file.value();
+}
+
+template <typename T>
+void AppendList(std::string_view name,
+                const std::vector<T>& values,
+                std::string* out) {
+  AppendField(std::string(name) + " " + base::NumberToString(values.size()),
+              out);
+  for (const T& value : values)
+    AppendField(ValueOf(value), out);
+}
+
+// Returns a hash of everything the entries of the given target depend on,
+// other than the build and source directories: its sources, its compiler
+// flags and the C tools of its toolchain.
+std::string GetFingerprint(const Target* target) {
+  std::string description;
+  AppendField(target->label().GetUserVisibleName(true), &description);
+  AppendField(target->GetComputedOutputName(), &description);
+  AppendList("sources", target->sources(), &description);
+
+  AppendField(target->config_values().precompiled_header(), &description);
+  AppendField(target->config_values().precompiled_source().value(),
+              &description);
+  for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
+    const ConfigValues& values = iter.cur();
+    AppendList("defines", values.defines(), &description);
+    AppendList("include_dirs", values.include_dirs(), &description);
+    AppendList("framework_dirs", values.framework_dirs(), &description);
+    AppendList("frameworks", values.frameworks(), &description);
+    AppendList("weak_frameworks", values.weak_frameworks(), &description);
+    AppendList("cflags", values.cflags(), &description);
+    AppendList("cflags_c", values.cflags_c(), &description);
+    AppendList("cflags_cc", values.cflags_cc(), &description);
+    AppendList("cflags_objc", values.cflags_objc(), &description);
+    AppendList("cflags_objcc", values.cflags_objcc(), &description);
+  }
+
+  for (const char* name : {CTool::kCToolCc, CTool::kCToolCxx,
+                           CTool::kCToolCxxModule, CTool::kCToolObjC,
+                           CTool::kCToolObjCxx}) {
+    AppendField(name, &description);
+    const CTool* tool = target->toolchain()->GetToolAsC(name);
+    if (!tool)
+      continue;
+    AppendField(tool->command().AsString(), &description);
+    AppendField(base::NumberToString(tool->precompiled_header_type()),
+                &description);
+    for (const SubstitutionPattern& output : tool->outputs().list())
+      AppendField(output.AsString(), &description);
+  }
+
+  std::string hash = base::SHA1HashString(description);
+  return base::HexEncode(hash.data(), hash.size());
+}
+
+// The entries of one target in a compilation database.
+struct TargetEntries {
+  const Target* target = nullptr;
+
+  // Only computed when a cache is used.
+  std::string fingerprint;
+
+  // Either points to |rendered|, or to the entries of the target in a
+  // previously written database.
+  std::string_view entries;
+  std::string rendered;
+};
+
+// The entries written by a previous run, and their fingerprint.
+//
+// The cache file starts with a header line, identifying the options the
+// entries depend on. Then, for each database written by the previous run, a
+// "file <sha1> <path>" line is followed by one "<fingerprint> <offset>
+// <length> <label>" line for each target with entries in that database.
+// <sha1> is the hex SHA1 of the database as written.
+struct EntriesCache {
+  struct Entry {
+    std::string fingerprint;
+    std::string_view entries;
+  };
+
+  // Maps target labels to their entries in |databases|.
+  std::unordered_map<std::string, Entry> targets;
+
+  // The contents of the previous databases that are unchanged since they
+  // were written. Entries are referenced in place, so this must not
+  // reallocate its elements.
+  std::deque<std::string> databases;
+
+  // The paths of all the databases written by the previous run.
+  std::vector<std::string> paths;
+};
+
+// First line of the cache, followed by the options.
+const char kCacheHeader[] = "gn compile commands cache 2 ";
+
+// Returns the hash of a database recorded in the cache.
+std::string HashDatabase(const std::string& contents) {
+  std::string hash = base::SHA1HashString(contents);
+  return base::HexEncode(hash.data(), hash.size());
+}
+
+void LoadCache(const base::FilePath& path,
+               const std::string& options,
+               EntriesCache* cache) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return;
+
+  std::vector<std::string_view> lines = base::SplitStringPiece(
+      contents, "\n", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  if (lines.empty() || lines[0] != kCacheHeader + options)
+    return;
+
+  const std::string* database = nullptr;
+  for (size_t i = 1; i < lines.size(); i++) {
+    std::vector<std::string_view> fields = base::SplitStringPiece(
+        lines[i], " ", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL);
+    if (fields.size() >= 3 && fields[0] == "file") {
+      // The path is the rest of the line, and may contain spaces.
+      std::string_view db_path = lines[i].substr(
+          fields[0].size() + fields[1].size() + 2);
+      cache->paths.emplace_back(db_path);
+      database = nullptr;
+
+      std::string db_contents;
+      if (base::ReadFileToString(UTF8ToFilePath(db_path), &db_contents) &&
+          HashDatabase(db_contents) == fields[1]) {
+        cache->databases.push_back(std::move(db_contents));
+        database = &cache->databases.back();
+      }
+      continue;
+    }
+
+    size_t offset = 0;
+    size_t length = 0;
+    if (!database || fields.size() < 4 ||
+        !base::StringToSizeT(fields[1], &offset) ||
+        !base::StringToSizeT(fields[2], &length) ||
+        offset > database->size() || length > database->size() - offset)
+      continue;
+    std::string_view label = lines[i].substr(
+        fields[0].size() + fields[1].size() + fields[2].size() + 3);
+    cache->targets[std::string(label)] = {
+        std::string(fields[0]),
+        std::string_view(*database).substr(offset, length)};
+  }
+}
+
+// Renders the entries of the binary targets among the given ones in
+// parallel. If a cache is given, the entries of the targets whose
+// fingerprint didn't change are taken from it instead.
+std::vector<TargetEntries> RenderEntries(
+    const BuildSettings* build_settings,
+    const std::vector<const Target*>& all_targets,
+    const EntriesCache* cache) {
+  std::vector<TargetEntries> result;
+  for (const Target* target : all_targets) {
+    if (target->IsBinary())
+      result.emplace_back().target = target;
+  }
+
+  auto build_dir = build_settings->GetFullPath(build_settings->build_dir())
+                       .StripTrailingSeparators();
+  std::string build_dir_string =
+      base::StringPrintf("%" PRIsFP, PATH_CSTR(build_dir));
+
+  ParallelFor(result.size(), [&result, &build_dir_string, cache](
+                                 size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      TargetEntries& entries = result[i];
+      if (cache) {
+        entries.fingerprint = GetFingerprint(entries.target);
+        auto found = cache->targets.find(
+            entries.target->label().GetUserVisibleName(true));
+        if (found != cache->targets.end() &&
+            found->second.fingerprint == entries.fingerprint) {
+          entries.entries = found->second.entries;
+          continue;
+        }
+      }
+      entries.rendered = RenderTargetEntries(entries.target, build_dir_string);
+      entries.entries = entries.rendered;
+    }
+  });
+  return result;
+}
+
+// Writes the given entries as a compilation database. When |cache_contents|
+// is not null, appends to it the cache lines of the entries (see
+// EntriesCache), except for the leading file line which is only known once
+// the database is complete.
+void OutputJSON(const std::vector<const TargetEntries*>& entries,
+                StringOutputBuffer* out,
+                std::string* cache_contents) {
+  *out << "[";
+  *out << kPrettyPrintLineEnding;
+  bool first = true;
+  for (const TargetEntries* target_entries : entries) {
+    if (target_entries->entries.empty())
+      continue;
+    if (!first) {
+      *out << ",";
+      *out << kPrettyPrintLineEnding;
+    }
+    first = false;
+
+    if (cache_contents) {
+      *cache_contents += target_entries->fingerprint + " " +
+                         base::NumberToString(out->size()) + " " +
+                         base::NumberToString(target_entries->entries.size()) +
+                         " " +
+                         target_entries->target->label().GetUserVisibleName(
+                             true) +
+                         "\n";
+    }
+    *out << target_entries->entries;
+  }
+  *out << kPrettyPrintLineEnding;
+  *out << "]";
+  *out << kPrettyPrintLineEnding;
+}
+
+// Returns the top-level source directory containing the build file of the
+// given target, or an empty string for targets defined in the root build
+// file.
+std::string_view GetShardName(const Target* target) {
+  std::string_view dir = target->label().dir().value();
+  if (dir.size() < 2 || dir[0] != '/' || dir[1] != '/')
+    return std::string_view();
+  dir.remove_prefix(2);
+  size_t slash = dir.find('/');
+  return slash == std::string_view::npos ? std::string_view()
+                                         : dir.substr(0, slash);
 }
 
 }  // namespace
@@ -291,9 +544,14 @@ void OutputJSON(const BuildSettings* build_settings,
 std::string CompileCommandsWriter::RenderJSON(
     const BuildSettings* build_settings,
     std::vector<const Target*>& all_targets) {
+  std::vector<TargetEntries> entries =
+      RenderEntries(build_settings, all_targets, nullptr);
+  std::vector<const TargetEntries*> to_write;
+  for (const TargetEntries& target_entries : entries)
+    to_write.push_back(&target_entries);
+
   StringOutputBuffer json;
-  std::ostream out(&json);
-  OutputJSON(build_settings, all_targets, out);
+  OutputJSON(to_write, &json, nullptr);
   return json.str();
 }
 
@@ -303,17 +561,71 @@ bool CompileCommandsWriter::RunAndWriteFiles(
     const std::vector<LabelPattern>& patterns,
     const std::optional<std::string>& legacy_target_filters,
     const base::FilePath& output_path,
+    bool shard_by_directory,
+    const base::FilePath& cache_path,
     Err* err) {
   std::vector<const Target*> to_write = CollectTargets(
       build_settings, all_targets, patterns, legacy_target_filters, err);
   if (err->has_error())
     return false;
 
-  StringOutputBuffer json;
-  std::ostream output_to_json(&json);
-  OutputJSON(build_settings, to_write, output_to_json);
+  // The entries depend on the build directory, which is also where the
+  // source paths are made relative to.
+  std::string cache_options =
+      FilePathToUTF8(build_settings->GetFullPath(build_settings->build_dir())) +
+      " " + build_settings->root_path_utf8();
+  std::unique_ptr<EntriesCache> cache;
+  if (!cache_path.empty()) {
+    cache = std::make_unique<EntriesCache>();
+    LoadCache(cache_path, cache_options, cache.get());
+  }
+
+  std::vector<TargetEntries> entries =
+      RenderEntries(build_settings, to_write, cache.get());
+
+  // Maps the path of each database to its entries, in order.
+  std::map<base::FilePath, std::vector<const TargetEntries*>> databases;
+  if (shard_by_directory) {
+    for (const TargetEntries& target_entries : entries) {
+      std::string_view shard = GetShardName(target_entries.target);
+      base::FilePath path = output_path;
+      if (!shard.empty())
+        path = path.Append(UTF8ToFilePath(shard));
+      databases[path.AppendASCII("compile_commands.json")].push_back(
+          &target_entries);
+    }
+  } else {
+    std::vector<const TargetEntries*>& database = databases[output_path];
+    for (const TargetEntries& target_entries : entries)
+      database.push_back(&target_entries);
+  }
+
+  std::string cache_contents = kCacheHeader + cache_options + "\n";
+  std::set<std::string> written_paths;
+  for (const auto& [path, database_entries] : databases) {
+    StringOutputBuffer json;
+    std::string cache_lines;
+    OutputJSON(database_entries, &json, &cache_lines);
+    if (!json.WriteToFileIfChanged(path, err))
+      return false;
+
+    std::string path_string = FilePathToUTF8(path);
+    cache_contents += "file " + HashDatabase(json.str()) + " " + path_string +
+                      "\n" + cache_lines;
+    written_paths.insert(std::move(path_string));
+  }
 
-  return json.WriteToFileIfChanged(output_path, err);
+  if (cache_path.empty())
+    return true;
+
+  // Databases written by the previous run but not by this one, such as the
+  // shards of directories which no longer have targets, are removed rather
+  // than left stale.
+  for (const std::string& path : cache->paths) {
+    if (!written_paths.count(path))
+      base::DeleteFile(UTF8ToFilePath(path), false);
+  }
+  return WriteFile(cache_path, cache_contents, err);
 }
 
 std::vector<const Target*> CompileCommandsWriter::CollectTargets(
@@ -347,60 +659,7 @@ std::vector<const Target*> CompileCommandsWriter::CollectTargets(
                          legacy_matches.end());
   }
 
-  return CollectDepsOfMatches(input_targets);
-}
-
-std::vector<const Target*> CompileCommandsWriter::CollectDepsOfMatches(
-    const std::vector<const Target*>& input_targets) {
-  // The current set of matched targets.
-  TargetSet collected;
-
-  // Represents the next layer of the breadth-first seach. These are all targets
-  // that we haven't checked so far.
-  std::vector<const Target*> frontier;
-
-  // Collect the first level of target matches specified in the input. There may
-  // be duplicates so we still need to do the set checking.
-  // patterns match directly.
-  for (const Target* target : input_targets) {
-    if (!collected.contains(target)) {
-      collected.add(target);
-      frontier.push_back(target);
-    }
-  }
-
-  // Collects the dependencies for the next level of iteration. This could be
-  // inside the loop but is kept outside to avoid reallocating in every
-  // iteration.
-  std::vector<const Target*> next_frontier;
-
-  // Loop for each level of the search.
-  while (!frontier.empty()) {
-    for (const Target* target : frontier) {
-      // Check the target's dependencies.
-      for (const auto& pair : target->GetDeps(Target::DEPS_ALL)) {
-        if (!collected.contains(pair.ptr)) {
-          // New dependency found.
-          collected.add(pair.ptr);
-          next_frontier.push_back(pair.ptr);
-        }
-      }
-    }
-
-    // Swap to the new level and clear out the next one without deallocating the
-    // buffer (in most STL implementations, clear() doesn't free the existing
-    // buffer).
-    std::swap(frontier, next_frontier);
-    next_frontier.clear();
-  }
-
-  // Convert to vector for output.
-  std::vector<const Target*> output;
-  output.reserve(collected.size());
-  for (const Target* target : collected) {
-    output.push_back(target);
-  }
-  return output;
+  return TargetClosure(all_targets, Target::DEPS_ALL).Collect(input_targets);
 }
 
 std::vector<const Target*> CompileCommandsWriter::FilterLegacyTargets(
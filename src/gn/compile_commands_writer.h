@@ -29,6 +29,16 @@ class CompileCommandsWriter {
   //
   // The union of the legacy matches and the target patterns are used.
   //
+  // If |shard_by_directory| is set, |output_path| is a directory in which a
+  // separate database is written for each top-level source directory, as
+  // <dir>/compile_commands.json, holding the targets defined in that
+  // directory. Targets defined in the root build file go to
+  // compile_commands.json in |output_path| itself.
+  //
+  // Unless |cache_path| is empty, the fingerprint of each target and the
+  // location of its entries are saved there, so that the next run can copy
+  // the entries of unchanged targets instead of rendering them again.
+  //
   // TODO(https://bugs.chromium.org/p/gn/issues/detail?id=302):
   // Remove this legacy target filters behavior.
   static bool RunAndWriteFiles(
@@ -37,6 +47,8 @@ class CompileCommandsWriter {
       const std::vector<LabelPattern>& patterns,
       const std::optional<std::string>& legacy_target_filters,
       const base::FilePath& output_path,
+      bool shard_by_directory,
+      const base::FilePath& cache_path,
       Err* err);
 
   // Collects all the targets whose commands should get written as part of
@@ -51,11 +63,6 @@ class CompileCommandsWriter {
   static std::string RenderJSON(const BuildSettings* build_settings,
                                 std::vector<const Target*>& all_targets);
 
-  // Does a depth-first search of the graph starting at the input target and
-  // collects all recursive dependencies of those targets.
-  static std::vector<const Target*> CollectDepsOfMatches(
-      const std::vector<const Target*>& input_targets);
-
   // Performs the legacy target_name filtering.
   static std::vector<const Target*> FilterLegacyTargets(
       const std::vector<const Target*>& all_targets,
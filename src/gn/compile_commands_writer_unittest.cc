@@ -8,7 +8,10 @@
 #include <sstream>
 #include <utility>
 
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "gn/config.h"
+#include "gn/filesystem_utils.h"
 #include "gn/ninja_target_command_util.h"
 #include "gn/scheduler.h"
 #include "gn/target.h"
@@ -734,3 +737,77 @@ TEST_F(CompileCommandsTest, CollectTargets) {
   EXPECT_EQ(&target2, output[3]);
   EXPECT_EQ(&icu_target, output[4]);
 }
+
+TEST_F(CompileCommandsTest, CacheAndShards) {
+  Err err;
+
+  Target a(settings(), Label(SourceDir("//foo/"), "a"));
+  a.set_output_type(Target::SOURCE_SET);
+  a.sources().push_back(SourceFile("//foo/a.cc"));
+  a.SetToolchain(toolchain());
+  ASSERT_TRUE(a.OnResolved(&err));
+  Target b(settings(), Label(SourceDir("//"), "b"));
+  b.set_output_type(Target::SOURCE_SET);
+  b.sources().push_back(SourceFile("//b.cc"));
+  b.SetToolchain(toolchain());
+  ASSERT_TRUE(b.OnResolved(&err));
+  std::vector<const Target*> targets = {&a, &b};
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath output_path =
+      temp_dir.GetPath().AppendASCII("compile_commands.json");
+  base::FilePath cache_path =
+      temp_dir.GetPath().AppendASCII("compile_commands.cache");
+  auto run = [&](const base::FilePath& path, bool shard) {
+    return CompileCommandsWriter::RunAndWriteFiles(
+        build_settings(), targets, std::vector<LabelPattern>(),
+        std::string(), path, shard, cache_path, &err);
+  };
+
+  std::string contents;
+  ASSERT_TRUE(run(output_path, false));
+  ASSERT_TRUE(base::ReadFileToString(output_path, &contents));
+  EXPECT_EQ(CompileCommandsWriter::RenderJSON(build_settings(), targets),
+            contents);
+
+  // Entries are only copied from a previous database that is unchanged, even
+  // when an edit keeps its size.
+  ASSERT_TRUE(run(output_path, false));
+  ASSERT_TRUE(base::ReadFileToString(output_path, &contents));
+  EXPECT_EQ(CompileCommandsWriter::RenderJSON(build_settings(), targets),
+            contents);
+  size_t pos = contents.find("a.cc");
+  ASSERT_NE(std::string::npos, pos);
+  contents[pos] = 'x';
+  ASSERT_TRUE(WriteFile(output_path, contents, &err));
+  ASSERT_TRUE(run(output_path, false));
+  ASSERT_TRUE(base::ReadFileToString(output_path, &contents));
+  EXPECT_EQ(std::string::npos, contents.find("x.cc"));
+  EXPECT_EQ(CompileCommandsWriter::RenderJSON(build_settings(), targets),
+            contents);
+
+  // Changing the flags of a target renders its entries again.
+  a.config_values().defines().push_back("A");
+  ASSERT_TRUE(run(output_path, false));
+  ASSERT_TRUE(base::ReadFileToString(output_path, &contents));
+  EXPECT_EQ(CompileCommandsWriter::RenderJSON(build_settings(), targets),
+            contents);
+
+  // Shards hold the targets of each top-level directory, and replace the
+  // database written before.
+  base::FilePath shards_path = temp_dir.GetPath().AppendASCII("shards");
+  ASSERT_TRUE(run(shards_path, true));
+  EXPECT_FALSE(base::PathExists(output_path));
+  std::vector<const Target*> foo_targets = {&a};
+  ASSERT_TRUE(base::ReadFileToString(
+      shards_path.AppendASCII("foo").AppendASCII("compile_commands.json"),
+      &contents));
+  EXPECT_EQ(CompileCommandsWriter::RenderJSON(build_settings(), foo_targets),
+            contents);
+  std::vector<const Target*> root_targets = {&b};
+  ASSERT_TRUE(base::ReadFileToString(
+      shards_path.AppendASCII("compile_commands.json"), &contents));
+  EXPECT_EQ(CompileCommandsWriter::RenderJSON(build_settings(), root_targets),
+            contents);
+}
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <memory>
+#include <optional>
 #include <set>
 
 #include "base/json/json_writer.h"
@@ -23,6 +24,7 @@
 #include "gn/substitution_writer.h"
 #include "gn/swift_variables.h"
 #include "gn/variables.h"
+#include "util/worker_pool.h"
 
 // Example structure of Value for single target
 // (not applicable or empty fields will be omitted depending on target type)
@@ -319,8 +321,13 @@ class TargetDescBuilder : public BaseDescBuilder {
                     const std::set<std::string>& what,
                     bool all,
                     bool tree,
-                    bool blame)
-      : BaseDescBuilder(what, all, tree, blame), target_(target) {}
+                    bool blame,
+                    ResolvedTargetData* resolved,
+                    RuntimeDepsCache* runtime_deps)
+      : BaseDescBuilder(what, all, tree, blame),
+        target_(target),
+        resolved_(resolved),
+        runtime_deps_(runtime_deps) {}
 
   std::unique_ptr<base::DictionaryValue> BuildDescription() {
     auto res = std::make_unique<base::DictionaryValue>();
@@ -584,7 +591,9 @@ class TargetDescBuilder : public BaseDescBuilder {
     // currently implement a blame feature for this since the bottom-up
     // inheritance makes this difficult.
 
-    ResolvedTargetData resolved;
+    std::optional<ResolvedTargetData> own_resolved;
+    const ResolvedTargetData& resolved =
+        resolved_ ? *resolved_ : own_resolved.emplace();
 
     // Libs can be part of any target and get recursively pushed up the chain,
     // so display them regardless of target type.
@@ -735,7 +744,10 @@ class TargetDescBuilder : public BaseDescBuilder {
     auto res = std::make_unique<base::ListValue>();
 
     const Target* previous_from = NULL;
-    for (const auto& pair : ComputeRuntimeDeps(target_)) {
+    RuntimeDepsVector runtime_deps =
+        runtime_deps_ ? runtime_deps_->ComputeRuntimeDeps(target_)
+                      : ComputeRuntimeDeps(target_);
+    for (const auto& pair : runtime_deps) {
       std::string str;
       if (blame_) {
         // Generally a target's runtime deps will be listed sequentially, so
@@ -912,6 +924,10 @@ class TargetDescBuilder : public BaseDescBuilder {
   }
 
   const Target* target_;
+
+  // May be null, see DescBuilder::DescriptionForTarget().
+  ResolvedTargetData* resolved_;
+  RuntimeDepsCache* runtime_deps_;
 };
 
 }  // namespace
@@ -921,14 +937,34 @@ std::unique_ptr<base::DictionaryValue> DescBuilder::DescriptionForTarget(
     const std::string& what,
     bool all,
     bool tree,
-    bool blame) {
+    bool blame,
+    ResolvedTargetData* resolved,
+    RuntimeDepsCache* runtime_deps) {
   std::set<std::string> w;
   if (!what.empty())
     w.insert(what);
-  TargetDescBuilder b(target, w, all, tree, blame);
+  TargetDescBuilder b(target, w, all, tree, blame, resolved, runtime_deps);
   return b.BuildDescription();
 }
 
+void DescBuilder::DescribeTargets(
+    const std::vector<const Target*>& targets,
+    const std::string& what,
+    bool all,
+    bool tree,
+    bool blame,
+    const std::function<void(size_t, std::unique_ptr<base::DictionaryValue>)>&
+        callback) {
+  RuntimeDepsCache runtime_deps;
+  ParallelFor(targets.size(), [&](size_t, size_t begin, size_t end) {
+    ResolvedTargetData resolved;
+    for (size_t i = begin; i < end; i++) {
+      callback(i, DescriptionForTarget(targets[i], what, all, tree, blame,
+                                       &resolved, &runtime_deps));
+    }
+  });
+}
+
 std::unique_ptr<base::DictionaryValue> DescBuilder::DescriptionForConfig(
     const Config* config,
     const std::string& what) {
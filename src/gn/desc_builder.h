@@ -5,18 +5,43 @@
 #ifndef TOOLS_GN_DESC_BUILDER_H_
 #define TOOLS_GN_DESC_BUILDER_H_
 
+#include <functional>
+
 #include "base/values.h"
 #include "gn/target.h"
 
+class ResolvedTargetData;
+class RuntimeDepsCache;
+
 class DescBuilder {
  public:
   // Creates Dictionary representation for given target
+  //
+  // When describing several targets, passing the same |resolved| instance
+  // (from a single thread) and the same |runtime_deps| cache (from any
+  // thread) avoids recomputing the libs, lib_dirs, frameworks and runtime
+  // deps of their common dependencies. Private instances are used otherwise.
   static std::unique_ptr<base::DictionaryValue> DescriptionForTarget(
       const Target* target,
       const std::string& what,
       bool all,
       bool tree,
-      bool blame);
+      bool blame,
+      ResolvedTargetData* resolved = nullptr,
+      RuntimeDepsCache* runtime_deps = nullptr);
+
+  // Describes |targets| in parallel, calling |callback| on a worker thread
+  // with the index of each target and its description. The targets described
+  // by each thread share a ResolvedTargetData, and all of them share the
+  // runtime deps.
+  static void DescribeTargets(
+      const std::vector<const Target*>& targets,
+      const std::string& what,
+      bool all,
+      bool tree,
+      bool blame,
+      const std::function<void(size_t, std::unique_ptr<base::DictionaryValue>)>&
+          callback);
 
   // Creates Dictionary representation for given config
   static std::unique_ptr<base::DictionaryValue> DescriptionForConfig(
@@ -0,0 +1,100 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/desc_builder.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/json/json_writer.h"
+#include "base/strings/stringprintf.h"
+#include "gn/test_with_scheduler.h"
+#include "gn/test_with_scope.h"
+#include "util/test/test.h"
+
+namespace {
+
+std::string ToJSON(const base::DictionaryValue& description) {
+  std::string json;
+  base::JSONWriter::WriteWithOptions(
+      description, base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+  return json;
+}
+
+}  // namespace
+
+using DescBuilderTest = TestWithScheduler;
+
+// Describing targets together shares the resolved data and the runtime deps
+// of their common dependencies, which must not change their descriptions.
+TEST_F(DescBuilderTest, DescribeTargetsSharingDeps) {
+  TestWithScope setup;
+  InitCommandSwitchesForTesting();
+  Err err;
+
+  TestTarget base(setup, "//base:base", Target::STATIC_LIBRARY);
+  base.config_values().libs().push_back(LibFile("m"));
+  base.config_values().lib_dirs().push_back(SourceDir("//base/lib/"));
+  base.data().push_back("//base/base.dat");
+  ASSERT_TRUE(base.OnResolved(&err));
+
+  TestTarget common(setup, "//common:common", Target::SHARED_LIBRARY);
+  common.config_values().libs().push_back(LibFile("z"));
+  common.data().push_back("//common/common.dat");
+  common.public_deps().push_back(LabelTargetPair(&base));
+  ASSERT_TRUE(common.OnResolved(&err));
+
+  TestTarget data(setup, "//data:data", Target::GROUP);
+  data.data().push_back("//data/");
+  ASSERT_TRUE(data.OnResolved(&err));
+
+  // Enough executables to be described in several parallel ranges.
+  std::vector<std::unique_ptr<TestTarget>> apps;
+  std::vector<const Target*> targets = {&base, &common, &data};
+  for (size_t i = 0; i < 24; i++) {
+    apps.push_back(std::make_unique<TestTarget>(
+        setup, base::StringPrintf("//app:app%02zu", i), Target::EXECUTABLE));
+    TestTarget* app = apps.back().get();
+    app->private_deps().push_back(LabelTargetPair(&common));
+    if (i % 2)
+      app->private_deps().push_back(LabelTargetPair(&base));
+    if (i % 3)
+      app->data_deps().push_back(LabelTargetPair(&data));
+    ASSERT_TRUE(app->OnResolved(&err));
+    targets.push_back(app);
+  }
+
+  for (const char* what : {"", "runtime_deps", "libs", "lib_dirs", "deps"}) {
+    for (bool all : {false, true}) {
+      for (bool tree : {false, true}) {
+        std::vector<std::string> descriptions(targets.size());
+        DescBuilder::DescribeTargets(
+            targets, what, all, tree, false,
+            [&descriptions](
+                size_t i, std::unique_ptr<base::DictionaryValue> description) {
+              descriptions[i] = ToJSON(*description);
+            });
+        for (size_t i = 0; i < targets.size(); i++) {
+          EXPECT_EQ(ToJSON(*DescBuilder::DescriptionForTarget(
+                        targets[i], what, all, tree, false)),
+                    descriptions[i])
+              << targets[i]->label().GetUserVisibleName(false) << " " << what
+              << ", all: " << all << ", tree: " << tree;
+        }
+      }
+    }
+  }
+
+  // The runtime deps of the executables include the ones of their shared
+  // dependencies.
+  auto description =
+      DescBuilder::DescriptionForTarget(apps[1].get(), "runtime_deps", false,
+                                        false, false);
+  std::string runtime_deps = ToJSON(*description);
+  EXPECT_NE(std::string::npos, runtime_deps.find("../../common/common.dat"))
+      << runtime_deps;
+  EXPECT_NE(std::string::npos, runtime_deps.find("../../data/"))
+      << runtime_deps;
+}
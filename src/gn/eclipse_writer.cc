@@ -9,9 +9,10 @@
 
 #include "base/files/file_path.h"
 #include "gn/builder.h"
-#include "gn/config_values_extractors.h"
 #include "gn/filesystem_utils.h"
 #include "gn/loader.h"
+#include "gn/target.h"
+#include "gn/target_values_union.h"
 #include "gn/xml_element_writer.h"
 
 namespace {
@@ -70,46 +71,36 @@ bool EclipseWriter::RunAndWriteFile(const BuildSettings* build_settings,
 }
 
 void EclipseWriter::Run() {
-  GetAllIncludeDirs();
-  GetAllDefines();
+  std::vector<const Target*> targets;
+  for (const Target* target : builder_.GetAllResolvedTargets()) {
+    if (UsesDefaultToolchain(target))
+      targets.push_back(target);
+  }
+  TargetValuesUnion values(targets);
+  GetAllIncludeDirs(values);
+  GetAllDefines(values);
   WriteCDTSettings();
 }
 
-void EclipseWriter::GetAllIncludeDirs() {
-  std::vector<const Target*> targets = builder_.GetAllResolvedTargets();
-  for (const Target* target : targets) {
-    if (!UsesDefaultToolchain(target))
-      continue;
-
-    for (ConfigValuesIterator it(target); !it.done(); it.Next()) {
-      for (const SourceDir& include_dir : it.cur().include_dirs()) {
-        include_dirs_.insert(
-            FilePathToUTF8(build_settings_->GetFullPath(include_dir)));
-      }
-    }
+void EclipseWriter::GetAllIncludeDirs(const TargetValuesUnion& values) {
+  for (const SourceDir& include_dir : values.include_dirs()) {
+    include_dirs_.insert(
+        FilePathToUTF8(build_settings_->GetFullPath(include_dir)));
   }
 }
 
-void EclipseWriter::GetAllDefines() {
-  std::vector<const Target*> targets = builder_.GetAllResolvedTargets();
-  for (const Target* target : targets) {
-    if (!UsesDefaultToolchain(target))
-      continue;
-
-    for (ConfigValuesIterator it(target); !it.done(); it.Next()) {
-      for (const std::string& define : it.cur().defines()) {
-        size_t equal_pos = define.find('=');
-        std::string define_key;
-        std::string define_value;
-        if (equal_pos == std::string::npos) {
-          define_key = define;
-        } else {
-          define_key = define.substr(0, equal_pos);
-          define_value = define.substr(equal_pos + 1);
-        }
-        defines_[define_key] = define_value;
-      }
+void EclipseWriter::GetAllDefines(const TargetValuesUnion& values) {
+  for (const std::string& define : values.defines()) {
+    size_t equal_pos = define.find('=');
+    std::string define_key;
+    std::string define_value;
+    if (equal_pos == std::string::npos) {
+      define_key = define;
+    } else {
+      define_key = define.substr(0, equal_pos);
+      define_value = define.substr(equal_pos + 1);
     }
+    defines_[define_key] = define_value;
   }
 }
 
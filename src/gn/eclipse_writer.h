@@ -15,6 +15,7 @@ class BuildSettings;
 class Builder;
 class Err;
 class Target;
+class TargetValuesUnion;
 
 class EclipseWriter {
  public:
@@ -30,13 +31,13 @@ class EclipseWriter {
 
   void Run();
 
-  // Populates |include_dirs_| with the include dirs of all the targets for the
-  // default toolchain.
-  void GetAllIncludeDirs();
+  // Populates |include_dirs_| with the include dirs of |values|, collected
+  // from all the targets for the default toolchain.
+  void GetAllIncludeDirs(const TargetValuesUnion& values);
 
-  // Populates |defines_| with the defines of all the targets for the default
-  // toolchain.
-  void GetAllDefines();
+  // Populates |defines_| with the defines of |values|, collected from all the
+  // targets for the default toolchain.
+  void GetAllDefines(const TargetValuesUnion& values);
 
   // Returns true if |target| uses the default toolchain.
   bool UsesDefaultToolchain(const Target* target) const;
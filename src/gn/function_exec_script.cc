@@ -268,6 +268,8 @@ Value RunExecScript(Scope* scope,
         Err(function->function(), "Script returned non-zero exit code.", msg);
     return Value();
   }
+  g_scheduler->AddExecScriptResult(
+      FilePathToUTF8(cmdline.GetCommandLineString()) + '\n' + output);
 
   // Default to None value for the input conversion if unspecified.
   return ConvertInputToValue(scope->settings(), output, function,
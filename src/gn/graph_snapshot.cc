@@ -0,0 +1,360 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/graph_snapshot.h"
+
+#include <string.h>
+
+#include <string_view>
+#include <unordered_map>
+
+#include "base/files/file_util.h"
+#include "gn/build_settings.h"
+#include "gn/builder.h"
+#include "gn/commands.h"
+#include "gn/err.h"
+#include "gn/filesystem_utils.h"
+#include "gn/loader.h"
+#include "gn/source_dir.h"
+#include "last_commit_position.h"
+#include "util/atomic_write.h"
+
+namespace {
+
+// Increment when the format or the meaning of its fields changes.
+constexpr uint32_t kVersion = 2;
+constexpr char kMagic[8] = {'G', 'N', 'S', 'N', 'A', 'P', '\n', '\0'};
+
+const char kSnapshotFileName[] = "gn_graph.snapshot";
+
+// FNV-1a, only used to detect changes in the input files.
+uint64_t HashContents(std::string_view data) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+class Writer {
+ public:
+  void WriteUint32(uint32_t value) {
+    out_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void WriteUint64(uint64_t value) {
+    WriteUint32(static_cast<uint32_t>(value));
+    WriteUint32(static_cast<uint32_t>(value >> 32));
+  }
+
+  // Strings are written as an index into the string table.
+  void WriteString(std::string_view str) {
+    auto inserted = string_indices_.emplace(str, strings_.size());
+    if (inserted.second)
+      strings_.push_back(str);
+    WriteUint32(static_cast<uint32_t>(inserted.first->second));
+  }
+
+  void WriteLabel(const Label& label) {
+    WriteString(label.dir().value());
+    WriteString(label.name());
+    WriteString(label.toolchain_dir().value());
+    WriteString(label.toolchain_name());
+  }
+
+  // Returns the header, the string table and the records written so far.
+  // The string views passed to WriteString() must still be valid.
+  std::string Finish() const {
+    std::string result(kMagic, sizeof(kMagic));
+    Writer header;
+    header.WriteUint32(kVersion);
+    header.WriteUint32(static_cast<uint32_t>(strings_.size()));
+    for (std::string_view str : strings_) {
+      header.WriteUint32(static_cast<uint32_t>(str.size()));
+      header.out_.append(str);
+      header.out_.append((4 - str.size() % 4) % 4, '\0');
+    }
+    result.append(header.out_);
+    result.append(out_);
+    return result;
+  }
+
+ private:
+  std::string out_;
+  std::vector<std::string_view> strings_;
+  std::unordered_map<std::string_view, size_t> string_indices_;
+};
+
+// Decodes the output of Writer. All methods return false when reading past
+// the end of the data or when the data is invalid.
+class Reader {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  bool ReadHeader() {
+    if (data_.size() < sizeof(kMagic) ||
+        memcmp(data_.data(), kMagic, sizeof(kMagic)) != 0)
+      return false;
+    pos_ = sizeof(kMagic);
+
+    uint32_t version, string_count;
+    if (!ReadUint32(&version) || version != kVersion ||
+        !ReadUint32(&string_count))
+      return false;
+    // Each string takes at least 4 bytes.
+    if (string_count > (data_.size() - pos_) / 4)
+      return false;
+
+    strings_.reserve(string_count);
+    for (uint32_t i = 0; i < string_count; i++) {
+      uint32_t size;
+      if (!ReadUint32(&size) || size > data_.size() - pos_)
+        return false;
+      strings_.push_back(data_.substr(pos_, size));
+      size_t padded_size = size + (4 - size % 4) % 4;
+      if (padded_size > data_.size() - pos_)
+        return false;
+      pos_ += padded_size;
+    }
+    return true;
+  }
+
+  bool ReadUint32(uint32_t* value) {
+    if (data_.size() - pos_ < sizeof(*value))
+      return false;
+    memcpy(value, data_.data() + pos_, sizeof(*value));
+    pos_ += sizeof(*value);
+    return true;
+  }
+
+  bool ReadUint64(uint64_t* value) {
+    uint32_t low, high;
+    if (!ReadUint32(&low) || !ReadUint32(&high))
+      return false;
+    *value = (static_cast<uint64_t>(high) << 32) | low;
+    return true;
+  }
+
+  bool ReadString(std::string_view* str) {
+    uint32_t index;
+    if (!ReadUint32(&index) || index >= strings_.size())
+      return false;
+    *str = strings_[index];
+    return true;
+  }
+
+  bool ReadLabel(Label* label) {
+    std::string_view dir, name, toolchain_dir, toolchain_name;
+    if (!ReadString(&dir) || !ReadString(&name) ||
+        !ReadString(&toolchain_dir) || !ReadString(&toolchain_name))
+      return false;
+    if (!IsValidDir(dir) || !IsValidDir(toolchain_dir))
+      return false;
+    *label = Label(ToSourceDir(dir), name, ToSourceDir(toolchain_dir),
+                   toolchain_name);
+    return true;
+  }
+
+  bool at_end() const { return pos_ == data_.size(); }
+
+ private:
+  // SourceDir requires values starting and ending with a slash.
+  static bool IsValidDir(std::string_view dir) {
+    return dir.empty() || (dir.front() == '/' && dir.back() == '/');
+  }
+
+  static SourceDir ToSourceDir(std::string_view dir) {
+    return dir.empty() ? SourceDir() : SourceDir(dir);
+  }
+
+  std::string_view data_;
+  size_t pos_ = 0;
+  std::vector<std::string_view> strings_;
+};
+
+}  // namespace
+
+GraphSnapshot::GraphSnapshot() = default;
+GraphSnapshot::~GraphSnapshot() = default;
+GraphSnapshot::GraphSnapshot(GraphSnapshot&&) = default;
+GraphSnapshot& GraphSnapshot::operator=(GraphSnapshot&&) = default;
+
+// static
+base::FilePath GraphSnapshot::GetPath(const BuildSettings* build_settings) {
+  return build_settings->GetFullPath(
+      SourceFile(build_settings->build_dir().value() + kSnapshotFileName));
+}
+
+// static
+std::string GraphSnapshot::GetKey(const BuildSettings* build_settings) {
+  std::string key = "gn " LAST_COMMIT_POSITION "\nroot_target ";
+  if (!build_settings->root_target_label().is_null())
+    key += build_settings->root_target_label().GetUserVisibleName(false);
+  for (const LabelPattern& pattern : build_settings->root_patterns())
+    key += "\nroot_pattern " + pattern.Describe();
+  key += "\ndotfile " + FilePathToUTF8(build_settings->dotfile_name());
+  key += "\nscript_executable " +
+         FilePathToUTF8(build_settings->python_path());
+  return key;
+}
+
+// static
+void GraphSnapshot::Create(const BuildSettings* build_settings,
+                           const Builder& builder,
+                           const std::vector<base::FilePath>& input_files,
+                           GraphSnapshot* snapshot) {
+  snapshot->root_path_ = build_settings->root_path_utf8();
+  snapshot->key_ = GetKey(build_settings);
+  snapshot->default_toolchain_ = builder.loader()->GetDefaultToolchain();
+
+  snapshot->input_files_.clear();
+  for (const base::FilePath& path : input_files)
+    snapshot->input_files_.push_back(HashFile(path));
+
+  // Keep the order in which "gn ls" lists the targets of a loaded build.
+  std::vector<const Target*> targets = builder.GetAllResolvedTargets();
+  snapshot->targets_.clear();
+  snapshot->targets_.reserve(targets.size());
+  for (const Target* target : targets) {
+    TargetRecord& record = snapshot->targets_.emplace_back();
+    record.label = target->label();
+    record.output_type = target->output_type();
+    record.testonly = target->testonly();
+    record.build_file = FilePathToUTF8(commands::BuildFileForItem(target));
+    record.output = commands::GetTargetOutputForPrinting(target);
+  }
+}
+
+// static
+bool GraphSnapshot::LoadIfFresh(const BuildSettings* build_settings,
+                                GraphSnapshot* snapshot) {
+  return snapshot->ReadFromFile(GetPath(build_settings)) &&
+         snapshot->root_path_ == build_settings->root_path_utf8() &&
+         snapshot->key_ == GetKey(build_settings) &&
+         snapshot->InputsAreUnchanged();
+}
+
+bool GraphSnapshot::WriteToFile(const base::FilePath& path, Err* err) const {
+  Writer writer;
+  writer.WriteString(root_path_);
+  writer.WriteString(key_);
+  writer.WriteLabel(default_toolchain_);
+
+  // Paths are converted to UTF-8 first, keep them alive until Finish().
+  std::vector<std::string> paths;
+  paths.reserve(input_files_.size());
+  for (const InputFile& file : input_files_)
+    paths.push_back(FilePathToUTF8(file.path));
+
+  writer.WriteUint32(static_cast<uint32_t>(input_files_.size()));
+  for (size_t i = 0; i < input_files_.size(); i++) {
+    writer.WriteString(paths[i]);
+    writer.WriteUint32(input_files_[i].exists);
+    writer.WriteUint64(input_files_[i].size);
+    writer.WriteUint64(input_files_[i].hash);
+  }
+
+  writer.WriteUint32(static_cast<uint32_t>(targets_.size()));
+  for (const TargetRecord& record : targets_) {
+    writer.WriteLabel(record.label);
+    writer.WriteUint32(record.output_type);
+    writer.WriteUint32(record.testonly);
+    writer.WriteString(record.build_file);
+    writer.WriteString(record.output);
+  }
+
+  std::string contents = writer.Finish();
+  if (util::WriteFileAtomically(path, contents.data(),
+                                static_cast<int>(contents.size())) !=
+      static_cast<int>(contents.size())) {
+    *err = Err(Location(), "Unable to write graph snapshot.",
+               "I was writing \"" + FilePathToUTF8(path) + "\".");
+    return false;
+  }
+  return true;
+}
+
+bool GraphSnapshot::ReadFromFile(const base::FilePath& path) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return false;
+
+  Reader reader(contents);
+  std::string_view root_path, key;
+  uint32_t input_count;
+  if (!reader.ReadHeader() || !reader.ReadString(&root_path) ||
+      !reader.ReadString(&key) || !reader.ReadLabel(&default_toolchain_) ||
+      !reader.ReadUint32(&input_count))
+    return false;
+  root_path_ = root_path;
+  key_ = key;
+
+  input_files_.clear();
+  for (uint32_t i = 0; i < input_count; i++) {
+    std::string_view file_path;
+    uint32_t exists;
+    InputFile file;
+    if (!reader.ReadString(&file_path) || !reader.ReadUint32(&exists) ||
+        !reader.ReadUint64(&file.size) || !reader.ReadUint64(&file.hash))
+      return false;
+    file.exists = exists != 0;
+    file.path = UTF8ToFilePath(file_path);
+    input_files_.push_back(std::move(file));
+  }
+
+  uint32_t target_count;
+  if (!reader.ReadUint32(&target_count))
+    return false;
+  targets_.clear();
+  for (uint32_t i = 0; i < target_count; i++) {
+    TargetRecord record;
+    uint32_t output_type, testonly;
+    std::string_view build_file, output;
+    if (!reader.ReadLabel(&record.label) || !reader.ReadUint32(&output_type) ||
+        output_type > Target::RUST_PROC_MACRO ||
+        !reader.ReadUint32(&testonly) || !reader.ReadString(&build_file) ||
+        !reader.ReadString(&output))
+      return false;
+    record.output_type = static_cast<Target::OutputType>(output_type);
+    record.testonly = testonly != 0;
+    record.build_file = build_file;
+    record.output = output;
+    targets_.push_back(std::move(record));
+  }
+  return reader.at_end();
+}
+
+bool GraphSnapshot::InputsAreUnchanged() const {
+  for (const InputFile& file : input_files_) {
+    // Compare sizes first to avoid reading files that obviously changed.
+    int64_t size;
+    bool exists = base::GetFileSize(file.path, &size);
+    if (exists != file.exists)
+      return false;
+    if (!exists)
+      continue;
+    if (static_cast<uint64_t>(size) != file.size)
+      return false;
+
+    InputFile current = HashFile(file.path);
+    if (!current.exists || current.hash != file.hash)
+      return false;
+  }
+  return true;
+}
+
+// static
+GraphSnapshot::InputFile GraphSnapshot::HashFile(const base::FilePath& path) {
+  InputFile result;
+  result.path = path;
+
+  std::string contents;
+  if (base::ReadFileToString(path, &contents)) {
+    result.exists = true;
+    result.size = contents.size();
+    result.hash = HashContents(contents);
+  }
+  return result;
+}
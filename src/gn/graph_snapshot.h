@@ -0,0 +1,132 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_GRAPH_SNAPSHOT_H_
+#define TOOLS_GN_GRAPH_SNAPSHOT_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "gn/label.h"
+#include "gn/target.h"
+
+class Builder;
+class BuildSettings;
+class Err;
+
+// A compact summary of a resolved build graph, written by "gn gen
+// --graph-snapshot" to the build directory.
+//
+// Only "gn ls" answers from the snapshot instead of executing all the build
+// files again; the other query commands always load the build. A snapshot
+// records the GN version and the setup options the graph was loaded with
+// (see GetKey()), and every file that the graph was computed from (the same
+// set as build.ninja.d) with its size and a hash of its contents. It is only
+// used when all of them are unchanged.
+//
+// The file is a flat sequence of 32-bit fields and a string table: records
+// refer to strings by index and never contain pointers, so it can be read
+// with a single file read and decoded without further allocation other than
+// the records themselves.
+class GraphSnapshot {
+ public:
+  struct InputFile {
+    base::FilePath path;
+
+    // Files that don't exist are recorded too: creating them must invalidate
+    // the snapshot.
+    bool exists = false;
+    uint64_t size = 0;
+    uint64_t hash = 0;
+  };
+
+  struct TargetRecord {
+    Label label;
+    Target::OutputType output_type = Target::UNKNOWN;
+    bool testonly = false;
+
+    // Absolute path of the build file declaring the target.
+    std::string build_file;
+
+    // Output file relative to the build directory, empty if none. See
+    // commands::GetTargetOutputForPrinting().
+    std::string output;
+  };
+
+  GraphSnapshot();
+  ~GraphSnapshot();
+
+  GraphSnapshot(GraphSnapshot&&);
+  GraphSnapshot& operator=(GraphSnapshot&&);
+
+  // Returns the path of the snapshot for the given build.
+  static base::FilePath GetPath(const BuildSettings* build_settings);
+
+  // Creates a snapshot of the resolved graph in |builder|. |input_files| are
+  // the files the graph depends on.
+  static void Create(const BuildSettings* build_settings,
+                     const Builder& builder,
+                     const std::vector<base::FilePath>& input_files,
+                     GraphSnapshot* snapshot);
+
+  // Returns the key identifying the GN binary and the options of the given
+  // build that the loaded graph depends on besides its input files: the root
+  // target and patterns, the dotfile and the script executable.
+  static std::string GetKey(const BuildSettings* build_settings);
+
+  // Reads the snapshot of the given build. Returns false if there is none,
+  // or if it was written by another GN or for another source root or key,
+  // or if any of its input files changed since. In that case, the caller
+  // should load the build normally.
+  static bool LoadIfFresh(const BuildSettings* build_settings,
+                          GraphSnapshot* snapshot);
+
+  bool WriteToFile(const base::FilePath& path, Err* err) const;
+  bool ReadFromFile(const base::FilePath& path);
+
+  // Returns true if all the input files still have the recorded contents.
+  bool InputsAreUnchanged() const;
+
+  // Returns the current state of the file at |path|.
+  static InputFile HashFile(const base::FilePath& path);
+
+  // UTF-8 source root the snapshot was created for.
+  const std::string& root_path() const { return root_path_; }
+  void set_root_path(std::string root_path) {
+    root_path_ = std::move(root_path);
+  }
+
+  // See GetKey().
+  const std::string& key() const { return key_; }
+  void set_key(std::string key) { key_ = std::move(key); }
+
+  const Label& default_toolchain() const { return default_toolchain_; }
+  void set_default_toolchain(const Label& label) {
+    default_toolchain_ = label;
+  }
+
+  std::vector<InputFile>& input_files() { return input_files_; }
+  const std::vector<InputFile>& input_files() const { return input_files_; }
+
+  // In the order of Builder::GetAllResolvedTargets(), which is sorted by
+  // label.
+  std::vector<TargetRecord>& targets() { return targets_; }
+  const std::vector<TargetRecord>& targets() const { return targets_; }
+
+ private:
+  std::string root_path_;
+  std::string key_;
+  Label default_toolchain_;
+  std::vector<InputFile> input_files_;
+  std::vector<TargetRecord> targets_;
+
+  GraphSnapshot(const GraphSnapshot&) = delete;
+  GraphSnapshot& operator=(const GraphSnapshot&) = delete;
+};
+
+#endif  // TOOLS_GN_GRAPH_SNAPSHOT_H_
@@ -0,0 +1,210 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/graph_snapshot.h"
+
+#include <string>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/build_settings.h"
+#include "gn/builder.h"
+#include "gn/commands.h"
+#include "gn/err.h"
+#include "gn/filesystem_utils.h"
+#include "gn/loader.h"
+#include "gn/setup.h"
+#include "gn/switches.h"
+#include "gn/test_with_scheduler.h"
+#include "util/test/test.h"
+
+using GraphSnapshotTest = TestWithScheduler;
+
+namespace {
+
+bool WriteString(const base::FilePath& path, const std::string& data) {
+  return base::WriteFile(path, data.data(), static_cast<int>(data.size())) ==
+         static_cast<int>(data.size());
+}
+
+}  // namespace
+
+TEST(GraphSnapshot, RoundTrip) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath build_file = temp_dir.GetPath().AppendASCII("BUILD.gn");
+  base::FilePath missing_file = temp_dir.GetPath().AppendASCII("missing.gn");
+  ASSERT_TRUE(WriteString(build_file, "group(\"foo\") {}\n"));
+
+  GraphSnapshot snapshot;
+  snapshot.set_root_path("/root");
+  snapshot.set_key("gn 1\nroot_target //:root");
+  Label toolchain(SourceDir("//toolchain/"), "default");
+  snapshot.set_default_toolchain(toolchain);
+  snapshot.input_files().push_back(GraphSnapshot::HashFile(build_file));
+  snapshot.input_files().push_back(GraphSnapshot::HashFile(missing_file));
+  EXPECT_TRUE(snapshot.input_files()[0].exists);
+  EXPECT_FALSE(snapshot.input_files()[1].exists);
+
+  GraphSnapshot::TargetRecord foo;
+  foo.label = Label(SourceDir("//foo/"), "foo", toolchain.dir(),
+                    toolchain.name());
+  foo.output_type = Target::GROUP;
+  foo.build_file = "/root/foo/BUILD.gn";
+  snapshot.targets().push_back(foo);
+  GraphSnapshot::TargetRecord bar;
+  bar.label = Label(SourceDir("//foo/"), "bar_unittests",
+                    SourceDir("//toolchain/"), "other");
+  bar.output_type = Target::EXECUTABLE;
+  bar.testonly = true;
+  bar.build_file = "/root/foo/BUILD.gn";
+  bar.output = "other/bar_unittests";
+  snapshot.targets().push_back(bar);
+
+  base::FilePath snapshot_path = temp_dir.GetPath().AppendASCII("snapshot");
+  Err err;
+  ASSERT_TRUE(snapshot.WriteToFile(snapshot_path, &err));
+
+  GraphSnapshot read;
+  ASSERT_TRUE(read.ReadFromFile(snapshot_path));
+  EXPECT_EQ("/root", read.root_path());
+  EXPECT_EQ("gn 1\nroot_target //:root", read.key());
+  EXPECT_EQ(toolchain, read.default_toolchain());
+  ASSERT_EQ(2u, read.input_files().size());
+  EXPECT_EQ(build_file, read.input_files()[0].path);
+  EXPECT_EQ(snapshot.input_files()[0].hash, read.input_files()[0].hash);
+  EXPECT_FALSE(read.input_files()[1].exists);
+  ASSERT_EQ(2u, read.targets().size());
+  EXPECT_EQ(foo.label, read.targets()[0].label);
+  EXPECT_EQ(Target::GROUP, read.targets()[0].output_type);
+  EXPECT_FALSE(read.targets()[0].testonly);
+  EXPECT_EQ("", read.targets()[0].output);
+  EXPECT_EQ(bar.label, read.targets()[1].label);
+  EXPECT_EQ(Target::EXECUTABLE, read.targets()[1].output_type);
+  EXPECT_TRUE(read.targets()[1].testonly);
+  EXPECT_EQ("/root/foo/BUILD.gn", read.targets()[1].build_file);
+  EXPECT_EQ("other/bar_unittests", read.targets()[1].output);
+
+  // Truncated files are rejected.
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(snapshot_path, &contents));
+  ASSERT_TRUE(
+      WriteString(snapshot_path, contents.substr(0, contents.size() - 4)));
+  EXPECT_FALSE(read.ReadFromFile(snapshot_path));
+}
+
+TEST(GraphSnapshot, InputsAreUnchanged) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath build_file = temp_dir.GetPath().AppendASCII("BUILD.gn");
+  base::FilePath missing_file = temp_dir.GetPath().AppendASCII("missing.gn");
+  ASSERT_TRUE(WriteString(build_file, "group(\"foo\") {}\n"));
+
+  GraphSnapshot snapshot;
+  snapshot.input_files().push_back(GraphSnapshot::HashFile(build_file));
+  snapshot.input_files().push_back(GraphSnapshot::HashFile(missing_file));
+  EXPECT_TRUE(snapshot.InputsAreUnchanged());
+
+  // Same size, different contents.
+  ASSERT_TRUE(WriteString(build_file, "group(\"bar\") {}\n"));
+  EXPECT_FALSE(snapshot.InputsAreUnchanged());
+  ASSERT_TRUE(WriteString(build_file, "group(\"foo\") {}\n"));
+  EXPECT_TRUE(snapshot.InputsAreUnchanged());
+
+  // A file that didn't exist was created.
+  ASSERT_TRUE(WriteString(missing_file, ""));
+  EXPECT_FALSE(snapshot.InputsAreUnchanged());
+}
+
+TEST(GraphSnapshot, Key) {
+  BuildSettings build_settings;
+  std::string key = GraphSnapshot::GetKey(&build_settings);
+
+  // The options changing which targets are loaded change the key.
+  build_settings.SetRootTargetLabel(Label(SourceDir("//foo/"), "foo"));
+  std::string root_target_key = GraphSnapshot::GetKey(&build_settings);
+  EXPECT_NE(key, root_target_key);
+  build_settings.set_python_path(base::FilePath(FILE_PATH_LITERAL("python3")));
+  EXPECT_NE(root_target_key, GraphSnapshot::GetKey(&build_settings));
+}
+
+TEST_F(GraphSnapshotTest, CreateAndLoadIfFresh) {
+  base::ScopedTempDir in_temp_dir;
+  ASSERT_TRUE(in_temp_dir.CreateUniqueTempDir());
+  base::FilePath in_path = in_temp_dir.GetPath();
+  base::FilePath dotfile = in_path.Append(FILE_PATH_LITERAL(".gn"));
+  base::FilePath build_config =
+      in_path.Append(FILE_PATH_LITERAL("BUILDCONFIG.gn"));
+  base::FilePath build_file = in_path.Append(FILE_PATH_LITERAL("BUILD.gn"));
+  ASSERT_TRUE(WriteString(dotfile, "buildconfig = \"//BUILDCONFIG.gn\"\n"));
+  ASSERT_TRUE(
+      WriteString(build_config, "set_default_toolchain(\"//:default\")\n"));
+  ASSERT_TRUE(WriteString(build_file, R"(
+toolchain("default") {
+  tool("stamp") {
+    command = "stamp"
+  }
+}
+group("zzz") {
+  testonly = true
+}
+action("aaa") {
+  script = "script.py"
+  outputs = [ "$root_gen_dir/aaa.txt" ]
+}
+)"));
+
+  base::ScopedTempDir build_temp_dir;
+  ASSERT_TRUE(build_temp_dir.CreateUniqueTempDir());
+  base::CommandLine cmdline(base::CommandLine::NO_PROGRAM);
+  cmdline.AppendSwitch(switches::kRoot, FilePathToUTF8(in_path));
+  Setup setup;
+  ASSERT_TRUE(
+      setup.DoSetup(FilePathToUTF8(build_temp_dir.GetPath()), true, cmdline));
+  ASSERT_TRUE(setup.Run());
+  const BuildSettings* build_settings = &setup.build_settings();
+
+  GraphSnapshot snapshot;
+  GraphSnapshot::Create(build_settings, setup.builder(),
+                        {dotfile, build_config, build_file}, &snapshot);
+
+  // The targets are recorded in the order the builder lists them.
+  std::vector<const Target*> targets =
+      setup.builder().GetAllResolvedTargets();
+  ASSERT_EQ(targets.size(), snapshot.targets().size());
+  for (size_t i = 0; i < targets.size(); i++)
+    EXPECT_EQ(targets[i]->label(), snapshot.targets()[i].label);
+  ASSERT_EQ(2u, targets.size());
+  EXPECT_EQ("aaa", snapshot.targets()[0].label.name());
+  EXPECT_EQ(Target::ACTION, snapshot.targets()[0].output_type);
+  EXPECT_EQ(commands::GetTargetOutputForPrinting(targets[0]),
+            snapshot.targets()[0].output);
+  EXPECT_EQ(FilePathToUTF8(build_file), snapshot.targets()[0].build_file);
+  EXPECT_TRUE(snapshot.targets()[1].testonly);
+
+  Err err;
+  ASSERT_TRUE(
+      snapshot.WriteToFile(GraphSnapshot::GetPath(build_settings), &err));
+  GraphSnapshot loaded;
+  ASSERT_TRUE(GraphSnapshot::LoadIfFresh(build_settings, &loaded));
+  EXPECT_EQ(setup.builder().loader()->GetDefaultToolchain(),
+            loaded.default_toolchain());
+  ASSERT_EQ(2u, loaded.targets().size());
+  EXPECT_EQ(targets[1]->label(), loaded.targets()[1].label);
+
+  // Editing an input file makes the snapshot stale.
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(build_file, &contents));
+  ASSERT_TRUE(WriteString(build_file, contents + "# Comment.\n"));
+  EXPECT_FALSE(GraphSnapshot::LoadIfFresh(build_settings, &loaded));
+  ASSERT_TRUE(WriteString(build_file, contents));
+  EXPECT_TRUE(GraphSnapshot::LoadIfFresh(build_settings, &loaded));
+
+  // So does loading the build with other options.
+  setup.build_settings().set_python_path(
+      base::FilePath(FILE_PATH_LITERAL("python3")));
+  EXPECT_FALSE(GraphSnapshot::LoadIfFresh(build_settings, &loaded));
+}
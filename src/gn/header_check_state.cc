@@ -0,0 +1,146 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/header_check_state.h"
+
+#include <string_view>
+#include <vector>
+
+#include "base/files/file_util.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "gn/config_values_extractors.h"
+#include "gn/filesystem_utils.h"
+#include "gn/target.h"
+
+namespace {
+
+// First line of the saved state, followed by the options.
+const char kStateHeader[] = "gn header check state 1 ";
+
+void AppendField(std::string_view field, std::string* out) {
+  out->append(field);
+  out->push_back('\n');
+}
+
+}  // namespace
+
+HeaderCheckState::HeaderCheckState(std::string options)
+    : options_(std::move(options)) {}
+
+HeaderCheckState::~HeaderCheckState() = default;
+
+bool HeaderCheckState::Load(const base::FilePath& path) {
+  passed_.clear();
+
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return false;
+
+  std::vector<std::string_view> lines = base::SplitStringPiece(
+      contents, "\n", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  if (lines.empty() || lines[0] != kStateHeader + options_)
+    return false;
+
+  // Each following line is a signature and a label, separated by a space.
+  for (size_t i = 1; i < lines.size(); i++) {
+    size_t space = lines[i].find(' ');
+    if (space == std::string_view::npos) {
+      passed_.clear();
+      return false;
+    }
+    passed_.emplace(std::string(lines[i].substr(space + 1)),
+                    std::string(lines[i].substr(0, space)));
+  }
+  return true;
+}
+
+bool HeaderCheckState::Save(const base::FilePath& path) const {
+  std::string contents = kStateHeader + options_ + "\n";
+  for (const auto& [label, signature] : passed_)
+    contents += signature + " " + label + "\n";
+  return WriteFile(path, contents, nullptr);
+}
+
+bool HeaderCheckState::IsUpToDate(const Target* target) {
+  auto found = passed_.find(target->label().GetUserVisibleName(true));
+  return found != passed_.end() && found->second == GetSignature(target);
+}
+
+void HeaderCheckState::SetChecked(const Target* target, bool passed) {
+  std::string label = target->label().GetUserVisibleName(true);
+  if (passed)
+    passed_[std::move(label)] = GetSignature(target);
+  else
+    passed_.erase(label);
+}
+
+const std::string& HeaderCheckState::GetSignature(const Target* target) {
+  auto found = signatures_.find(target);
+  if (found != signatures_.end())
+    return found->second;
+
+  std::string description = GetExportedSignature(target);
+  AppendField(Target::GetStringForOutputType(target->output_type()),
+              &description);
+  AppendField(target->check_includes() ? "check" : "nocheck", &description);
+  for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
+    for (const SourceDir& dir : iter.cur().include_dirs())
+      AppendField(dir.value(), &description);
+  }
+
+  std::string hash = base::SHA1HashString(description);
+  return signatures_
+      .emplace(target, base::HexEncode(hash.data(), hash.size()))
+      .first->second;
+}
+
+const std::string& HeaderCheckState::GetExportedSignature(
+    const Target* target) {
+  auto found = exported_signatures_.find(target);
+  if (found != exported_signatures_.end())
+    return found->second;
+
+  std::string description;
+  AppendField(target->label().GetUserVisibleName(true), &description);
+
+  // The files other targets may include, and whether they are public.
+  AppendField(target->all_headers_public() ? "public" : "private",
+              &description);
+  for (const SourceFile& file : target->sources())
+    AppendField(file.value(), &description);
+  AppendField("public_headers", &description);
+  for (const SourceFile& file : target->public_headers())
+    AppendField(file.value(), &description);
+  AppendField("outputs", &description);
+  std::vector<SourceFile> outputs;
+  target->action_values().GetOutputsAsSourceFiles(target, &outputs);
+  if (target->builds_swift_module()) {
+    AppendField(target->swift_values().bridge_header().value(), &description);
+    target->swift_values().GetOutputsAsSourceFiles(target, &outputs);
+  }
+  for (const SourceFile& file : outputs)
+    AppendField(file.value(), &description);
+
+  AppendField("friends", &description);
+  for (const LabelPattern& pattern : target->friends())
+    AppendField(pattern.Describe(), &description);
+  AppendField("allow_circular_includes_from", &description);
+  for (const Label& label : target->allow_circular_includes_from())
+    AppendField(label.GetUserVisibleName(true), &description);
+
+  for (const auto& dep : target->public_deps()) {
+    description.append("+");
+    description.append(GetExportedSignature(dep.ptr));
+  }
+  for (const auto& dep : target->private_deps()) {
+    description.append("-");
+    description.append(GetExportedSignature(dep.ptr));
+  }
+
+  return exported_signatures_
+      .emplace(target, base::SHA1HashString(description))
+      .first->second;
+}
@@ -0,0 +1,72 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_HEADER_CHECK_STATE_H_
+#define TOOLS_GN_HEADER_CHECK_STATE_H_
+
+#include <map>
+#include <string>
+#include <unordered_map>
+
+class Target;
+
+namespace base {
+class FilePath;
+}
+
+// Remembers which targets passed the header check, and what the checker saw
+// of them at the time, so that an incremental check can skip the unchanged
+// files of targets whose dependencies haven't changed since.
+//
+// What the checker sees of a target is summarized as a signature. It covers
+// the target's include dirs, and everything its files can include: its files,
+// friends and circular include exceptions, and recursively the same for its
+// public and private deps. Targets that aren't dependencies of a target don't
+// affect its signature, even though they may own headers its files include.
+//
+// This class is not threadsafe.
+class HeaderCheckState {
+ public:
+  // The options are the checker settings affecting the results, a change of
+  // which invalidates the whole state.
+  explicit HeaderCheckState(std::string options);
+  ~HeaderCheckState();
+
+  // Reads the state saved by a previous check. Returns false, leaving the
+  // state empty, if there is no such state or if it was saved with other
+  // options.
+  bool Load(const base::FilePath& path);
+
+  // Writes the state for the next check. Returns true on success.
+  bool Save(const base::FilePath& path) const;
+
+  // Returns true if the target passed the previous check with the same
+  // signature as now.
+  bool IsUpToDate(const Target* target);
+
+  // Records the result of checking all the files of the given target.
+  void SetChecked(const Target* target, bool passed);
+
+  // Returns the signature of the given target (see above), as a hex string.
+  const std::string& GetSignature(const Target* target);
+
+ private:
+  // Returns the part of the signature that affects the dependents of the
+  // target, as raw bytes.
+  const std::string& GetExportedSignature(const Target* target);
+
+  std::string options_;
+
+  std::unordered_map<const Target*, std::string> signatures_;
+  std::unordered_map<const Target*, std::string> exported_signatures_;
+
+  // Maps the labels of the targets that passed the check to their
+  // signature at the time.
+  std::map<std::string, std::string> passed_;
+
+  HeaderCheckState(const HeaderCheckState&) = delete;
+  HeaderCheckState& operator=(const HeaderCheckState&) = delete;
+};
+
+#endif  // TOOLS_GN_HEADER_CHECK_STATE_H_
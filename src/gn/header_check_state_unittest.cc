@@ -0,0 +1,83 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/header_check_state.h"
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gn/test_with_scope.h"
+#include "util/test/test.h"
+
+TEST(HeaderCheckState, Signature) {
+  TestWithScope setup;
+  TestTarget a(setup, "//foo:a", Target::SOURCE_SET);
+  TestTarget b(setup, "//foo:b", Target::SOURCE_SET);
+  TestTarget c(setup, "//foo:c", Target::SOURCE_SET);
+  a.public_deps().push_back(LabelTargetPair(&b));
+
+  std::string a_signature;
+  std::string b_signature;
+  {
+    HeaderCheckState state("");
+    a_signature = state.GetSignature(&a);
+    b_signature = state.GetSignature(&b);
+    EXPECT_NE(a_signature, b_signature);
+  }
+
+  // The include dirs of B only affect B.
+  b.config_values().include_dirs().push_back(SourceDir("//include/"));
+  {
+    HeaderCheckState state("");
+    EXPECT_EQ(a_signature, state.GetSignature(&a));
+    EXPECT_NE(b_signature, state.GetSignature(&b));
+    b_signature = state.GetSignature(&b);
+  }
+
+  // The dependencies and files of B affect both.
+  b.private_deps().push_back(LabelTargetPair(&c));
+  {
+    HeaderCheckState state("");
+    EXPECT_NE(a_signature, state.GetSignature(&a));
+    EXPECT_NE(b_signature, state.GetSignature(&b));
+    a_signature = state.GetSignature(&a);
+  }
+  c.public_headers().push_back(SourceFile("//foo/c.h"));
+  {
+    HeaderCheckState state("");
+    EXPECT_NE(a_signature, state.GetSignature(&a));
+  }
+}
+
+TEST(HeaderCheckState, SaveAndLoad) {
+  TestWithScope setup;
+  TestTarget a(setup, "//foo:a", Target::SOURCE_SET);
+  TestTarget b(setup, "//foo:b", Target::SOURCE_SET);
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.GetPath().AppendASCII("header_check.state");
+
+  HeaderCheckState state("options");
+  EXPECT_FALSE(state.Load(path));
+  EXPECT_FALSE(state.IsUpToDate(&a));
+  state.SetChecked(&a, true);
+  state.SetChecked(&b, false);
+  EXPECT_TRUE(state.IsUpToDate(&a));
+  EXPECT_FALSE(state.IsUpToDate(&b));
+  ASSERT_TRUE(state.Save(path));
+
+  HeaderCheckState loaded("options");
+  ASSERT_TRUE(loaded.Load(path));
+  EXPECT_TRUE(loaded.IsUpToDate(&a));
+  EXPECT_FALSE(loaded.IsUpToDate(&b));
+
+  // Failing a target that passed before forgets it.
+  loaded.SetChecked(&a, false);
+  EXPECT_FALSE(loaded.IsUpToDate(&a));
+
+  // A state saved with other options is ignored.
+  HeaderCheckState other("other options");
+  EXPECT_FALSE(other.Load(path));
+  EXPECT_FALSE(other.IsUpToDate(&a));
+}
@@ -5,6 +5,7 @@
 #include "gn/header_checker.h"
 
 #include <algorithm>
+#include <unordered_set>
 
 #include "base/containers/queue.h"
 #include "base/files/file_util.h"
@@ -134,6 +135,14 @@ HeaderChecker::~HeaderChecker() = default;
 bool HeaderChecker::Run(const std::vector<const Target*>& to_check,
                         bool force_check,
                         std::vector<Err>* errors) {
+  return Run(to_check, force_check, FileFilter(), nullptr, errors);
+}
+
+bool HeaderChecker::Run(const std::vector<const Target*>& to_check,
+                        bool force_check,
+                        const FileFilter& should_check,
+                        std::set<const Target*>* failed_targets,
+                        std::vector<Err>* errors) {
   FileMap files_to_check;
   for (auto* check : to_check) {
     // This function will get called with all target types, but check only
@@ -141,15 +150,19 @@ bool HeaderChecker::Run(const std::vector<const Target*>& to_check,
     if (check->IsBinary())
       AddTargetToFileMap(check, &files_to_check);
   }
-  RunCheckOverFiles(files_to_check, force_check);
+  RunCheckOverFiles(files_to_check, force_check, should_check);
 
+  if (failed_targets)
+    failed_targets->insert(failed_targets_.begin(), failed_targets_.end());
   if (errors_.empty())
     return true;
   *errors = errors_;
   return false;
 }
 
-void HeaderChecker::RunCheckOverFiles(const FileMap& files, bool force_check) {
+void HeaderChecker::RunCheckOverFiles(const FileMap& files,
+                                      bool force_check,
+                                      const FileFilter& should_check) {
   WorkerPool pool;
 
   for (const auto& file : files) {
@@ -172,7 +185,8 @@ void HeaderChecker::RunCheckOverFiles(const FileMap& files, bool force_check) {
     }
 
     for (const auto& vect_i : file.second) {
-      if (vect_i.target->check_includes()) {
+      if (vect_i.target->check_includes() &&
+          (!should_check || should_check(vect_i.target, file.first))) {
         task_count_.Increment();
         pool.PostTask([this, target = vect_i.target, file = file.first]() {
           DoWork(target, file);
@@ -192,6 +206,7 @@ void HeaderChecker::DoWork(const Target* target, const SourceFile& file) {
   if (!CheckFile(target, file, &errors)) {
     std::lock_guard<std::mutex> lock(lock_);
     errors_.insert(errors_.end(), errors.begin(), errors.end());
+    failed_targets_.insert(target);
   }
 
   if (!task_count_.Decrement()) {
@@ -340,8 +355,6 @@ bool HeaderChecker::CheckFile(const Target* from_target,
 
   IncludeStringWithLocation include;
 
-  std::set<std::pair<const Target*, const Target*>> no_dependency_cache;
-
   while (iter.GetNextIncludeString(&include)) {
     if (include.system_style_include && !check_system_)
       continue;
@@ -351,7 +364,7 @@ bool HeaderChecker::CheckFile(const Target* from_target,
         SourceFileForInclude(include, include_dirs, input_file, &err);
     if (!included_file.is_null()) {
       CheckInclude(from_target, input_file, included_file, include.location,
-                   &no_dependency_cache, errors);
+                   errors);
     }
   }
 
@@ -364,13 +377,11 @@ bool HeaderChecker::CheckFile(const Target* from_target,
 //  - The dependency path to the included target must follow only public_deps.
 //  - If there are multiple targets with the header in it, only one need be
 //    valid for the check to pass.
-void HeaderChecker::CheckInclude(
-    const Target* from_target,
-    const InputFile& source_file,
-    const SourceFile& include_file,
-    const LocationRange& range,
-    std::set<std::pair<const Target*, const Target*>>* no_dependency_cache,
-    std::vector<Err>* errors) const {
+void HeaderChecker::CheckInclude(const Target* from_target,
+                                 const InputFile& source_file,
+                                 const SourceFile& include_file,
+                                 const LocationRange& range,
+                                 std::vector<Err>* errors) const {
   // Assume if the file isn't declared in our sources that we don't need to
   // check it. It would be nice if we could give an error if this happens, but
   // our include finder is too primitive and returns all includes, even if
@@ -428,28 +439,14 @@ void HeaderChecker::CheckInclude(
     if (to_target == from_target)
       return;
 
-    bool is_permitted_chain = false;
-
-    bool cached_no_dependency =
-        no_dependency_cache->find(std::make_pair(to_target, from_target)) !=
-        no_dependency_cache->end();
-
-    bool add_to_cache = !cached_no_dependency;
-
-    if (!cached_no_dependency &&
-        IsDependencyOf(to_target, from_target, &chain, &is_permitted_chain)) {
-      add_to_cache = false;
-
-      DCHECK(chain.size() >= 2);
-      DCHECK(chain[0].target == to_target);
-      DCHECK(chain[chain.size() - 1].target == from_target);
-
+    Reachability reachability = GetReachability(to_target, from_target);
+    if (reachability.reachable) {
       found_dependency = true;
 
       bool effectively_public =
           target.is_public || FriendMatches(to_target, from_target);
 
-      if (effectively_public && is_permitted_chain) {
+      if (effectively_public && reachability.permitted) {
         // This one is OK, we're done.
         last_error = Err();
         break;
@@ -462,12 +459,17 @@ void HeaderChecker::CheckInclude(
                          "Including a private header.",
                          "This file is private to the target " +
                              target.target->label().GetUserVisibleName(false));
-      } else if (!is_permitted_chain) {
+      } else {
+        // The chain is only needed to describe the error.
+        bool is_permitted_chain = false;
+        IsDependencyOf(to_target, from_target, &chain, &is_permitted_chain);
+        DCHECK(!is_permitted_chain);
+        DCHECK(chain.size() >= 2);
+        DCHECK(chain[0].target == to_target);
+        DCHECK(chain[chain.size() - 1].target == from_target);
         last_error = Err(CreatePersistentRange(source_file, range),
                          "Can't include this header from here.",
                          GetDependencyChainPublicError(chain));
-      } else {
-        NOTREACHED();
       }
     } else if (to_target->allow_circular_includes_from().find(
                    from_target->label()) !=
@@ -477,10 +479,6 @@ void HeaderChecker::CheckInclude(
       last_error = Err();
       break;
     }
-
-    if (add_to_cache) {
-      no_dependency_cache->emplace(to_target, from_target);
-    }
   }
 
   if (!found_dependency || last_error.has_error()) {
@@ -514,6 +512,67 @@ void HeaderChecker::CheckInclude(
   //    have the annoying false positive problem, but is complex to write.
 }
 
+HeaderChecker::Reachability HeaderChecker::GetReachability(
+    const Target* search_for,
+    const Target* search_from) const {
+  std::pair<const Target*, const Target*> key(search_for, search_from);
+  {
+    std::shared_lock<std::shared_mutex> lock(reachability_lock_);
+    auto found = reachability_cache_.find(key);
+    if (found != reachability_cache_.end())
+      return found->second;
+  }
+
+  // Other threads may compute the same pair concurrently, which is harmless
+  // since they all get the same result.
+  Reachability result;
+  if (search_for != search_from) {
+    result.permitted = CanReach(search_for, search_from, true);
+    result.reachable =
+        result.permitted || CanReach(search_for, search_from, false);
+  }
+
+  std::unique_lock<std::shared_mutex> lock(reachability_lock_);
+  reachability_cache_.emplace(key, result);
+  return result;
+}
+
+// static
+bool HeaderChecker::CanReach(const Target* search_for,
+                             const Target* search_from,
+                             bool require_permitted) {
+  // Same search as IsDependencyOf() below, but since the chain isn't needed
+  // the traversal order doesn't matter and no breadcrumbs are kept.
+  std::unordered_set<const Target*> visited;
+  std::vector<const Target*> stack;
+  auto visit = [&visited, &stack](const Target* target) {
+    if (visited.insert(target).second)
+      stack.push_back(target);
+  };
+
+  // A target can include headers from its direct deps regardless of
+  // public/private-ness.
+  for (const auto& dep : search_from->public_deps())
+    visit(dep.ptr);
+  for (const auto& dep : search_from->private_deps())
+    visit(dep.ptr);
+
+  while (!stack.empty()) {
+    const Target* target = stack.back();
+    stack.pop_back();
+    if (target == search_for)
+      return true;
+
+    for (const auto& dep : target->public_deps())
+      visit(dep.ptr);
+    if (!require_permitted) {
+      for (const auto& dep : target->private_deps())
+        visit(dep.ptr);
+    }
+  }
+  return false;
+}
+
 bool HeaderChecker::IsDependencyOf(const Target* search_for,
                                    const Target* search_from,
                                    Chain* chain,
@@ -10,7 +10,10 @@
 #include <map>
 #include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "base/atomic_ref_count.h"
@@ -68,9 +71,21 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
            bool force_check,
            std::vector<Err>* errors);
 
+  // Same as Run(), but only checks the files of the targets in to_check for
+  // which should_check returns true. The targets with errors are added to
+  // failed_targets.
+  using FileFilter =
+      std::function<bool(const Target* target, const SourceFile& file)>;
+  bool Run(const std::vector<const Target*>& to_check,
+           bool force_check,
+           const FileFilter& should_check,
+           std::set<const Target*>* failed_targets,
+           std::vector<Err>* errors);
+
  private:
   friend class base::RefCountedThreadSafe<HeaderChecker>;
   FRIEND_TEST_ALL_PREFIXES(HeaderCheckerTest, IsDependencyOf);
+  FRIEND_TEST_ALL_PREFIXES(HeaderCheckerTest, GetReachability);
   FRIEND_TEST_ALL_PREFIXES(HeaderCheckerTest, CheckInclude);
   FRIEND_TEST_ALL_PREFIXES(HeaderCheckerTest, PublicFirst);
   FRIEND_TEST_ALL_PREFIXES(HeaderCheckerTest, CheckIncludeAllowCircular);
@@ -102,7 +117,9 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
 
   // Backend for Run() that takes the list of files to check. The errors_ list
   // will be populate on failure.
-  void RunCheckOverFiles(const FileMap& flies, bool force_check);
+  void RunCheckOverFiles(const FileMap& flies,
+                         bool force_check,
+                         const FileFilter& should_check);
 
   void DoWork(const Target* target, const SourceFile& file);
 
@@ -128,15 +145,30 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
   // given include file. If disallowed, adds the error or errors to
   // the errors array.  The range indicates the location of the
   // include in the file for error reporting.
-  // |no_depeency_cache| is used to cache or check whether there is no
-  // dependency from |from_target| to target having |include_file|.
-  void CheckInclude(
-      const Target* from_target,
-      const InputFile& source_file,
-      const SourceFile& include_file,
-      const LocationRange& range,
-      std::set<std::pair<const Target*, const Target*>>* no_dependency_cache,
-      std::vector<Err>* errors) const;
+  void CheckInclude(const Target* from_target,
+                    const InputFile& source_file,
+                    const SourceFile& include_file,
+                    const LocationRange& range,
+                    std::vector<Err>* errors) const;
+
+  // Whether a target depends on another one, and whether through a permitted
+  // chain (see IsDependencyOf() below).
+  struct Reachability {
+    bool reachable = false;
+    bool permitted = false;
+  };
+
+  // Returns whether search_for is a dependency of search_from, like
+  // IsDependencyOf(), without computing the chain. Results are cached for
+  // the lifetime of the checker, which assumes the graph doesn't change.
+  Reachability GetReachability(const Target* search_for,
+                               const Target* search_from) const;
+
+  // Returns true if there is any dependency chain from search_from to
+  // search_for, only considering permitted ones if require_permitted is set.
+  static bool CanReach(const Target* search_for,
+                       const Target* search_from,
+                       bool require_permitted);
 
   // Returns true if the given search_for target is a dependency of
   // search_from.
@@ -199,6 +231,26 @@ class HeaderChecker : public base::RefCountedThreadSafe<HeaderChecker> {
 
   std::vector<Err> errors_;
 
+  // The targets for which errors_ has errors.
+  std::set<const Target*> failed_targets_;
+
+  struct TargetPairHash {
+    size_t operator()(
+        const std::pair<const Target*, const Target*>& p) const noexcept {
+      return std::hash<const Target*>()(p.first) * 31 +
+             std::hash<const Target*>()(p.second);
+    }
+  };
+
+  // Maps (search_for, search_from) pairs to the result of GetReachability().
+  // Includes are checked from many threads, and most lookups are hits, so
+  // readers share the lock.
+  mutable std::shared_mutex reachability_lock_;
+  mutable std::unordered_map<std::pair<const Target*, const Target*>,
+                             Reachability,
+                             TargetPairHash>
+      reachability_cache_;
+
   // Signaled when |task_count_| becomes zero.
   std::condition_variable task_count_cv_;
 
@@ -150,6 +150,52 @@ TEST_F(HeaderCheckerTest, IsDependencyOf) {
   EXPECT_TRUE(is_permitted);
 }
 
+TEST_F(HeaderCheckerTest, GetReachability) {
+  // Add a target P that privately depends on D, with A -> P -> D. A also
+  // publicly depends on C through B.
+  Err err;
+  Target p(setup_.settings(), Label(SourceDir("//p/"), "p"));
+  p.set_output_type(Target::SOURCE_SET);
+  p.SetToolchain(setup_.toolchain(), &err);
+  EXPECT_FALSE(err.has_error());
+  p.private_deps().push_back(LabelTargetPair(&d_));
+  p.visibility().SetPublic();
+  p.OnResolved(&err);
+  a_.private_deps().push_back(LabelTargetPair(&p));
+
+  auto checker = CreateChecker();
+
+  HeaderChecker::Reachability reachability = checker->GetReachability(&a_, &a_);
+  EXPECT_FALSE(reachability.reachable);
+
+  // Direct deps are permitted, whether public or private.
+  reachability = checker->GetReachability(&b_, &a_);
+  EXPECT_TRUE(reachability.reachable);
+  EXPECT_TRUE(reachability.permitted);
+  reachability = checker->GetReachability(&p, &a_);
+  EXPECT_TRUE(reachability.reachable);
+  EXPECT_TRUE(reachability.permitted);
+
+  reachability = checker->GetReachability(&c_, &a_);
+  EXPECT_TRUE(reachability.reachable);
+  EXPECT_TRUE(reachability.permitted);
+
+  // D is only reachable through P's private dep.
+  reachability = checker->GetReachability(&d_, &a_);
+  EXPECT_TRUE(reachability.reachable);
+  EXPECT_FALSE(reachability.permitted);
+
+  reachability = checker->GetReachability(&a_, &c_);
+  EXPECT_FALSE(reachability.reachable);
+
+  // The results are cached.
+  EXPECT_EQ(6u, checker->reachability_cache_.size());
+  reachability = checker->GetReachability(&d_, &a_);
+  EXPECT_TRUE(reachability.reachable);
+  EXPECT_FALSE(reachability.permitted);
+  EXPECT_EQ(6u, checker->reachability_cache_.size());
+}
+
 TEST_F(HeaderCheckerTest, CheckInclude) {
   InputFile input_file(SourceFile("//some_file.cc"));
   input_file.SetContents(std::string());
@@ -197,46 +243,35 @@ TEST_F(HeaderCheckerTest, CheckInclude) {
 
   auto checker = CreateChecker();
 
-  std::set<std::pair<const Target*, const Target*>> no_dependency_cache;
   // A file in target A can't include a header from D because A has no
   // dependency on D.
   std::vector<Err> errors;
-  checker->CheckInclude(&a_, input_file, d_header, range, &no_dependency_cache,
-                        &errors);
+  checker->CheckInclude(&a_, input_file, d_header, range, &errors);
   EXPECT_GT(errors.size(), 0);
 
   // A can include the public header in B.
   errors.clear();
-  no_dependency_cache.clear();
-  checker->CheckInclude(&a_, input_file, b_public, range, &no_dependency_cache,
-                        &errors);
+  checker->CheckInclude(&a_, input_file, b_public, range, &errors);
   EXPECT_EQ(errors.size(), 0);
 
   // Check A depending on the public and private headers in C.
   errors.clear();
-  no_dependency_cache.clear();
-  checker->CheckInclude(&a_, input_file, c_public, range, &no_dependency_cache,
-                        &errors);
+  checker->CheckInclude(&a_, input_file, c_public, range, &errors);
   EXPECT_EQ(errors.size(), 0);
   errors.clear();
-  no_dependency_cache.clear();
-  checker->CheckInclude(&a_, input_file, c_private, range, &no_dependency_cache,
-                        &errors);
+  checker->CheckInclude(&a_, input_file, c_private, range, &errors);
   EXPECT_GT(errors.size(), 0);
 
   // A can depend on a random file unknown to the build.
   errors.clear();
-  no_dependency_cache.clear();
   checker->CheckInclude(&a_, input_file, SourceFile("//random.h"), range,
-                        &no_dependency_cache, &errors);
+                        &errors);
   EXPECT_EQ(errors.size(), 0);
 
   // A can depend on a file present only in another toolchain even with no
   // dependency path.
   errors.clear();
-  no_dependency_cache.clear();
-  checker->CheckInclude(&a_, input_file, otc_header, range,
-                        &no_dependency_cache, &errors);
+  checker->CheckInclude(&a_, input_file, otc_header, range, &errors);
   EXPECT_EQ(errors.size(), 0);
 }
 
@@ -298,9 +333,7 @@ TEST_F(HeaderCheckerTest, CheckIncludeAllowCircular) {
 
   // A depends on B. So B normally can't include headers from A.
   std::vector<Err> errors;
-  std::set<std::pair<const Target*, const Target*>> no_dependency_cache;
-  checker->CheckInclude(&b_, input_file, a_public, range, &no_dependency_cache,
-                        &errors);
+  checker->CheckInclude(&b_, input_file, a_public, range, &errors);
   EXPECT_GT(errors.size(), 0);
 
   // Add an allow_circular_includes_from on A that lists B.
@@ -308,9 +341,7 @@ TEST_F(HeaderCheckerTest, CheckIncludeAllowCircular) {
 
   // Now the include from B to A should be allowed.
   errors.clear();
-  no_dependency_cache.clear();
-  checker->CheckInclude(&b_, input_file, a_public, range, &no_dependency_cache,
-                        &errors);
+  checker->CheckInclude(&b_, input_file, a_public, range, &errors);
   EXPECT_EQ(errors.size(), 0);
 }
 
@@ -345,20 +376,15 @@ TEST_F(HeaderCheckerTest, CheckIncludeSwiftModule) {
   LocationRange range;  // Dummy value.
 
   std::vector<Err> errors;
-  std::set<std::pair<const Target*, const Target*>> no_dependency_cache;
 
   // Check that unrelated target D cannot include header generated by S.
   errors.clear();
-  no_dependency_cache.clear();
-  checker->CheckInclude(&d_, input_file, generated_header, range,
-                        &no_dependency_cache, &errors);
+  checker->CheckInclude(&d_, input_file, generated_header, range, &errors);
   EXPECT_GT(errors.size(), 0);
 
   // Check that unrelated target D cannot include S's bridge header.
   errors.clear();
-  no_dependency_cache.clear();
-  checker->CheckInclude(&d_, input_file, bridge_header, range,
-                        &no_dependency_cache, &errors);
+  checker->CheckInclude(&d_, input_file, bridge_header, range, &errors);
   EXPECT_GT(errors.size(), 0);
 }
 
@@ -461,15 +487,11 @@ TEST_F(HeaderCheckerTest, Friend) {
 
   // B should not be allowed to include C's private header.
   std::vector<Err> errors;
-  std::set<std::pair<const Target*, const Target*>> no_dependency_cache;
-  checker->CheckInclude(&b_, input_file, c_private, range, &no_dependency_cache,
-                        &errors);
+  checker->CheckInclude(&b_, input_file, c_private, range, &errors);
   EXPECT_GT(errors.size(), 0);
 
   // A should be able to because of the friend declaration.
   errors.clear();
-  no_dependency_cache.clear();
-  checker->CheckInclude(&a_, input_file, c_private, range, &no_dependency_cache,
-                        &errors);
+  checker->CheckInclude(&a_, input_file, c_private, range, &errors);
   EXPECT_EQ(errors.size(), 0);
 }
@@ -274,6 +274,18 @@ void InputFileManager::AddAllPhysicalInputFileNamesToVectorSetSorter(
   }
 }
 
+std::vector<const InputFile*>
+InputFileManager::GetAllLoadedPhysicalInputFiles() const {
+  std::lock_guard<std::mutex> lock(lock_);
+
+  std::vector<const InputFile*> files;
+  for (const auto& file : input_files_) {
+    if (file.second->loaded && !file.second->file.physical_name().empty())
+      files.push_back(&file.second->file);
+  }
+  return files;
+}
+
 void InputFileManager::BackgroundLoadFile(const LocationRange& origin,
                                           const BuildSettings* build_settings,
                                           const SourceFile& name,
@@ -102,6 +102,10 @@ class InputFileManager : public base::RefCountedThreadSafe<InputFileManager> {
   void AddAllPhysicalInputFileNamesToVectorSetSorter(
       VectorSetSorter<base::FilePath>* sorter) const;
 
+  // Returns the loaded physical input files, in no particular order. Their
+  // contents stay valid as long as this InputFileManager instance.
+  std::vector<const InputFile*> GetAllLoadedPhysicalInputFiles() const;
+
   void set_load_file_callback(SyncLoadFileCallback load_file_callback) {
     load_file_callback_ = load_file_callback;
   }
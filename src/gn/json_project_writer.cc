@@ -10,18 +10,29 @@
 #include <vector>
 
 #include "base/command_line.h"
+#include "base/files/file.h"
 #include "base/files/file_path.h"
+#include "base/files/file_util.h"
 #include "base/json/json_writer.h"
 #include "base/json/string_escape.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
 #include "gn/builder.h"
 #include "gn/commands.h"
+#include "gn/config.h"
 #include "gn/deps_iterator.h"
 #include "gn/desc_builder.h"
 #include "gn/filesystem_utils.h"
+#include "gn/input_file.h"
 #include "gn/invoke_python.h"
+#include "gn/resolved_target_data.h"
 #include "gn/scheduler.h"
 #include "gn/settings.h"
 #include "gn/string_output_buffer.h"
+#include "gn/target_closure.h"
+#include "last_commit_position.h"
+#include "util/worker_pool.h"
 
 // Structure of JSON output file
 // {
@@ -40,14 +51,6 @@
 
 namespace {
 
-void AddTargetDependencies(const Target* target, TargetSet* deps) {
-  for (const auto& pair : target->GetDeps(Target::DEPS_LINKED)) {
-    if (deps->add(pair.ptr)) {
-      AddTargetDependencies(pair.ptr, deps);
-    }
-  }
-}
-
 // Filters targets according to filter string; Will also recursively
 // add dependent targets.
 bool FilterTargets(const BuildSettings* build_settings,
@@ -64,18 +67,16 @@ bool FilterTargets(const BuildSettings* build_settings,
                                             &filters, err)) {
       return false;
     }
-    commands::FilterTargetsByPatterns(all_targets, filters, targets);
-
-    TargetSet target_set(targets->begin(), targets->end());
-    for (const auto* target : *targets)
-      AddTargetDependencies(target, &target_set);
-
-    targets->assign(target_set.begin(), target_set.end());
+    std::vector<const Target*> matches;
+    commands::FilterTargetsByPatterns(all_targets, filters, &matches);
+    *targets = TargetClosure(all_targets, Target::DEPS_LINKED).Collect(matches);
   }
 
   // Sort the list of targets per-label to get a consistent ordering of them
   // in the generated project (and thus stability of the file generated).
-  std::sort(targets->begin(), targets->end(),
+  // The closure follows the order of all_targets, so a stable sort also
+  // keeps targets with the same name in a consistent order.
+  std::stable_sort(targets->begin(), targets->end(),
             [](const Target* a, const Target* b) {
               return a->label().name() < b->label().name();
             });
@@ -83,8 +84,199 @@ bool FilterTargets(const BuildSettings* build_settings,
   return true;
 }
 
+// Hashes of the files read by gen.
+//
+// The description of a target only depends on the build files of its
+// directory and of the directories of its toolchain and configs, on the
+// descriptions of its dependencies, and on inputs shared by all the targets:
+// the other files read by gen (.gni files, files read by scripts, ...), the
+// results of exec_script() and the build arguments.
+struct InputHashes {
+  // Hex hash of the shared inputs.
+  std::string shared;
+
+  // Hashes of the build files of each source directory.
+  std::unordered_map<std::string, std::string> build_files;
+};
+
+InputHashes HashInputFiles(const BuildSettings* build_settings) {
+  // The build files are still in memory, so they are hashed without being
+  // read again. The other files read by gen (see AddGenDependency()) are only
+  // checked for a change of size or modification time.
+  std::vector<const InputFile*> input_files =
+      g_scheduler->input_file_manager()->GetAllLoadedPhysicalInputFiles();
+  std::vector<base::FilePath> other_files = g_scheduler->GetGenDependencies();
+  std::vector<std::pair<base::FilePath, std::string>> files(
+      input_files.size() + other_files.size());
+  ParallelFor(files.size(), [&input_files, &other_files, &files](
+                                size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      if (i < input_files.size()) {
+        files[i].first = input_files[i]->physical_name();
+        files[i].second = base::SHA1HashString(input_files[i]->contents());
+        continue;
+      }
+      // Missing files hash as empty ones, the file names are hashed too.
+      files[i].first = other_files[i - input_files.size()];
+      base::File::Info info;
+      if (base::GetFileInfo(files[i].first, &info)) {
+        files[i].second = base::NumberToString(info.size) + " " +
+                          base::NumberToString(info.last_modified);
+      }
+    }
+  });
+
+  // A file read both as a build file and by a script keeps the hash of its
+  // contents.
+  std::stable_sort(
+      files.begin(), files.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+  files.erase(std::unique(files.begin(), files.end(),
+                          [](const auto& a, const auto& b) {
+                            return a.first == b.first;
+                          }),
+              files.end());
+
+  // Build files of the secondary source tree apply to the directories of the
+  // main tree.
+  std::string root_path = FilePathToUTF8(build_settings->root_path());
+  std::string secondary_dir;
+  if (!build_settings->secondary_source_path().empty() &&
+      MakeAbsolutePathRelativeIfPossible(
+          root_path, FilePathToUTF8(build_settings->secondary_source_path()),
+          &secondary_dir) &&
+      !secondary_dir.ends_with('/')) {
+    secondary_dir.push_back('/');
+  }
+
+  InputHashes result;
+  std::string shared;
+  for (const auto& [file_path, file_hash] : files) {
+    std::string path = FilePathToUTF8(file_path);
+    std::string file;
+    if (MakeAbsolutePathRelativeIfPossible(root_path, path, &file)) {
+      size_t slash = file.rfind('/');
+      std::string_view name = std::string_view(file).substr(slash + 1);
+      if (name.starts_with("BUILD") && name.ends_with(".gn") &&
+          name != "BUILDCONFIG.gn") {
+        std::string dir = file.substr(0, slash + 1);
+        if (!secondary_dir.empty() && dir.starts_with(secondary_dir))
+          dir = "//" + dir.substr(secondary_dir.size());
+        result.build_files[dir] += file_hash;
+        continue;
+      }
+    }
+    shared += path + '\n' + file_hash;
+  }
+
+  // Scripts run concurrently, so their results are recorded in any order.
+  std::vector<std::string> script_results =
+      g_scheduler->GetExecScriptResults();
+  std::sort(script_results.begin(), script_results.end());
+  for (const std::string& script_result : script_results)
+    shared += base::NumberToString(script_result.size()) + ' ' + script_result;
+
+  for (const auto& [name, value] :
+       build_settings->build_args().GetAllArguments()) {
+    shared += std::string(name) + '=' +
+              (value.has_override ? value.override_value : value.default_value)
+                  .ToString(true) +
+              '\n';
+  }
+
+  std::string hash = base::SHA1HashString(shared);
+  result.shared = base::HexEncode(hash.data(), hash.size());
+  return result;
+}
+
+void AddBuildFilesHash(const InputHashes& hashes,
+                       const SourceDir& dir,
+                       std::string* description) {
+  description->append(dir.value());
+  auto found = hashes.build_files.find(dir.value());
+  if (found != hashes.build_files.end())
+    description->append(found->second);
+  description->push_back('\n');
+}
+
+void AddConfigHashes(const InputHashes& hashes,
+                     const UniqueVector<LabelConfigPair>& configs,
+                     std::string* description) {
+  for (const LabelConfigPair& pair : configs) {
+    AddBuildFilesHash(hashes, pair.label.dir(), description);
+    AddConfigHashes(hashes, pair.ptr->configs(), description);
+  }
+}
+
+// Returns the fingerprint of the description of |target|, see InputHashes.
+// Fingerprints are memoized in |fingerprints|, as they include the ones of
+// the dependencies.
+const std::string& GetFingerprint(
+    const Target* target,
+    const InputHashes& hashes,
+    std::unordered_map<const Target*, std::string>* fingerprints) {
+  auto found = fingerprints->find(target);
+  if (found != fingerprints->end())
+    return found->second;
+
+  std::string description = target->label().GetUserVisibleName(true) + '\n';
+  AddBuildFilesHash(hashes, target->label().dir(), &description);
+  AddBuildFilesHash(hashes, target->toolchain()->label().dir(), &description);
+  AddConfigHashes(hashes, target->configs(), &description);
+  AddConfigHashes(hashes, target->public_configs(), &description);
+  AddConfigHashes(hashes, target->all_dependent_configs(), &description);
+  for (const auto& pair : target->GetDeps(Target::DEPS_ALL))
+    description += GetFingerprint(pair.ptr, hashes, fingerprints);
+
+  std::string hash = base::SHA1HashString(description);
+  return fingerprints
+      ->emplace(target, base::HexEncode(hash.data(), hash.size()))
+      .first->second;
+}
+
+// First line of the cache, followed by the options.
+const char kCacheHeader[] = "gn json project cache 2 ";
+
+// Returns the hash of the JSON file recorded in the cache.
+std::string HashJSON(const std::string& contents) {
+  std::string hash = base::SHA1HashString(contents);
+  return base::HexEncode(hash.data(), hash.size());
+}
+
 }  // namespace
 
+void JSONProjectWriter::DescriptionCache::Load(
+    const base::FilePath& cache_path,
+    const base::FilePath& json_path,
+    const std::string& options) {
+  std::string cache;
+  if (!base::ReadFileToString(cache_path, &cache))
+    return;
+
+  std::vector<std::string_view> lines = base::SplitStringPiece(
+      cache, "\n", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  if (lines.size() < 2 || lines[0] != kCacheHeader + options ||
+      !base::ReadFileToString(json_path, &json) || HashJSON(json) != lines[1]) {
+    json.clear();
+    return;
+  }
+
+  for (size_t i = 2; i < lines.size(); i++) {
+    std::vector<std::string_view> fields = base::SplitStringPiece(
+        lines[i], " ", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL);
+    size_t offset = 0;
+    size_t length = 0;
+    if (fields.size() < 4 || !base::StringToSizeT(fields[1], &offset) ||
+        !base::StringToSizeT(fields[2], &length) || offset > json.size() ||
+        length > json.size() - offset)
+      continue;
+    std::string_view label = lines[i].substr(
+        fields[0].size() + fields[1].size() + fields[2].size() + 3);
+    targets[std::string(label)] = {
+        std::string(fields[0]), std::string_view(json).substr(offset, length)};
+  }
+}
+
 bool JSONProjectWriter::RunAndWriteFiles(
     const BuildSettings* build_settings,
     const Builder& builder,
@@ -109,34 +301,62 @@ bool JSONProjectWriter::RunAndWriteFiles(
     return false;
   }
 
-  StringOutputBuffer json = GenerateJSON(build_settings, targets);
-  if (!json.ContentsEqual(output_path)) {
-    if (!json.WriteToFile(output_path, err)) {
-      return false;
-    }
+  bool changed = false;
+  if (!WriteJSONWithCache(build_settings, targets, output_path, &changed, err))
+    return false;
 
-    if (!exec_script.empty()) {
-      SourceFile script_file;
-      if (exec_script[0] != '/') {
-        // Relative path, assume the base is in build_dir.
-        script_file = build_settings->build_dir().ResolveRelativeFile(
-            Value(nullptr, exec_script), err);
-        if (script_file.is_null()) {
-          return false;
-        }
-      } else {
-        script_file = SourceFile(exec_script);
+  if (changed && !exec_script.empty()) {
+    SourceFile script_file;
+    if (exec_script[0] != '/') {
+      // Relative path, assume the base is in build_dir.
+      script_file = build_settings->build_dir().ResolveRelativeFile(
+          Value(nullptr, exec_script), err);
+      if (script_file.is_null()) {
+        return false;
       }
-      base::FilePath script_path = build_settings->GetFullPath(script_file);
-      return internal::InvokePython(build_settings, script_path,
-                                    exec_script_extra_args, output_path, quiet,
-                                    err);
+    } else {
+      script_file = SourceFile(exec_script);
     }
+    base::FilePath script_path = build_settings->GetFullPath(script_file);
+    return internal::InvokePython(build_settings, script_path,
+                                  exec_script_extra_args, output_path, quiet,
+                                  err);
   }
 
   return true;
 }
 
+bool JSONProjectWriter::WriteJSONWithCache(
+    const BuildSettings* build_settings,
+    std::vector<const Target*>& targets,
+    const base::FilePath& output_path,
+    bool* changed,
+    Err* err) {
+  // Target descriptions are cached next to the JSON file, so that only the
+  // targets affected by the changes to the build files are described again.
+  InputHashes hashes = HashInputFiles(build_settings);
+  DescriptionCache cache;
+  for (const Target* target : targets)
+    GetFingerprint(target, hashes, &cache.fingerprints);
+  std::string cache_options =
+      std::string(LAST_COMMIT_POSITION) + " " + hashes.shared;
+  base::FilePath cache_path =
+      UTF8ToFilePath(FilePathToUTF8(output_path) + ".cache");
+  cache.Load(cache_path, output_path, cache_options);
+
+  std::string cache_lines;
+  StringOutputBuffer json =
+      GenerateJSON(build_settings, targets, &cache, &cache_lines);
+  *changed = !json.ContentsEqual(output_path);
+  if (*changed && !json.WriteToFile(output_path, err))
+    return false;
+
+  StringOutputBuffer cache_contents;
+  cache_contents << kCacheHeader << cache_options << "\n"
+                 << HashJSON(json.str()) << "\n" << cache_lines;
+  return cache_contents.WriteToFileIfChanged(cache_path, err);
+}
+
 namespace {
 
 // NOTE: Intentional macro definition allows compile-time string concatenation.
@@ -244,42 +464,22 @@ class SimpleJSONWriter {
   }
 
   // Add a dictionary-valued key, whose value is already formatted as a valid
-  // JSON string. Useful to insert the output of base::JSONWriter::Write()
-  // into the target buffer.
-  void AddJSONDict(std::string_view key, std::string_view json) {
+  // JSON fragment for the current indentation, as returned by
+  // base::JSONWriter::WriteFragmentWithOptions() with a depth equal to
+  // the current indentation level. Returns the offset of |json| in the
+  // output.
+  size_t AddJSONFragment(std::string_view key, std::string_view json) {
     if (comma_.size())
       out_ << comma_;
     AddMargin() << Escape(key) << ": ";
-    if (json.empty()) {
-      out_ << "{ }";
-    } else {
-      DCHECK(json[0] == '{');
-      bool first_line = true;
-      do {
-        size_t line_end = json.find('\n');
-
-        // NOTE: Do not add margin if original input line is empty.
-        // This needs to deal with CR/LF which are part of |json| on Windows
-        // only, due to the way base::JSONWriter::Write() is implemented.
-        bool line_empty = (line_end == 0 || (line_end == 1 && json[0] == '\r'));
-        if (!first_line && !line_empty)
-          AddMargin();
-
-        if (line_end == std::string_view::npos) {
-          out_ << json;
-          comma_ = {};
-          return;
-        }
-        // Important: do not add the final newline.
-        out_ << json.substr(
-            0, (line_end == json.size() - 1) ? line_end : line_end + 1);
-        json.remove_prefix(line_end + 1);
-        first_line = false;
-      } while (!json.empty());
-    }
+    size_t offset = out_.size();
+    out_ << json;
     comma_ = "," LINE_ENDING;
+    return offset;
   }
 
+  size_t indentation() const { return indentation_; }
+
  private:
   // Return the JSON-escape version of |str|.
   static std::string Escape(std::string_view str) {
@@ -308,11 +508,40 @@ class SimpleJSONWriter {
   StringOutputBuffer& out_;
 };
 
+// Number of targets whose descriptions are rendered before being appended to
+// the output.
+constexpr size_t kTargetsPerWindow = 4096;
+
+// Renders the description of |target| listed in the "targets" dictionary, as
+// a fragment nested |depth| levels deep. |resolved| is shared by the targets
+// rendered by a range.
+void RenderTargetDescription(const Target* target,
+                             size_t depth,
+                             ResolvedTargetData* resolved,
+                             std::string* fragment) {
+  auto description = DescBuilder::DescriptionForTarget(
+      target, "", false, false, false, resolved);
+  // Outputs need to be asked for separately.
+  auto outputs = DescBuilder::DescriptionForTarget(
+      target, "source_outputs", false, false, false, resolved);
+  base::DictionaryValue* outputs_value = nullptr;
+  if (outputs->GetDictionary("source_outputs", &outputs_value) &&
+      !outputs_value->empty()) {
+    description->MergeDictionary(outputs.get());
+  }
+
+  base::JSONWriter::WriteFragmentWithOptions(
+      *description.get(), base::JSONWriter::OPTIONS_PRETTY_PRINT, depth,
+      fragment);
+}
+
 }  // namespace
 
 StringOutputBuffer JSONProjectWriter::GenerateJSON(
     const BuildSettings* build_settings,
-    std::vector<const Target*>& all_targets) {
+    std::vector<const Target*>& all_targets,
+    const DescriptionCache* cache,
+    std::string* cache_contents) {
   Label default_toolchain_label;
   if (!all_targets.empty())
     default_toolchain_label =
@@ -380,24 +609,54 @@ StringOutputBuffer JSONProjectWriter::GenerateJSON(
   std::map<Label, const Toolchain*> toolchains;
   json_writer.BeginDict("targets");
   {
-    for (const auto* target : sorted_targets) {
-      auto description =
-          DescBuilder::DescriptionForTarget(target, "", false, false, false);
-      // Outputs need to be asked for separately.
-      auto outputs = DescBuilder::DescriptionForTarget(target, "source_outputs",
-                                                       false, false, false);
-      base::DictionaryValue* outputs_value = nullptr;
-      if (outputs->GetDictionary("source_outputs", &outputs_value) &&
-          !outputs_value->empty()) {
-        description->MergeDictionary(outputs.get());
+    // Descriptions are rendered in parallel, in windows of targets to bound
+    // the memory used by the rendered fragments, and appended in label order.
+    // The descriptions found in the cache are used in place.
+    const size_t depth = json_writer.indentation();
+    std::vector<std::string> fragments;
+    std::vector<std::string_view> descriptions;
+    for (size_t window = 0; window < sorted_targets.size();
+         window += kTargetsPerWindow) {
+      size_t window_end =
+          std::min(sorted_targets.size(), window + kTargetsPerWindow);
+      fragments.resize(window_end - window);
+      descriptions.resize(window_end - window);
+      ParallelFor(
+          window_end - window,
+          [&sorted_targets, &target_labels, &fragments, &descriptions, cache,
+           window, depth](size_t, size_t begin, size_t end) {
+            ResolvedTargetData resolved;
+            for (size_t i = window + begin; i < window + end; i++) {
+              const Target* target = sorted_targets[i];
+              if (cache) {
+                auto found = cache->targets.find(target_labels.at(target));
+                if (found != cache->targets.end() &&
+                    found->second.fingerprint ==
+                        cache->fingerprints.at(target)) {
+                  descriptions[i - window] = found->second.description;
+                  continue;
+                }
+              }
+              RenderTargetDescription(target, depth, &resolved,
+                                      &fragments[i - window]);
+              descriptions[i - window] = fragments[i - window];
+            }
+          });
+
+      for (size_t i = window; i < window_end; i++) {
+        const Target* target = sorted_targets[i];
+        const std::string& label = target_labels[target];
+        std::string_view description = descriptions[i - window];
+        size_t offset = json_writer.AddJSONFragment(label, description);
+        if (cache_contents) {
+          *cache_contents += cache->fingerprints.at(target) + " " +
+                             base::NumberToString(offset) + " " +
+                             base::NumberToString(description.size()) + " " +
+                             label + "\n";
+        }
+        std::string().swap(fragments[i - window]);
+        toolchains[target->toolchain()->label()] = target->toolchain();
       }
-
-      std::string json_dict;
-      base::JSONWriter::WriteWithOptions(*description.get(),
-                                         base::JSONWriter::OPTIONS_PRETTY_PRINT,
-                                         &json_dict);
-      json_writer.AddJSONDict(target_labels[target], json_dict);
-      toolchains[target->toolchain()->label()] = target->toolchain();
     }
   }
   json_writer.EndDict();  // targets
@@ -448,10 +707,11 @@ StringOutputBuffer JSONProjectWriter::GenerateJSON(
         toolchain.SetKey(tool_kv.first, std::move(tool_info));
       }
       std::string json_dict;
-      base::JSONWriter::WriteWithOptions(
-          toolchain, base::JSONWriter::OPTIONS_PRETTY_PRINT, &json_dict);
-      json_writer.AddJSONDict(tool_chain_kv.first.GetUserVisibleName(false),
-                              json_dict);
+      base::JSONWriter::WriteFragmentWithOptions(
+          toolchain, base::JSONWriter::OPTIONS_PRETTY_PRINT,
+          json_writer.indentation(), &json_dict);
+      json_writer.AddJSONFragment(
+          tool_chain_kv.first.GetUserVisibleName(false), json_dict);
     }
   }
   json_writer.EndDict();  // toolchains
@@ -5,9 +5,17 @@
 #ifndef TOOLS_GN_JSON_WRITER_H_
 #define TOOLS_GN_JSON_WRITER_H_
 
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
 #include "gn/err.h"
 #include "gn/target.h"
 
+namespace base {
+class FilePath;
+}
+
 class Builder;
 class BuildSettings;
 class StringOutputBuffer;
@@ -27,10 +35,55 @@ class JSONProjectWriter {
   FRIEND_TEST_ALL_PREFIXES(JSONWriter, ActionWithResponseFile);
   FRIEND_TEST_ALL_PREFIXES(JSONWriter, ForEachWithResponseFile);
   FRIEND_TEST_ALL_PREFIXES(JSONWriter, RustTarget);
+  FRIEND_TEST_ALL_PREFIXES(JSONWriter, DescriptionCache);
+  FRIEND_TEST_ALL_PREFIXES(JSONWriter, WriteJSONWithCache);
+  FRIEND_TEST_ALL_PREFIXES(JSONWriter, SameTargetsAsSinglePassRendering);
+
+  // The target descriptions written by a previous run, and their
+  // fingerprint.
+  //
+  // The cache file starts with a header line identifying the options the
+  // descriptions depend on, followed by a line with the hex SHA1 of the JSON
+  // file as written. Then, there is one "<fingerprint> <offset> <length>
+  // <label>" line for each target, locating its description in that file.
+  struct DescriptionCache {
+    struct Entry {
+      std::string fingerprint;
+      std::string_view description;
+    };
+
+    // Loads the cache written with the same options, if the JSON file it
+    // refers to is unchanged since it was written.
+    void Load(const base::FilePath& cache_path,
+              const base::FilePath& json_path,
+              const std::string& options);
 
+    // Fingerprints of the targets to describe.
+    std::unordered_map<const Target*, std::string> fingerprints;
+
+    // Maps target labels to their description in |json|.
+    std::unordered_map<std::string, Entry> targets;
+
+    // The contents of the JSON file written by the previous run.
+    std::string json;
+  };
+
+  // Generates the JSON file. When |cache| is not null, the descriptions of
+  // the targets whose fingerprint didn't change are taken from it, and the
+  // cache lines for the new file are appended to |cache_contents|.
   static StringOutputBuffer GenerateJSON(
       const BuildSettings* build_settings,
-      std::vector<const Target*>& all_targets);
+      std::vector<const Target*>& all_targets,
+      const DescriptionCache* cache = nullptr,
+      std::string* cache_contents = nullptr);
+
+  // Writes the JSON file for |targets| to |output_path|, with the cache of
+  // their descriptions next to it. Sets |changed| when the file is written.
+  static bool WriteJSONWithCache(const BuildSettings* build_settings,
+                                 std::vector<const Target*>& targets,
+                                 const base::FilePath& output_path,
+                                 bool* changed,
+                                 Err* err);
 
   static std::string RenderJSON(const BuildSettings* build_settings,
                                 std::vector<const Target*>& all_targets);
@@ -3,7 +3,21 @@
 // found in the LICENSE file.
 
 #include "gn/json_project_writer.h"
+
+#include <memory>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_writer.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "gn/desc_builder.h"
+#include "gn/filesystem_utils.h"
+#include "gn/scheduler.h"
+#include "gn/string_output_buffer.h"
 #include "gn/substitution_list.h"
 #include "gn/target.h"
 #include "gn/test_with_scheduler.h"
@@ -13,6 +27,50 @@
 
 using JSONWriter = TestWithScheduler;
 
+namespace {
+
+// Renders the description of |target| in "targets" the way it was done before
+// the descriptions were rendered in parallel: the whole dictionary is written
+// and then indented line by line.
+std::string RenderTargetEntrySinglePass(const Target* target,
+                                        const std::string& label) {
+  auto description =
+      DescBuilder::DescriptionForTarget(target, "", false, false, false);
+  auto outputs = DescBuilder::DescriptionForTarget(target, "source_outputs",
+                                                   false, false, false);
+  base::DictionaryValue* outputs_value = nullptr;
+  if (outputs->GetDictionary("source_outputs", &outputs_value) &&
+      !outputs_value->empty()) {
+    description->MergeDictionary(outputs.get());
+  }
+  std::string json;
+  base::JSONWriter::WriteWithOptions(
+      *description.get(), base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+
+  const std::string margin(6, ' ');
+  std::string result = margin + "\"" + label + "\": ";
+  std::string_view rest = json;
+  bool first_line = true;
+  while (!rest.empty()) {
+    size_t line_end = rest.find('\n');
+    bool line_empty = line_end == 0 || (line_end == 1 && rest[0] == '\r');
+    if (!first_line && !line_empty)
+      result += margin;
+    if (line_end == std::string_view::npos) {
+      result += rest;
+      break;
+    }
+    // The final newline is not part of the entry.
+    result += rest.substr(0, line_end == rest.size() - 1 ? line_end
+                                                          : line_end + 1);
+    rest.remove_prefix(line_end + 1);
+    first_line = false;
+  }
+  return result;
+}
+
+}  // namespace
+
 TEST_F(JSONWriter, ActionWithResponseFile) {
   Err err;
   TestWithScope setup;
@@ -753,3 +811,173 @@ TEST_F(JSONWriter, ForEachWithResponseFile) {
 )_";
   EXPECT_EQ(expected_json, out) << out;
 }
+
+TEST_F(JSONWriter, DescriptionCache) {
+  Err err;
+  TestWithScope setup;
+
+  Target bar(setup.settings(), Label(SourceDir("//foo/"), "bar"));
+  bar.set_output_type(Target::GROUP);
+  bar.SetToolchain(setup.toolchain());
+  ASSERT_TRUE(bar.OnResolved(&err));
+  Target baz(setup.settings(), Label(SourceDir("//foo/"), "baz"));
+  baz.set_output_type(Target::GROUP);
+  baz.SetToolchain(setup.toolchain());
+  ASSERT_TRUE(baz.OnResolved(&err));
+
+  // The description of bar is still valid, the one of baz is not.
+  JSONProjectWriter::DescriptionCache cache;
+  cache.fingerprints[&bar] = "1";
+  cache.fingerprints[&baz] = "2";
+  cache.json = "\"cached\" \"stale\"";
+  std::string_view json = cache.json;
+  cache.targets["//foo:bar()"] = {"1", json.substr(0, 8)};
+  cache.targets["//foo:baz()"] = {"3", json.substr(9)};
+
+  std::vector<const Target*> targets = {&baz, &bar};
+  std::string cache_lines;
+  std::string out = JSONProjectWriter::GenerateJSON(
+                        setup.build_settings(), targets, &cache, &cache_lines)
+                        .str();
+  EXPECT_NE(std::string::npos, out.find("\"//foo:bar()\": \"cached\""))
+      << out;
+  EXPECT_EQ(std::string::npos, out.find("stale")) << out;
+
+  // The cache lines locate the new descriptions in the output.
+  std::vector<std::string> lines = base::SplitString(
+      cache_lines, "\n", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  ASSERT_EQ(2u, lines.size());
+  EXPECT_EQ("1 " + base::NumberToString(out.find("\"cached\"")) +
+                " 8 //foo:bar()",
+            lines[0]);
+  std::vector<std::string> fields = base::SplitString(
+      lines[1], " ", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL);
+  ASSERT_EQ(4u, fields.size());
+  EXPECT_EQ("2", fields[0]);
+  EXPECT_EQ("//foo:baz()", fields[3]);
+  size_t offset = 0;
+  size_t length = 0;
+  ASSERT_TRUE(base::StringToSizeT(fields[1], &offset));
+  ASSERT_TRUE(base::StringToSizeT(fields[2], &length));
+  std::string description = out.substr(offset, length);
+  EXPECT_EQ("\"//foo:baz()\": ", out.substr(offset - 15, 15));
+  EXPECT_TRUE(description.starts_with("{")) << description;
+  EXPECT_TRUE(description.ends_with("}")) << description;
+}
+
+TEST_F(JSONWriter, WriteJSONWithCache) {
+  Err err;
+  TestWithScope setup;
+
+  Target bar(setup.settings(), Label(SourceDir("//foo/"), "bar"));
+  bar.set_output_type(Target::GROUP);
+  bar.SetToolchain(setup.toolchain());
+  ASSERT_TRUE(bar.OnResolved(&err));
+  std::vector<const Target*> targets = {&bar};
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath output_path = temp_dir.GetPath().AppendASCII("project.json");
+  base::FilePath cache_path =
+      temp_dir.GetPath().AppendASCII("project.json.cache");
+  std::string expected =
+      JSONProjectWriter::RenderJSON(setup.build_settings(), targets);
+  auto run = [&]() {
+    bool changed = false;
+    EXPECT_TRUE(JSONProjectWriter::WriteJSONWithCache(
+        setup.build_settings(), targets, output_path, &changed, &err));
+    std::string contents;
+    EXPECT_TRUE(base::ReadFileToString(output_path, &contents));
+    return contents;
+  };
+  // Edits the description of bar in the JSON file, keeping its size.
+  auto edit = [&]() {
+    std::string contents;
+    EXPECT_TRUE(base::ReadFileToString(output_path, &contents));
+    size_t pos = contents.find("\"group\"");
+    EXPECT_NE(std::string::npos, pos);
+    contents.replace(pos, 7, "\"gr0up\"");
+    EXPECT_TRUE(WriteFile(output_path, contents, &err));
+    return contents;
+  };
+
+  EXPECT_EQ(expected, run());
+
+  // A description is not reused from a JSON file edited since it was written,
+  // even when the edit keeps its size.
+  edit();
+  EXPECT_EQ(expected, run());
+
+  // It is reused while the JSON file is the one recorded in the cache.
+  std::string edited = edit();
+  std::string cache;
+  ASSERT_TRUE(base::ReadFileToString(cache_path, &cache));
+  size_t hash_begin = cache.find('\n') + 1;
+  size_t hash_end = cache.find('\n', hash_begin);
+  std::string hash = base::SHA1HashString(edited);
+  cache.replace(hash_begin, hash_end - hash_begin,
+                base::HexEncode(hash.data(), hash.size()));
+  ASSERT_TRUE(WriteFile(cache_path, cache, &err));
+  EXPECT_EQ(edited, run());
+
+  // The results of exec_script() invalidate all the descriptions, as scripts
+  // may read more than the files they declare.
+  g_scheduler->AddExecScriptResult("script.py\nresult");
+  EXPECT_EQ(expected, run());
+}
+
+TEST_F(JSONWriter, SameTargetsAsSinglePassRendering) {
+  Err err;
+  TestWithScope setup;
+  InitCommandSwitchesForTesting();
+
+  // Enough targets to be rendered in several parallel ranges, in chains of
+  // dependencies and with source outputs.
+  constexpr size_t kTargetCount = 300;
+  constexpr size_t kChainLength = 10;
+  std::vector<std::unique_ptr<TestTarget>> targets;
+  for (size_t i = 0; i < kTargetCount; i++) {
+    std::string name = base::StringPrintf("t%03zu", i);
+    targets.push_back(std::make_unique<TestTarget>(
+        setup, "//foo:" + name,
+        i % 3 == 0 ? Target::SOURCE_SET : Target::GROUP));
+    if (i % 3 == 0) {
+      targets.back()->sources().push_back(SourceFile("//foo/" + name + ".cc"));
+      targets.back()->config_values().defines().push_back("NAME=" + name);
+    }
+  }
+  for (size_t i = kTargetCount; i-- > 0;) {
+    size_t chain_end = i - i % kChainLength + kChainLength;
+    if (i + 1 < chain_end) {
+      targets[i]->public_deps().push_back(
+          LabelTargetPair(targets[i + 1].get()));
+    }
+    if (i + 3 < chain_end) {
+      targets[i]->private_deps().push_back(
+          LabelTargetPair(targets[i + 3].get()));
+    }
+    ASSERT_TRUE(targets[i]->OnResolved(&err));
+  }
+
+  std::vector<const Target*> all_targets;
+  for (size_t i = kTargetCount; i-- > 0;)
+    all_targets.push_back(targets[i].get());
+  std::string out =
+      JSONProjectWriter::RenderJSON(setup.build_settings(), all_targets);
+
+  Label default_toolchain_label = setup.settings()->default_toolchain_label();
+  std::string expected = "   \"targets\": {\n";
+  for (size_t i = 0; i < kTargetCount; i++) {
+    if (i)
+      expected += ",\n";
+    expected += RenderTargetEntrySinglePass(
+        targets[i].get(),
+        targets[i]->label().GetUserVisibleName(default_toolchain_label));
+  }
+  expected += "\n   },\n";
+#if defined(OS_WIN)
+  base::ReplaceSubstringsAfterOffset(&out, 0, "\r\n", "\n");
+  base::ReplaceSubstringsAfterOffset(&expected, 0, "\r\n", "\n");
+#endif
+  EXPECT_NE(std::string::npos, out.find(expected));
+}
@@ -6,6 +6,8 @@
 
 #include <stddef.h>
 
+#include <utility>
+
 #include "base/strings/string_util.h"
 #include "gn/err.h"
 #include "gn/filesystem_utils.h"
@@ -273,3 +275,64 @@ std::string LabelPattern::Describe() const {
   }
   return result;
 }
+
+LabelPatternMatcher::LabelPatternMatcher(std::vector<LabelPattern> patterns)
+    : patterns_(std::move(patterns)) {
+  for (size_t i = 0; i < patterns_.size(); i++) {
+    const LabelPattern& pattern = patterns_[i];
+    if (pattern.type() == LabelPattern::RECURSIVE_DIRECTORY)
+      recursive_patterns_[pattern.dir().value()].push_back(i);
+    else
+      dir_patterns_[pattern.dir()].push_back(i);
+  }
+}
+
+LabelPatternMatcher::~LabelPatternMatcher() = default;
+
+template <typename Callback>
+void LabelPatternMatcher::ForEachMatch(const Label& label,
+                                       const Callback& callback) const {
+  auto check = [this, &label, &callback](const std::vector<size_t>& indices) {
+    for (size_t index : indices) {
+      if (patterns_[index].Matches(label) && !callback(index))
+        return false;
+    }
+    return true;
+  };
+
+  auto found = dir_patterns_.find(label.dir());
+  if (found != dir_patterns_.end() && !check(found->second))
+    return;
+
+  if (recursive_patterns_.empty())
+    return;
+
+  // Recursive patterns match the directories their directory is a prefix of.
+  // Directories end with a slash, so the candidates are the prefixes of the
+  // label directory ending with one, and the empty prefix.
+  const std::string& dir = label.dir().value();
+  for (size_t end = 0; end <= dir.size(); end++) {
+    if (end > 0 && dir[end - 1] != '/')
+      continue;
+    auto prefix = recursive_patterns_.find(std::string_view(dir.data(), end));
+    if (prefix != recursive_patterns_.end() && !check(prefix->second))
+      return;
+  }
+}
+
+void LabelPatternMatcher::GetMatches(const Label& label,
+                                     std::vector<size_t>* matches) const {
+  ForEachMatch(label, [matches](size_t index) {
+    matches->push_back(index);
+    return true;
+  });
+}
+
+bool LabelPatternMatcher::Matches(const Label& label) const {
+  bool matches = false;
+  ForEachMatch(label, [&matches](size_t) {
+    matches = true;
+    return false;
+  });
+  return matches;
+}
@@ -6,6 +6,8 @@
 #define TOOLS_GN_LABEL_PATTERN_H_
 
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "gn/label.h"
 #include "gn/source_dir.h"
@@ -81,4 +83,40 @@ class LabelPattern {
   std::string name_;
 };
 
+// Matches labels against many patterns at once. The patterns are indexed by
+// directory, so matching a label only checks the patterns of its directory
+// and of the directories containing it rather than every pattern.
+class LabelPatternMatcher {
+ public:
+  explicit LabelPatternMatcher(std::vector<LabelPattern> patterns);
+  ~LabelPatternMatcher();
+
+  const std::vector<LabelPattern>& patterns() const { return patterns_; }
+
+  // Appends to |matches| the indices in patterns() of the patterns matching
+  // the given label, in no particular order.
+  void GetMatches(const Label& label, std::vector<size_t>* matches) const;
+
+  // Returns true if any of the patterns match the label.
+  bool Matches(const Label& label) const;
+
+ private:
+  // Calls |callback| with the index of each pattern matching the label until
+  // it returns false.
+  template <typename Callback>
+  void ForEachMatch(const Label& label, const Callback& callback) const;
+
+  std::vector<LabelPattern> patterns_;
+
+  // Indices of the MATCH and DIRECTORY patterns, by directory.
+  std::unordered_map<SourceDir, std::vector<size_t>> dir_patterns_;
+
+  // Indices of the RECURSIVE_DIRECTORY patterns, by directory. The keys point
+  // to the directories of patterns_.
+  std::unordered_map<std::string_view, std::vector<size_t>> recursive_patterns_;
+
+  LabelPatternMatcher(const LabelPatternMatcher&) = delete;
+  LabelPatternMatcher& operator=(const LabelPatternMatcher&) = delete;
+};
+
 #endif  // TOOLS_GN_LABEL_PATTERN_H_
@@ -4,6 +4,7 @@
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <iterator>
 
 #include "gn/err.h"
@@ -100,3 +101,47 @@ TEST(LabelPattern, PatternParseAboveSourceRoot) {
   EXPECT_EQ(LabelPattern::RECURSIVE_DIRECTORY, result.type());
   EXPECT_EQ("/foo/", result.dir().value()) << result.dir().value();
 }
+
+// The matcher should agree with matching the patterns one by one.
+TEST(LabelPattern, MatchManyPatterns) {
+  SourceDir current_dir("//foo/");
+  const char* pattern_inputs[] = {
+      "//foo:bar", "//foo:*", "//foo/*",           "//fo/*",
+      "*",         "/abs/*",  "//foo/bar/*(//tc)", "//foo/bar:baz(//tc)",
+  };
+  std::vector<LabelPattern> patterns;
+  for (const char* input : pattern_inputs) {
+    Err err;
+    patterns.push_back(LabelPattern::GetPattern(
+        current_dir, std::string_view(), Value(nullptr, input), &err));
+    ASSERT_FALSE(err.has_error()) << input;
+  }
+  LabelPatternMatcher matcher(patterns);
+
+  Label tc(SourceDir("//tc/"), "tc");
+  Label other_tc(SourceDir("//other/"), "other");
+  Label labels[] = {
+      Label(SourceDir("//foo/"), "bar", tc.dir(), tc.name()),
+      Label(SourceDir("//foo/"), "baz", other_tc.dir(), other_tc.name()),
+      Label(SourceDir("//foo/bar/"), "baz", tc.dir(), tc.name()),
+      Label(SourceDir("//foo/bar/"), "baz", other_tc.dir(), other_tc.name()),
+      Label(SourceDir("//fo/"), "bar", tc.dir(), tc.name()),
+      Label(SourceDir("//fooo/"), "bar", tc.dir(), tc.name()),
+      Label(SourceDir("/abs/dir/"), "bar", tc.dir(), tc.name()),
+  };
+  for (const Label& label : labels) {
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < patterns.size(); i++) {
+      if (patterns[i].Matches(label))
+        expected.push_back(i);
+    }
+    std::vector<size_t> matches;
+    matcher.GetMatches(label, &matches);
+    std::sort(matches.begin(), matches.end());
+    EXPECT_EQ(expected, matches) << label.GetUserVisibleName(true);
+    EXPECT_TRUE(matcher.Matches(label));
+  }
+
+  LabelPatternMatcher empty({});
+  EXPECT_FALSE(empty.Matches(labels[0]));
+}
@@ -4,20 +4,213 @@
 
 #include "gn/metadata_walk.h"
 
-std::vector<Value> WalkMetadata(
+#include <unordered_map>
+#include <unordered_set>
+
+#include "gn/deps_iterator.h"
+#include "util/worker_pool.h"
+
+namespace {
+
+// Below this many targets to compute in a level of the walk, handing them
+// to worker threads costs more than it saves.
+constexpr size_t kMinParallelTargets = 256;
+
+}  // namespace
+
+class MetadataWalkCache::Walk {
+ public:
+  Walk(std::vector<std::string> keys_to_extract,
+       std::vector<std::string> keys_to_walk,
+       SourceDir rebase_dir)
+      : keys_to_extract_(std::move(keys_to_extract)),
+        keys_to_walk_(std::move(keys_to_walk)),
+        rebase_dir_(std::move(rebase_dir)) {}
+
+  // Computes the contributions of the targets reachable from |targets| that
+  // aren't cached yet, one level of the graph at a time. Large levels are
+  // computed in parallel. Only used outside of gen, where the walks
+  // themselves already run on the scheduler threads.
+  void Prefetch(std::vector<const Target*> targets);
+
+  bool GetMetadata(const Target* target,
+                   bool deps_only,
+                   std::vector<Value>* result,
+                   TargetSet* targets_walked,
+                   Err* err);
+
+ private:
+  // The result of Target::GetMetadataStep() for a target.
+  struct Contribution {
+    bool ok = true;
+    std::vector<Value> values;
+    std::vector<const Target*> next_targets;
+    Err err;
+  };
+
+  void Compute(const Target* target, bool deps_only, Contribution* out) const {
+    out->ok = target->GetMetadataStep(keys_to_extract_, keys_to_walk_,
+                                      rebase_dir_, deps_only, &out->values,
+                                      &out->next_targets, &out->err);
+  }
+
+  // Returns the cached contribution of |target|, computing it if needed.
+  const Contribution* GetContribution(const Target* target);
+
+  const std::vector<std::string> keys_to_extract_;
+  const std::vector<std::string> keys_to_walk_;
+  const SourceDir rebase_dir_;
+
+  // Contributions are never removed, so pointers to them stay valid without
+  // holding the lock.
+  std::mutex lock_;
+  std::unordered_map<const Target*, std::unique_ptr<Contribution>>
+      contributions_;
+};
+
+void MetadataWalkCache::Walk::Prefetch(std::vector<const Target*> targets) {
+  std::unordered_set<const Target*> seen;
+  std::vector<const Target*> missing;
+  while (!targets.empty()) {
+    missing.clear();
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      for (const Target* target : targets) {
+        if (!contributions_.count(target) && seen.insert(target).second)
+          missing.push_back(target);
+      }
+    }
+    std::vector<std::unique_ptr<Contribution>> computed(missing.size());
+    auto compute_range = [this, &missing, &computed](size_t, size_t begin,
+                                                     size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        computed[i] = std::make_unique<Contribution>();
+        Compute(missing[i], false, computed[i].get());
+      }
+    };
+    if (missing.size() < kMinParallelTargets)
+      compute_range(0, 0, missing.size());
+    else
+      ParallelFor(missing.size(), compute_range);
+
+    targets.clear();
+    std::lock_guard<std::mutex> lock(lock_);
+    for (size_t i = 0; i < missing.size(); i++) {
+      const std::vector<const Target*>& next = computed[i]->next_targets;
+      targets.insert(targets.end(), next.begin(), next.end());
+      contributions_.emplace(missing[i], std::move(computed[i]));
+    }
+  }
+}
+
+const MetadataWalkCache::Walk::Contribution*
+MetadataWalkCache::Walk::GetContribution(const Target* target) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = contributions_.find(target);
+    if (found != contributions_.end())
+      return found->second.get();
+  }
+
+  // Another thread may compute the same target concurrently, in which case
+  // the first result inserted wins. Both are identical.
+  auto computed = std::make_unique<Contribution>();
+  Compute(target, false, computed.get());
+  std::lock_guard<std::mutex> lock(lock_);
+  return contributions_.emplace(target, std::move(computed))
+      .first->second.get();
+}
+
+bool MetadataWalkCache::Walk::GetMetadata(const Target* target,
+                                          bool deps_only,
+                                          std::vector<Value>* result,
+                                          TargetSet* targets_walked,
+                                          Err* err) {
+  // The top-level target of a deps_only walk contributes none of its own
+  // values, so it isn't worth caching.
+  Contribution root;
+  const Contribution* contribution = &root;
+  if (deps_only)
+    Compute(target, true, &root);
+  else
+    contribution = GetContribution(target);
+
+  for (const Target* next : contribution->next_targets) {
+    // If we haven't walked this dep yet, go down into it.
+    if (targets_walked->add(next)) {
+      if (!GetMetadata(next, false, result, targets_walked, err))
+        return false;
+    }
+  }
+  if (contribution->err.has_error())
+    *err = contribution->err;
+  if (!contribution->ok)
+    return false;
+  result->insert(result->end(), contribution->values.begin(),
+                 contribution->values.end());
+  return true;
+}
+
+MetadataWalkCache::MetadataWalkCache() = default;
+
+MetadataWalkCache::~MetadataWalkCache() = default;
+
+bool MetadataWalkCache::GetMetadata(
+    const Target* target,
+    const std::vector<std::string>& keys_to_extract,
+    const std::vector<std::string>& keys_to_walk,
+    const SourceDir& rebase_dir,
+    bool deps_only,
+    std::vector<Value>* result,
+    TargetSet* targets_walked,
+    Err* err) {
+  // The contributions are computed as the walk reaches them, on the calling
+  // thread.
+  Walk* walk = GetWalk(keys_to_extract, keys_to_walk, rebase_dir);
+  return walk->GetMetadata(target, deps_only, result, targets_walked, err);
+}
+
+std::vector<Value> MetadataWalkCache::WalkMetadata(
     const UniqueVector<const Target*>& targets_to_walk,
     const std::vector<std::string>& keys_to_extract,
     const std::vector<std::string>& keys_to_walk,
     const SourceDir& rebase_dir,
     TargetSet* targets_walked,
     Err* err) {
+  Walk* walk = GetWalk(keys_to_extract, keys_to_walk, rebase_dir);
+  walk->Prefetch(std::vector<const Target*>(targets_to_walk.begin(),
+                                            targets_to_walk.end()));
+
   std::vector<Value> result;
   for (const auto* target : targets_to_walk) {
     if (targets_walked->add(target)) {
-      if (!target->GetMetadata(keys_to_extract, keys_to_walk, rebase_dir, false,
-                               &result, targets_walked, err))
+      if (!walk->GetMetadata(target, false, &result, targets_walked, err))
         return std::vector<Value>();
     }
   }
   return result;
 }
+
+MetadataWalkCache::Walk* MetadataWalkCache::GetWalk(
+    const std::vector<std::string>& keys_to_extract,
+    const std::vector<std::string>& keys_to_walk,
+    const SourceDir& rebase_dir) {
+  WalkKey key(keys_to_extract, keys_to_walk, rebase_dir);
+  std::lock_guard<std::mutex> lock(lock_);
+  std::unique_ptr<Walk>& walk = walks_[key];
+  if (!walk)
+    walk = std::make_unique<Walk>(keys_to_extract, keys_to_walk, rebase_dir);
+  return walk.get();
+}
+
+std::vector<Value> WalkMetadata(
+    const UniqueVector<const Target*>& targets_to_walk,
+    const std::vector<std::string>& keys_to_extract,
+    const std::vector<std::string>& keys_to_walk,
+    const SourceDir& rebase_dir,
+    TargetSet* targets_walked,
+    Err* err) {
+  MetadataWalkCache cache;
+  return cache.WalkMetadata(targets_to_walk, keys_to_extract, keys_to_walk,
+                            rebase_dir, targets_walked, err);
+}
@@ -5,11 +5,72 @@
 #ifndef TOOLS_GN_METADATAWALK_H_
 #define TOOLS_GN_METADATAWALK_H_
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
 #include "gn/build_settings.h"
 #include "gn/target.h"
 #include "gn/unique_vector.h"
 #include "gn/value.h"
 
+// Memoizes metadata walks. What each target contributes to a walk (its
+// rebased values and the deps to walk next) only depends on the target and
+// on the (keys to extract, keys to walk, rebase dir) triple, so it is
+// computed once per triple and shared by all the walks using it, such as
+// generated_file targets walking overlapping parts of the graph.
+//
+// The targets must stay alive and unmodified as long as the cache is used.
+// This class is threadsafe.
+class MetadataWalkCache {
+ public:
+  MetadataWalkCache();
+  ~MetadataWalkCache();
+
+  // Equivalent to Target::GetMetadata(), with the same ordering and
+  // deduplication of the results. Called from the scheduler threads during
+  // gen, so the contributions of the targets are computed on the calling
+  // thread as the walk reaches them.
+  bool GetMetadata(const Target* target,
+                   const std::vector<std::string>& keys_to_extract,
+                   const std::vector<std::string>& keys_to_walk,
+                   const SourceDir& rebase_dir,
+                   bool deps_only,
+                   std::vector<Value>* result,
+                   TargetSet* targets_walked,
+                   Err* err);
+
+  // Equivalent to WalkMetadata() below. The targets reachable from
+  // |targets_to_walk| are computed in parallel before walking when there are
+  // enough of them.
+  std::vector<Value> WalkMetadata(
+      const UniqueVector<const Target*>& targets_to_walk,
+      const std::vector<std::string>& keys_to_extract,
+      const std::vector<std::string>& keys_to_walk,
+      const SourceDir& rebase_dir,
+      TargetSet* targets_walked,
+      Err* err);
+
+ private:
+  class Walk;
+
+  using WalkKey =
+      std::tuple<std::vector<std::string>, std::vector<std::string>, SourceDir>;
+
+  Walk* GetWalk(const std::vector<std::string>& keys_to_extract,
+                const std::vector<std::string>& keys_to_walk,
+                const SourceDir& rebase_dir);
+
+  std::mutex lock_;
+  std::map<WalkKey, std::unique_ptr<Walk>> walks_;
+
+  MetadataWalkCache(const MetadataWalkCache&) = delete;
+  MetadataWalkCache& operator=(const MetadataWalkCache&) = delete;
+};
+
 // Function to collect metadata from resolved targets listed in targets_walked.
 // Intended to be called after all targets are resolved.
 //
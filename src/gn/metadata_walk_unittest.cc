@@ -4,6 +4,8 @@
 
 #include "gn/metadata_walk.h"
 
+#include <memory>
+
 #include "gn/metadata.h"
 #include "gn/target.h"
 #include "gn/test_with_scope.h"
@@ -209,3 +211,50 @@ TEST(MetadataWalkTest, CollectWithError) {
             "specified the appropriate toolchain.")
       << err.message();
 }
+
+TEST(MetadataWalkTest, CacheMatchesTargetWalk) {
+  TestWithScope setup;
+
+  // Enough deps for the cache to compute them in parallel, each also
+  // depending on a shared leaf.
+  TestTarget leaf(setup, "//foo:leaf", Target::SOURCE_SET);
+  Value leaf_values(nullptr, Value::LIST);
+  leaf_values.list_value().push_back(Value(nullptr, "leaf"));
+  leaf.metadata().contents().insert(
+      std::pair<std::string_view, Value>("a", leaf_values));
+
+  TestTarget root(setup, "//foo:root", Target::GROUP);
+  std::vector<std::unique_ptr<TestTarget>> deps;
+  for (int i = 0; i < 300; i++) {
+    deps.push_back(std::make_unique<TestTarget>(
+        setup, "//foo:dep" + std::to_string(i), Target::SOURCE_SET));
+    Value values(nullptr, Value::LIST);
+    values.list_value().push_back(Value(nullptr, static_cast<int64_t>(i)));
+    deps.back()->metadata().contents().insert(
+        std::pair<std::string_view, Value>("a", values));
+    deps.back()->public_deps().push_back(LabelTargetPair(&leaf));
+    root.public_deps().push_back(LabelTargetPair(deps.back().get()));
+  }
+
+  std::vector<std::string> data_keys;
+  data_keys.push_back("a");
+  std::vector<std::string> walk_keys;
+
+  Err err;
+  std::vector<Value> expected;
+  TargetSet expected_walked;
+  ASSERT_TRUE(root.GetMetadata(data_keys, walk_keys, SourceDir(), true,
+                               &expected, &expected_walked, &err));
+  ASSERT_EQ(301u, expected.size());
+
+  // The second walk is answered from the cache.
+  MetadataWalkCache cache;
+  for (int i = 0; i < 2; i++) {
+    std::vector<Value> result;
+    TargetSet walked;
+    EXPECT_TRUE(cache.GetMetadata(&root, data_keys, walk_keys, SourceDir(),
+                                  true, &result, &walked, &err));
+    EXPECT_EQ(expected, result);
+    EXPECT_EQ(expected_walked, walked);
+  }
+}
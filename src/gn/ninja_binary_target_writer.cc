@@ -209,12 +209,14 @@ void NinjaBinaryTargetWriter::AddSourceSetFiles(
     const Target* source_set,
     UniqueVector<OutputFile>* obj_files) const {
   std::vector<OutputFile> tool_outputs;  // Prevent allocation in loop.
+  CompiledSubstitutionList::Cache compiled_lists(source_set);
 
   // Compute object files for all sources. Only link the first output from
   // the tool if there are more than one.
   for (const auto& source : source_set->sources()) {
     const char* tool_name = Tool::kToolNone;
-    if (source_set->GetOutputFilesForSource(source, &tool_name, &tool_outputs))
+    if (source_set->GetOutputFilesForSource(source, &tool_name, &tool_outputs,
+                                            &compiled_lists))
       obj_files->push_back(tool_outputs[0]);
   }
 
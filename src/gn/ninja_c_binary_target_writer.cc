@@ -439,13 +439,15 @@ void NinjaCBinaryTargetWriter::WriteSources(
 
   std::vector<OutputFile> tool_outputs;  // Prevent reallocation in loop.
   std::vector<OutputFile> deps;
+  CompiledSubstitutionList::Cache compiled_lists(target_);
   for (const auto& source : target_->sources()) {
     DCHECK_NE(source.GetType(), SourceFile::SOURCE_SWIFT);
 
     // Clear the vector but maintain the max capacity to prevent reallocations.
     deps.resize(0);
     const char* tool_name = Tool::kToolNone;
-    if (!target_->GetOutputFilesForSource(source, &tool_name, &tool_outputs)) {
+    if (!target_->GetOutputFilesForSource(source, &tool_name, &tool_outputs,
+                                          &compiled_lists)) {
       if (source.IsDefType())
         other_files->push_back(source);
       continue;  // No output for this source.
@@ -4,6 +4,7 @@
 
 #include "gn/ninja_generated_file_target_writer.h"
 
+#include "gn/metadata_walk.h"
 #include "gn/output_conversion.h"
 #include "gn/output_file.h"
 #include "gn/scheduler.h"
@@ -77,9 +78,10 @@ void NinjaGeneratedFileTargetWriter::GenerateFile() {
     ScopedTrace metadata_walk_trace(TraceItem::TRACE_WALK_METADATA,
                                     target_->label());
     trace.SetToolchain(target_->settings()->toolchain_label());
-    if (!target_->GetMetadata(target_->data_keys(), target_->walk_keys(),
-                              target_->rebase(), /*deps_only = */ true,
-                              &contents.list_value(), &targets_walked, &err)) {
+    if (!g_scheduler->metadata_walk_cache()->GetMetadata(
+            target_, target_->data_keys(), target_->walk_keys(),
+            target_->rebase(), /*deps_only = */ true, &contents.list_value(),
+            &targets_walked, &err)) {
       g_scheduler->FailWithError(err);
       return;
     }
@@ -0,0 +1,472 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/ninja_logs.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <unordered_map>
+
+#include "base/files/file_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "gn/filesystem_utils.h"
+#include "util/atomic_write.h"
+#include "util/build_config.h"
+
+namespace {
+
+const char kLogFileName[] = ".ninja_log";
+const char kLogSignature[] = "# ninja log v";
+
+// The .ninja_log versions this code knows about. They all use the same
+// "start\tend\tmtime\toutput\tcommand_hash" line format, only the hash
+// function and timestamp sources differ, which doesn't matter here since
+// only the mtime field of the requested outputs is rewritten.
+constexpr int kMinLogVersion = 5;
+constexpr int kMaxLogVersion = 7;
+
+const char kDepsFileName[] = ".ninja_deps";
+const char kDepsSignature[] = "# ninjadeps\n";
+constexpr size_t kDepsSignatureSize = sizeof(kDepsSignature) - 1;
+constexpr int32_t kDepsVersion = 4;
+constexpr uint32_t kDepsRecordFlag = 0x80000000u;
+constexpr uint32_t kMaxDepsRecordSize = (1u << 19) - 1;
+
+struct LogEntry {
+  std::string_view start;
+  std::string_view end;
+  std::string_view mtime;
+  std::string_view output;
+  std::string_view hash;
+};
+
+struct BuildLog {
+  std::string contents;
+  std::string_view header;  // Includes the trailing newline.
+
+  // Only the last entry of each output is kept, like Ninja does when it
+  // loads the log.
+  std::vector<LogEntry> entries;
+};
+
+// Reads .ninja_log from |build_dir|. Sets |*exists| to false and returns true
+// if there is no log.
+bool LoadBuildLog(const base::FilePath& build_dir,
+                  BuildLog* log,
+                  bool* exists,
+                  Err* err) {
+  base::FilePath path = build_dir.AppendASCII(kLogFileName);
+  *exists = base::PathExists(path);
+  if (!*exists)
+    return true;
+  if (!base::ReadFileToString(path, &log->contents)) {
+    *err = Err(Location(), "Could not read " + FilePathToUTF8(path) + ".");
+    return false;
+  }
+
+  std::string_view contents(log->contents);
+  size_t header_end = contents.find('\n');
+  int version = 0;
+  if (header_end == std::string_view::npos ||
+      !contents.starts_with(kLogSignature) ||
+      !base::StringToInt(
+          contents.substr(sizeof(kLogSignature) - 1,
+                          header_end - (sizeof(kLogSignature) - 1)),
+          &version) ||
+      version < kMinLogVersion || version > kMaxLogVersion) {
+    *err = Err(Location(), "Unsupported .ninja_log format.",
+               "The header of " + FilePathToUTF8(path) +
+                   " is not one of the versions GN knows about.");
+    return false;
+  }
+  log->header = contents.substr(0, header_end + 1);
+
+  std::unordered_map<std::string_view, size_t> index_by_output;
+  size_t line_begin = header_end + 1;
+  while (line_begin < contents.size()) {
+    size_t line_end = contents.find('\n', line_begin);
+    if (line_end == std::string_view::npos)
+      break;  // Ninja also ignores an incomplete last line.
+    std::vector<std::string_view> fields =
+        base::SplitStringPiece(contents.substr(line_begin, line_end - line_begin),
+                               "\t", base::KEEP_WHITESPACE,
+                               base::SPLIT_WANT_ALL);
+    line_begin = line_end + 1;
+    if (fields.size() != 5)
+      continue;  // Malformed lines are skipped by Ninja too.
+
+    LogEntry entry{fields[0], fields[1], fields[2], fields[3], fields[4]};
+    auto inserted = index_by_output.emplace(entry.output, log->entries.size());
+    if (inserted.second)
+      log->entries.push_back(entry);
+    else
+      log->entries[inserted.first->second] = entry;
+  }
+  return true;
+}
+
+bool WriteBuildLog(const base::FilePath& build_dir,
+                   const BuildLog& log,
+                   const NinjaOutputSet* live_outputs,
+                   const std::unordered_map<std::string_view, int64_t>& mtimes,
+                   Err* err) {
+  std::string result(log.header);
+  for (const LogEntry& entry : log.entries) {
+    if (live_outputs && !live_outputs->count(std::string(entry.output)))
+      continue;
+    result.append(entry.start);
+    result.push_back('\t');
+    result.append(entry.end);
+    result.push_back('\t');
+    auto found = mtimes.find(entry.output);
+    if (found != mtimes.end())
+      result.append(base::Int64ToString(found->second));
+    else
+      result.append(entry.mtime);
+    result.push_back('\t');
+    result.append(entry.output);
+    result.push_back('\t');
+    result.append(entry.hash);
+    result.push_back('\n');
+  }
+
+  base::FilePath path = build_dir.AppendASCII(kLogFileName);
+  if (util::WriteFileAtomically(path, result.data(),
+                                static_cast<int>(result.size())) !=
+      static_cast<int>(result.size())) {
+    *err = Err(Location(), "Could not write " + FilePathToUTF8(path) + ".");
+    return false;
+  }
+  return true;
+}
+
+// Computes the mtime of |path| the same way Ninja's RealDiskInterface::Stat()
+// does, in nanoseconds. Missing files have an mtime of 0.
+bool GetNinjaMtime(const base::FilePath& path, int64_t* mtime, Err* err) {
+#if defined(OS_LINUX) || defined(OS_ANDROID) || defined(OS_FUCHSIA) || \
+    defined(OS_FREEBSD) || defined(OS_NETBSD) || defined(OS_OPENBSD) ||  \
+    defined(OS_MACOSX)
+  struct stat st;
+  if (stat(path.value().c_str(), &st) < 0) {
+    if (errno == ENOENT || errno == ENOTDIR) {
+      *mtime = 0;
+      return true;
+    }
+    *err = Err(Location(), "Could not stat " + FilePathToUTF8(path) + ".");
+    return false;
+  }
+  // Some users (Flatpak) set mtime to 0, Ninja treats this as present.
+  if (st.st_mtime == 0) {
+    *mtime = 1;
+    return true;
+  }
+#if defined(OS_MACOSX)
+  *mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000LL +
+           st.st_mtimespec.tv_nsec;
+#else
+  *mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL +
+           st.st_mtim.tv_nsec;
+#endif
+  return true;
+#else
+  // Ninja uses a different timestamp representation here, let the ninja
+  // tool handle it.
+  *err = Err(Location(), "Restat is not supported in-process on this platform.");
+  return false;
+#endif
+}
+
+uint32_t ReadUint32(const char* data) {
+  uint32_t result;
+  memcpy(&result, data, sizeof(result));
+  return result;
+}
+
+void AppendUint32(std::string* out, uint32_t value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+struct DepsLog {
+  std::string contents;
+
+  // Node paths, indexed by id.
+  std::vector<std::string_view> paths;
+
+  // For each node id, the offset in |contents| of the payload of its last
+  // deps record, or 0 if it has none.
+  std::vector<size_t> deps_offsets;
+  std::vector<uint32_t> deps_sizes;
+};
+
+// Reads .ninja_deps from |build_dir|. Sets |*exists| to false and returns
+// true if there is no deps log.
+bool LoadDepsLog(const base::FilePath& build_dir,
+                 DepsLog* log,
+                 bool* exists,
+                 Err* err) {
+  base::FilePath path = build_dir.AppendASCII(kDepsFileName);
+  *exists = base::PathExists(path);
+  if (!*exists)
+    return true;
+  if (!base::ReadFileToString(path, &log->contents)) {
+    *err = Err(Location(), "Could not read " + FilePathToUTF8(path) + ".");
+    return false;
+  }
+
+  const std::string& contents = log->contents;
+  if (contents.size() < kDepsSignatureSize + sizeof(int32_t) ||
+      contents.compare(0, kDepsSignatureSize, kDepsSignature) != 0 ||
+      static_cast<int32_t>(ReadUint32(&contents[kDepsSignatureSize])) !=
+          kDepsVersion) {
+    *err = Err(Location(), "Unsupported .ninja_deps format.",
+               "The header of " + FilePathToUTF8(path) +
+                   " is not the version GN knows about.");
+    return false;
+  }
+
+  // Like Ninja, stop at the first incomplete or invalid record. Everything
+  // after it is dropped.
+  size_t offset = kDepsSignatureSize + sizeof(int32_t);
+  while (offset + sizeof(uint32_t) <= contents.size()) {
+    uint32_t size = ReadUint32(&contents[offset]);
+    bool is_deps = (size & kDepsRecordFlag) != 0;
+    size &= ~kDepsRecordFlag;
+    size_t payload = offset + sizeof(uint32_t);
+    if (size > kMaxDepsRecordSize || size < sizeof(uint32_t) ||
+        payload + size > contents.size())
+      break;
+
+    if (is_deps) {
+      if (size % 4 != 0 || size < 3 * sizeof(uint32_t))
+        break;
+      int32_t out_id = static_cast<int32_t>(ReadUint32(&contents[payload]));
+      if (out_id < 0 || static_cast<size_t>(out_id) >= log->paths.size())
+        break;
+      bool valid = true;
+      for (size_t i = 3 * sizeof(uint32_t); i < size; i += sizeof(uint32_t)) {
+        int32_t id = static_cast<int32_t>(ReadUint32(&contents[payload + i]));
+        if (id < 0 || static_cast<size_t>(id) >= log->paths.size()) {
+          valid = false;
+          break;
+        }
+      }
+      if (!valid)
+        break;
+      log->deps_offsets[out_id] = payload;
+      log->deps_sizes[out_id] = size;
+    } else {
+      uint32_t checksum =
+          ReadUint32(&contents[payload + size - sizeof(uint32_t)]);
+      if (~checksum != log->paths.size())
+        break;
+      size_t path_size = size - sizeof(uint32_t);
+      while (path_size > 0 && contents[payload + path_size - 1] == '\0')
+        path_size--;
+      log->paths.emplace_back(&contents[payload], path_size);
+      log->deps_offsets.push_back(0);
+      log->deps_sizes.push_back(0);
+    }
+    offset = payload + size;
+  }
+  return true;
+}
+
+// Writes a compacted .ninja_deps containing only the deps records of the
+// live outputs, the same way "ninja -t recompact" does.
+bool WriteDepsLog(const base::FilePath& build_dir,
+                  const DepsLog& log,
+                  const NinjaOutputSet& live_outputs,
+                  Err* err) {
+  std::string result(kDepsSignature, kDepsSignatureSize);
+  AppendUint32(&result, static_cast<uint32_t>(kDepsVersion));
+
+  std::vector<int32_t> new_ids(log.paths.size(), -1);
+  int32_t next_id = 0;
+  auto record_id = [&](int32_t old_id) {
+    if (new_ids[old_id] >= 0)
+      return;
+    std::string_view node_path = log.paths[old_id];
+    uint32_t padding = (4 - node_path.size() % 4) % 4;
+    AppendUint32(&result, static_cast<uint32_t>(node_path.size()) + padding +
+                              sizeof(uint32_t));
+    result.append(node_path);
+    result.append(padding, '\0');
+    new_ids[old_id] = next_id++;
+    AppendUint32(&result, ~static_cast<uint32_t>(new_ids[old_id]));
+  };
+
+  for (size_t old_id = 0; old_id < log.paths.size(); old_id++) {
+    if (!log.deps_offsets[old_id] ||
+        !live_outputs.count(std::string(log.paths[old_id])))
+      continue;
+
+    const char* payload = &log.contents[log.deps_offsets[old_id]];
+    uint32_t size = log.deps_sizes[old_id];
+    record_id(static_cast<int32_t>(old_id));
+    for (uint32_t i = 3 * sizeof(uint32_t); i < size; i += sizeof(uint32_t))
+      record_id(static_cast<int32_t>(ReadUint32(payload + i)));
+
+    AppendUint32(&result, size | kDepsRecordFlag);
+    AppendUint32(&result, static_cast<uint32_t>(new_ids[old_id]));
+    // The mtime is stored as two 32-bit halves.
+    result.append(payload + sizeof(uint32_t), 2 * sizeof(uint32_t));
+    for (uint32_t i = 3 * sizeof(uint32_t); i < size; i += sizeof(uint32_t)) {
+      AppendUint32(&result, static_cast<uint32_t>(
+                                new_ids[ReadUint32(payload + i)]));
+    }
+  }
+
+  base::FilePath path = build_dir.AppendASCII(kDepsFileName);
+  if (util::WriteFileAtomically(path, result.data(),
+                                static_cast<int>(result.size())) !=
+      static_cast<int>(result.size())) {
+    *err = Err(Location(), "Could not write " + FilePathToUTF8(path) + ".");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+std::string CanonicalizeNinjaPath(std::string_view path) {
+  std::string input(path);
+#if defined(OS_WIN)
+  for (char& c : input) {
+    if (c == '\\')
+      c = '/';
+  }
+#endif
+  bool absolute = !input.empty() && input[0] == '/';
+
+  std::vector<std::string_view> components;
+  for (std::string_view component : base::SplitStringPiece(
+           input, "/", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    if (component == ".")
+      continue;
+    if (component == ".." && !components.empty() &&
+        components.back() != "..") {
+      components.pop_back();
+      continue;
+    }
+    components.push_back(component);
+  }
+
+  std::string result;
+  if (absolute)
+    result.push_back('/');
+  for (size_t i = 0; i < components.size(); i++) {
+    if (i > 0)
+      result.push_back('/');
+    result.append(components[i]);
+  }
+  return result;
+}
+
+void AppendNinjaBuildNodes(std::string_view ninja,
+                           std::vector<std::string>* nodes) {
+  constexpr std::string_view kBuild = "build ";
+  size_t i = 0;
+  while (i < ninja.size()) {
+    bool is_build = ninja.substr(i, kBuild.size()) == kBuild;
+    if (is_build)
+      i += kBuild.size();
+
+    // Splits the line into paths, decoding the "$" escapes. The first word
+    // after the unescaped ':' is the rule name, and the "|", "||" and "|@"
+    // words separate the kinds of inputs.
+    std::string word;
+    bool after_colon = false;
+    bool rule_seen = false;
+    auto end_word = [&]() {
+      if (word.empty())
+        return;
+      if (is_build) {
+        if (after_colon && !rule_seen)
+          rule_seen = true;
+        else if (word != "|" && word != "||" && word != "|@")
+          nodes->push_back(CanonicalizeNinjaPath(word));
+      }
+      word.clear();
+    };
+    for (; i < ninja.size() && ninja[i] != '\n'; i++) {
+      char c = ninja[i];
+      if (c == '$' && i + 1 < ninja.size()) {
+        c = ninja[++i];
+        if (c == '\n') {
+          // Line continuation, the leading spaces of the next line are
+          // skipped by the ' ' case below.
+          end_word();
+        } else {
+          word.push_back(c);
+        }
+      } else if (c == ' ') {
+        end_word();
+      } else if (c == ':' && !after_colon) {
+        end_word();
+        after_colon = true;
+      } else {
+        word.push_back(c);
+      }
+    }
+    end_word();
+    i++;
+  }
+}
+
+bool RestatNinjaLog(const base::FilePath& build_dir,
+                    const std::vector<std::string>& files_to_restat,
+                    Err* err) {
+  BuildLog log;
+  bool exists = false;
+  if (!LoadBuildLog(build_dir, &log, &exists, err))
+    return false;
+  if (!exists)
+    return true;
+
+  std::unordered_map<std::string_view, int64_t> mtimes;
+  for (const std::string& file : files_to_restat) {
+    int64_t mtime = 0;
+    if (!GetNinjaMtime(build_dir.Append(UTF8ToFilePath(file)), &mtime, err))
+      return false;
+    mtimes[file] = mtime;
+  }
+  return WriteBuildLog(build_dir, log, nullptr, mtimes, err);
+}
+
+bool CleanDeadNinjaOutputs(const base::FilePath& build_dir,
+                           const NinjaOutputSet& live_outputs,
+                           Err* err) {
+  // Load and validate both logs before touching anything.
+  BuildLog log;
+  bool log_exists = false;
+  if (!LoadBuildLog(build_dir, &log, &log_exists, err))
+    return false;
+  DepsLog deps;
+  bool deps_exists = false;
+  if (!LoadDepsLog(build_dir, &deps, &deps_exists, err))
+    return false;
+
+  if (log_exists) {
+    for (const LogEntry& entry : log.entries) {
+      if (live_outputs.count(std::string(entry.output)))
+        continue;
+      base::FilePath dead = build_dir.Append(UTF8ToFilePath(entry.output));
+      if (base::PathExists(dead) && !base::DeleteFile(dead, false)) {
+        *err = Err(Location(), "Could not remove stale output " +
+                                   FilePathToUTF8(dead) + ".");
+        return false;
+      }
+    }
+    if (!WriteBuildLog(build_dir, log, &live_outputs, {}, err))
+      return false;
+  }
+
+  if (deps_exists)
+    return WriteDepsLog(build_dir, deps, live_outputs, err);
+  return true;
+}
@@ -0,0 +1,61 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_NINJA_LOGS_H_
+#define TOOLS_GN_NINJA_LOGS_H_
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "gn/err.h"
+
+// In-process maintenance of the .ninja_log and .ninja_deps files that Ninja
+// keeps in the build directory.
+//
+// These implement what "gn gen" needs from the ninja "restat", "cleandead"
+// and "recompact" tools (see ninja_tools.h) without spawning Ninja, which
+// would have to re-parse the whole generated build graph for each tool.
+//
+// Only the log format versions known to this code are handled. When a
+// function sees something it does not understand (unknown version, corrupted
+// header, unsupported platform), it returns false and sets |err| before
+// modifying anything, so the caller can fall back to the Ninja tools.
+
+// A set of canonical ninja output paths, relative to the build directory.
+using NinjaOutputSet = std::unordered_set<std::string>;
+
+// Returns |path| canonicalized the way Ninja does it for the paths of its
+// graph nodes: "." components are removed and ".." components are folded
+// into the preceding directory when there is one. On Windows, backslashes
+// are converted to forward slashes.
+std::string CanonicalizeNinjaPath(std::string_view path);
+
+// Appends to |nodes| the canonical paths of the outputs and inputs of the
+// "build" statements in |ninja|, the contents of a generated Ninja file.
+// These are the paths that "ninja -t cleandead" considers live. Variable
+// references are not expanded, GN doesn't write any in paths.
+void AppendNinjaBuildNodes(std::string_view ninja,
+                           std::vector<std::string>* nodes);
+
+// Equivalent of "ninja -t restat <files_to_restat>": updates the mtime
+// recorded in .ninja_log for the given files, which are relative to
+// |build_dir|. Does nothing if there is no .ninja_log yet.
+bool RestatNinjaLog(const base::FilePath& build_dir,
+                    const std::vector<std::string>& files_to_restat,
+                    Err* err);
+
+// Equivalent of "ninja -t cleandead" followed by "ninja -t recompact":
+// deletes the files recorded in .ninja_log which are not in |live_outputs|,
+// then rewrites .ninja_log and .ninja_deps without their entries. Like for
+// Ninja, |live_outputs| should contain both the outputs and the inputs of
+// all the build statements (see AppendNinjaBuildNodes()). The paths in
+// |live_outputs| must be canonical (see CanonicalizeNinjaPath()).
+bool CleanDeadNinjaOutputs(const base::FilePath& build_dir,
+                           const NinjaOutputSet& live_outputs,
+                           Err* err);
+
+#endif  // TOOLS_GN_NINJA_LOGS_H_
@@ -0,0 +1,199 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/ninja_logs.h"
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_split.h"
+#include "util/build_config.h"
+#include "util/test/test.h"
+
+namespace {
+
+void AppendUint32(std::string* out, uint32_t value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Appends a .ninja_deps path record for |path| with the given |id|.
+void AppendPathRecord(std::string* out, const std::string& path, uint32_t id) {
+  uint32_t padding = (4 - path.size() % 4) % 4;
+  AppendUint32(out, static_cast<uint32_t>(path.size()) + padding + 4);
+  out->append(path);
+  out->append(padding, '\0');
+  AppendUint32(out, ~id);
+}
+
+// Appends a .ninja_deps deps record.
+void AppendDepsRecord(std::string* out,
+                      uint32_t out_id,
+                      uint32_t mtime,
+                      const std::vector<uint32_t>& inputs) {
+  AppendUint32(out, (4 * (3 + static_cast<uint32_t>(inputs.size()))) |
+                        0x80000000u);
+  AppendUint32(out, out_id);
+  AppendUint32(out, mtime);
+  AppendUint32(out, 0);
+  for (uint32_t input : inputs)
+    AppendUint32(out, input);
+}
+
+std::string DepsHeader() {
+  std::string result("# ninjadeps\n");
+  AppendUint32(&result, 4);
+  return result;
+}
+
+bool WriteString(const base::FilePath& path, const std::string& data) {
+  return base::WriteFile(path, data.data(), static_cast<int>(data.size())) ==
+         static_cast<int>(data.size());
+}
+
+}  // namespace
+
+TEST(NinjaLogs, CanonicalizeNinjaPath) {
+  EXPECT_EQ("foo", CanonicalizeNinjaPath("./foo"));
+  EXPECT_EQ("obj/foo.o", CanonicalizeNinjaPath("obj//foo.o"));
+  EXPECT_EQ("a/c", CanonicalizeNinjaPath("a/./b/../c"));
+  EXPECT_EQ("../../src/x.cc", CanonicalizeNinjaPath("../../src/x.cc"));
+  EXPECT_EQ("/abs/path", CanonicalizeNinjaPath("/abs/./path"));
+}
+
+TEST(NinjaLogs, AppendNinjaBuildNodes) {
+  std::vector<std::string> nodes;
+  AppendNinjaBuildNodes(
+      "rule cxx\n"
+      "  command = c++ $in -o $out\n"
+      "build obj/a.o: cxx ../../a.cc | gen/./a.h || obj/b.stamp\n"
+      "  source_file_part = a.cc\n"
+      "build out$ file.txt out$:x: copy ../../in$$put.txt |@ obj/v.stamp\n"
+      "build obj/c.stamp: stamp $\n"
+      "    obj/a.o\n"
+      "subninja obj/d.ninja\n",
+      &nodes);
+  std::vector<std::string> expected = {
+      "obj/a.o",       "../../a.cc",     "gen/a.h",     "obj/b.stamp",
+      "out file.txt",  "out:x",          "../../in$put.txt",
+      "obj/v.stamp",   "obj/c.stamp",    "obj/a.o"};
+  EXPECT_EQ(expected, nodes);
+}
+
+TEST(NinjaLogs, UnsupportedVersion) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath log_path = temp_dir.GetPath().AppendASCII(".ninja_log");
+  const std::string log = "# ninja log v4\n1\t2\t3\tfoo.o\tabc\n";
+  ASSERT_TRUE(WriteString(log_path, log));
+
+  Err err;
+  EXPECT_FALSE(RestatNinjaLog(temp_dir.GetPath(), {"foo.o"}, &err));
+  EXPECT_TRUE(err.has_error());
+
+  err = Err();
+  EXPECT_FALSE(CleanDeadNinjaOutputs(temp_dir.GetPath(), {}, &err));
+  EXPECT_TRUE(err.has_error());
+
+  // Nothing must have been modified.
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(log_path, &contents));
+  EXPECT_EQ(log, contents);
+}
+
+TEST(NinjaLogs, NoLogs) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  Err err;
+  EXPECT_TRUE(RestatNinjaLog(temp_dir.GetPath(), {"build.ninja"}, &err));
+  EXPECT_TRUE(CleanDeadNinjaOutputs(temp_dir.GetPath(), {}, &err));
+  EXPECT_FALSE(err.has_error());
+  EXPECT_FALSE(
+      base::PathExists(temp_dir.GetPath().AppendASCII(".ninja_log")));
+}
+
+#if defined(OS_LINUX) || defined(OS_MACOSX)
+TEST(NinjaLogs, Restat) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath log_path = temp_dir.GetPath().AppendASCII(".ninja_log");
+  ASSERT_TRUE(WriteString(log_path,
+                          "# ninja log v5\n"
+                          "1\t2\t3\tbuild.ninja\taaa\n"
+                          "4\t5\t6\tfoo.o\tbbb\n"
+                          "7\t8\t9\tbuild.ninja\tccc\n"
+                          "10\t11\t12\tmissing\tddd\n"));
+  ASSERT_TRUE(WriteString(temp_dir.GetPath().AppendASCII("build.ninja"), ""));
+
+  Err err;
+  ASSERT_TRUE(RestatNinjaLog(temp_dir.GetPath(), {"build.ninja", "missing"},
+                             &err));
+
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(log_path, &contents));
+  std::vector<std::string> lines = base::SplitString(
+      contents, "\n", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  ASSERT_EQ(4u, lines.size());
+  EXPECT_EQ("# ninja log v5", lines[0]);
+
+  // Only the last build.ninja entry is kept, with an updated mtime.
+  std::vector<std::string> fields = base::SplitString(
+      lines[1], "\t", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL);
+  ASSERT_EQ(5u, fields.size());
+  EXPECT_EQ("7", fields[0]);
+  EXPECT_NE("9", fields[2]);
+  EXPECT_NE("0", fields[2]);
+  EXPECT_EQ("build.ninja", fields[3]);
+  EXPECT_EQ("ccc", fields[4]);
+
+  EXPECT_EQ("4\t5\t6\tfoo.o\tbbb", lines[2]);
+  EXPECT_EQ("10\t11\t0\tmissing\tddd", lines[3]);
+}
+#endif  // defined(OS_LINUX) || defined(OS_MACOSX)
+
+TEST(NinjaLogs, CleanDead) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath& build_dir = temp_dir.GetPath();
+
+  ASSERT_TRUE(WriteString(build_dir.AppendASCII(".ninja_log"),
+                          "# ninja log v5\n"
+                          "1\t2\t3\tlive.o\taaa\n"
+                          "4\t5\t6\tdead.o\tbbb\n"));
+  ASSERT_TRUE(WriteString(build_dir.AppendASCII("live.o"), "live"));
+  ASSERT_TRUE(WriteString(build_dir.AppendASCII("dead.o"), "dead"));
+
+  std::string deps = DepsHeader();
+  AppendPathRecord(&deps, "dead.o", 0);
+  AppendPathRecord(&deps, "../../dead.h", 1);
+  AppendDepsRecord(&deps, 0, 42, {1});
+  AppendPathRecord(&deps, "live.o", 2);
+  AppendPathRecord(&deps, "../../live.h", 3);
+  AppendDepsRecord(&deps, 2, 43, {3, 1});
+  ASSERT_TRUE(WriteString(build_dir.AppendASCII(".ninja_deps"), deps));
+
+  Err err;
+  ASSERT_TRUE(CleanDeadNinjaOutputs(build_dir, {"live.o"}, &err));
+
+  EXPECT_TRUE(base::PathExists(build_dir.AppendASCII("live.o")));
+  EXPECT_FALSE(base::PathExists(build_dir.AppendASCII("dead.o")));
+
+  std::string contents;
+  ASSERT_TRUE(
+      base::ReadFileToString(build_dir.AppendASCII(".ninja_log"), &contents));
+  EXPECT_EQ("# ninja log v5\n1\t2\t3\tlive.o\taaa\n", contents);
+
+  // Ids are reassigned in order of first use.
+  std::string expected_deps = DepsHeader();
+  AppendPathRecord(&expected_deps, "live.o", 0);
+  AppendPathRecord(&expected_deps, "../../live.h", 1);
+  AppendPathRecord(&expected_deps, "../../dead.h", 2);
+  AppendDepsRecord(&expected_deps, 0, 43, {1, 2});
+  ASSERT_TRUE(
+      base::ReadFileToString(build_dir.AppendASCII(".ninja_deps"), &contents));
+  EXPECT_EQ(expected_deps, contents);
+}
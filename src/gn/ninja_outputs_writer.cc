@@ -5,115 +5,117 @@
 #include "gn/ninja_outputs_writer.h"
 
 #include <algorithm>
-#include <memory>
+#include <fstream>
 
 #include "base/command_line.h"
 #include "base/files/file_path.h"
+#include "base/files/file_util.h"
 #include "base/json/string_escape.h"
 #include "gn/builder.h"
 #include "gn/commands.h"
+#include "gn/file_writer.h"
 #include "gn/filesystem_utils.h"
 #include "gn/invoke_python.h"
 #include "gn/settings.h"
-#include "gn/string_output_buffer.h"
-
-// NOTE: Intentional macro definition allows compile-time string concatenation.
-// (see usage below).
-#if defined(OS_WINDOWS)
-#define LINE_ENDING "\r\n"
-#else
-#define LINE_ENDING "\n"
-#endif
 
 namespace {
 
-using MapType = NinjaOutputsWriter::MapType;
-
-// Sort the targets according to their human visible labels first.
-struct TargetLabelPair {
-  TargetLabelPair(const Target* target, const Label& default_toolchain_label)
-      : target(target),
-        label(std::make_unique<std::string>(
-            target->label().GetUserVisibleName(default_toolchain_label))) {}
+using EntryList = NinjaOutputsWriter::EntryList;
 
-  const Target* target;
-  std::unique_ptr<std::string> label;
+// Calls |callback| with the successive pieces of the JSON object made of the
+// sorted |entries|, so that the file can be compared and written without
+// assembling it in memory. Stops and returns false as soon as |callback|
+// returns false.
+template <typename Callback>
+bool ForEachPiece(const EntryList& entries, Callback callback) {
+  if (!callback("{"))
+    return false;
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (i > 0 && !callback(","))
+      return false;
+    if (!callback(entries[i].json))
+      return false;
+  }
+  return callback("\n}");
+}
 
-  bool operator<(const TargetLabelPair& other) const {
-    return *label < *other.label;
+bool ContentsEqual(const base::FilePath& file_path, const EntryList& entries) {
+  // Compare the sizes first, which is enough to detect most changes.
+  size_t data_size = 0;
+  ForEachPiece(entries, [&data_size](std::string_view piece) {
+    data_size += piece.size();
+    return true;
+  });
+  int64_t file_size;
+  if (!base::GetFileSize(file_path, &file_size) ||
+      static_cast<size_t>(file_size) != data_size) {
+    return false;
   }
 
-  using List = std::vector<TargetLabelPair>;
+  std::ifstream file(file_path.As8Bit().c_str(), std::ios::binary);
+  if (!file.is_open())
+    return false;
 
-  // Create list of TargetLabelPairs sorted by their target labels.
-  static List CreateSortedList(const MapType& outputs_map,
-                               const Label& default_toolchain_label) {
-    List result;
-    result.reserve(outputs_map.size());
+  std::string file_piece;
+  return ForEachPiece(entries, [&file, &file_piece](std::string_view piece) {
+    file_piece.resize(piece.size());
+    file.read(file_piece.data(), piece.size());
+    return file.good() && file_piece == piece;
+  });
+}
 
-    for (const auto& output_pair : outputs_map)
-      result.emplace_back(output_pair.first, default_toolchain_label);
+bool WriteToFile(const base::FilePath& file_path,
+                 const EntryList& entries,
+                 Err* err) {
+  if (!base::CreateDirectory(file_path.DirName())) {
+    *err = Err(Location(), "Unable to create directory.",
+               "I was using \"" + FilePathToUTF8(file_path.DirName()) + "\".");
+    return false;
+  }
 
-    std::sort(result.begin(), result.end());
-    return result;
+  FileWriter writer;
+  if (writer.Create(file_path)) {
+    ForEachPiece(entries, [&writer](std::string_view piece) {
+      return writer.Write(piece);
+    });
+  }
+  if (!writer.Close()) {
+    *err = Err(Location(), "Unable to write file.",
+               "I was writing \"" + FilePathToUTF8(file_path) + "\".");
+    return false;
   }
-};
+  return true;
+}
 
 }  // namespace
 
 // static
-StringOutputBuffer NinjaOutputsWriter::GenerateJSON(
-    const MapType& outputs_map) {
-  Label default_toolchain_label;
-  if (!outputs_map.empty()) {
-    default_toolchain_label =
-        outputs_map.begin()->first->settings()->default_toolchain_label();
+NinjaOutputsWriter::TargetEntry NinjaOutputsWriter::RenderEntry(
+    const Target* target,
+    const std::vector<OutputFile>& outputs) {
+  TargetEntry entry;
+  entry.label = target->label().GetUserVisibleName(
+      target->settings()->default_toolchain_label());
+
+  std::string& json = entry.json;
+  json.append("\n  ");
+  base::EscapeJSONString(entry.label, true, &json);
+  json.append(": [");
+  bool first_path = true;
+  for (const auto& output : outputs) {
+    if (!first_path)
+      json.push_back(',');
+    first_path = false;
+    json.append("\n    ");
+    base::EscapeJSONString(output.value(), true, &json);
   }
-
-  auto sorted_pairs =
-      TargetLabelPair::CreateSortedList(outputs_map, default_toolchain_label);
-
-  StringOutputBuffer out;
-  out.Append('{');
-
-  auto escape = [](std::string_view str) -> std::string {
-    std::string result;
-    base::EscapeJSONString(str, true, &result);
-    return result;
-  };
-
-  bool first_label = true;
-  for (const auto& pair : sorted_pairs) {
-    const Target* target = pair.target;
-    const std::string& label = *pair.label;
-
-    auto it = outputs_map.find(target);
-    CHECK(it != outputs_map.end());
-
-    if (!first_label)
-      out.Append(',');
-    first_label = false;
-
-    out.Append("\n  ");
-    out.Append(escape(label));
-    out.Append(": [");
-    bool first_path = true;
-    for (const auto& output : it->second) {
-      if (!first_path)
-        out.Append(',');
-      first_path = false;
-      out.Append("\n    ");
-      out.Append(escape(output.value()));
-    }
-    out.Append("\n  ]");
-  }
-
-  out.Append("\n}");
-  return out;
+  json.append("\n  ]");
+  return entry;
 }
 
+// static
 bool NinjaOutputsWriter::RunAndWriteFiles(
-    const MapType& outputs_map,
+    EntryList entries,
     const BuildSettings* build_settings,
     const std::string& file_name,
     const std::string& exec_script,
@@ -126,11 +128,14 @@ bool NinjaOutputsWriter::RunAndWriteFiles(
     return false;
   }
 
-  StringOutputBuffer outputs = GenerateJSON(outputs_map);
+  std::sort(entries.begin(), entries.end(),
+            [](const TargetEntry& a, const TargetEntry& b) {
+              return a.label < b.label;
+            });
 
   base::FilePath output_path = build_settings->GetFullPath(output_file);
-  if (!outputs.ContentsEqual(output_path)) {
-    if (!outputs.WriteToFile(output_path, err)) {
+  if (!ContentsEqual(output_path, entries)) {
+    if (!WriteToFile(output_path, entries, err)) {
       return false;
     }
 
@@ -6,36 +6,41 @@
 #define TOOLS_GN_NINJA_OUTPUTS_WRITER_H_
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "gn/err.h"
 #include "gn/output_file.h"
-#include "gn/string_output_buffer.h"
 #include "gn/target.h"
 
-class Builder;
 class BuildSettings;
-class StringOutputBuffer;
 
 // Generates the --ninja-outputs-file content
 class NinjaOutputsWriter {
  public:
-  // A map from targets to list of corresponding Ninja output paths.
-  using MapType = std::unordered_map<const Target*, std::vector<OutputFile>>;
-
-  static bool RunAndWriteFiles(const MapType& outputs_map,
+  // The JSON entry of one target. Entries are rendered by the threads
+  // writing the Ninja files, so that the output lists of all the targets
+  // don't have to be kept until the end of the generation.
+  struct TargetEntry {
+    // User visible label of the target, the entries are sorted by it.
+    std::string label;
+    // The label and the list of outputs, as one member of the JSON object.
+    std::string json;
+  };
+  using EntryList = std::vector<TargetEntry>;
+
+  // Returns the entry listing the Ninja |outputs| of |target|.
+  static TargetEntry RenderEntry(const Target* target,
+                                 const std::vector<OutputFile>& outputs);
+
+  // Writes the entries, sorted by label, to |file_name| if its contents
+  // changed.
+  static bool RunAndWriteFiles(EntryList entries,
                                const BuildSettings* build_setting,
                                const std::string& file_name,
                                const std::string& exec_script,
                                const std::string& exec_script_extra_args,
                                bool quiet,
                                Err* err);
-
- private:
-  FRIEND_TEST_ALL_PREFIXES(NinjaOutputsWriterTest, OutputsFile);
-
-  static StringOutputBuffer GenerateJSON(const MapType& outputs_map);
 };
 
 #endif
@@ -17,7 +17,6 @@
 #include "util/test/test.h"
 
 using NinjaOutputsWriterTest = TestWithScheduler;
-using NinjaOutputsMap = NinjaOutputsWriter::MapType;
 
 static void WriteFile(const base::FilePath& file, const std::string& data) {
   CHECK_EQ(static_cast<int>(data.size()),  // Way smaller than INT_MAX.
@@ -27,7 +26,7 @@ static void WriteFile(const base::FilePath& file, const std::string& data) {
 // Collects Ninja outputs for each target. Used by multiple background threads.
 struct TargetWriteInfo {
   std::mutex lock;
-  NinjaOutputsMap ninja_outputs_map;
+  NinjaOutputsWriter::EntryList ninja_outputs;
 };
 
 // Called on worker thread to write the ninja file.
@@ -36,9 +35,11 @@ void BackgroundDoWrite(TargetWriteInfo* write_info, const Target* target) {
   std::string rule = NinjaTargetWriter::RunAndWriteFile(target, nullptr,
                                                         &target_ninja_outputs);
 
+  NinjaOutputsWriter::TargetEntry entry =
+      NinjaOutputsWriter::RenderEntry(target, target_ninja_outputs);
+
   std::lock_guard<std::mutex> lock(write_info->lock);
-  write_info->ninja_outputs_map.emplace(target,
-                                        std::move(target_ninja_outputs));
+  write_info->ninja_outputs.push_back(std::move(entry));
 }
 
 static void ItemResolvedAndGeneratedCallback(TargetWriteInfo* write_info,
@@ -132,11 +133,15 @@ group("zoo") {
   // Do the actual load.
   ASSERT_TRUE(setup.Run());
 
-  StringOutputBuffer out =
-      NinjaOutputsWriter::GenerateJSON(write_info.ninja_outputs_map);
+  Err err;
+  ASSERT_TRUE(NinjaOutputsWriter::RunAndWriteFiles(
+      std::move(write_info.ninja_outputs), &setup.build_settings(),
+      FilePathToUTF8(outputs_json_path), "", "", true, &err));
 
   // Verify that the generated file is here.
-  std::string generated = out.str();
+  std::string generated;
+  ASSERT_TRUE(base::ReadFileToString(
+      build_temp_dir.GetPath().Append(outputs_json_path), &generated));
   std::string expected = R"##({
   "//:bar": [
     "bar.output",
@@ -4,6 +4,7 @@
 
 #include "gn/ninja_target_writer.h"
 
+#include <memory>
 #include <sstream>
 
 #include "base/files/file_util.h"
@@ -22,9 +23,11 @@
 #include "gn/ninja_create_bundle_target_writer.h"
 #include "gn/ninja_generated_file_target_writer.h"
 #include "gn/ninja_group_target_writer.h"
+#include "gn/ninja_logs.h"
 #include "gn/ninja_target_command_util.h"
 #include "gn/ninja_utils.h"
 #include "gn/output_file.h"
+#include "gn/output_sink.h"
 #include "gn/rust_substitution_type.h"
 #include "gn/scheduler.h"
 #include "gn/string_output_buffer.h"
@@ -99,7 +102,9 @@ void NinjaTargetWriter::WriteOutputs(std::vector<OutputFile>&& outputs) const {
 std::string NinjaTargetWriter::RunAndWriteFile(
     const Target* target,
     ResolvedTargetData* resolved,
-    std::vector<OutputFile>* ninja_outputs) {
+    std::vector<OutputFile>* ninja_outputs,
+    OutputSink* sink,
+    std::vector<std::string>* ninja_nodes) {
   const Settings* settings = target->settings();
 
   ScopedTrace trace(TraceItem::TRACE_FILE_WRITE_NINJA,
@@ -111,8 +116,8 @@ std::string NinjaTargetWriter::RunAndWriteFile(
 
   // It's ridiculously faster to write to a string and then write that to
   // disk in one operation than to use an fstream here.
-  StringOutputBuffer storage;
-  std::ostream rules(&storage);
+  auto storage = std::make_unique<StringOutputBuffer>();
+  std::ostream rules(storage.get());
 
   // Call out to the correct sub-type of writer. Binary targets need to be
   // written to separate files for compiler flag scoping, but other target
@@ -171,12 +176,18 @@ std::string NinjaTargetWriter::RunAndWriteFile(
     CHECK(0) << "Output type of target not handled.";
   }
 
+  if (ninja_nodes)
+    AppendNinjaBuildNodes(storage->str(), ninja_nodes);
+
   if (needs_file_write) {
     // Write the ninja file.
     SourceFile ninja_file = GetNinjaFileForTarget(target);
     base::FilePath full_ninja_file =
         settings->build_settings()->GetFullPath(ninja_file);
-    storage.WriteToFileIfChanged(full_ninja_file, nullptr);
+    if (sink)
+      sink->WriteToFileIfChanged(full_ninja_file, std::move(storage));
+    else
+      storage->WriteToFileIfChanged(full_ninja_file, nullptr);
 
     EscapeOptions options;
     options.mode = ESCAPE_NINJA;
@@ -191,7 +202,7 @@ std::string NinjaTargetWriter::RunAndWriteFile(
   }
 
   // No separate file required, just return the rules.
-  return storage.str();
+  return storage->str();
 }
 
 void NinjaTargetWriter::WriteEscapedSubstitution(const Substitution* type) {
@@ -12,6 +12,7 @@
 #include "gn/substitution_type.h"
 
 class OutputFile;
+class OutputSink;
 class Settings;
 class Target;
 struct SubstitutionBits;
@@ -49,10 +50,19 @@ class NinjaTargetWriter {
   //
   // If |ninja_outputs| is not nullptr, it will be set with the list of
   // Ninja output paths generated by the corresponding writer.
+  //
+  // If |sink| is not nullptr, the separate ninja file is queued to it instead
+  // of being written before returning.
+  //
+  // If |ninja_nodes| is not nullptr, the canonical paths of the outputs and
+  // inputs of all the build statements written for the target are appended
+  // to it (see AppendNinjaBuildNodes()).
   static std::string RunAndWriteFile(
       const Target* target,
       ResolvedTargetData* resolved = nullptr,
-      std::vector<OutputFile>* ninja_outputs = nullptr);
+      std::vector<OutputFile>* ninja_outputs = nullptr,
+      OutputSink* sink = nullptr,
+      std::vector<std::string>* ninja_nodes = nullptr);
 
   virtual void Run() = 0;
 
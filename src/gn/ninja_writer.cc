@@ -4,6 +4,9 @@
 
 #include "gn/ninja_writer.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "gn/builder.h"
 #include "gn/loader.h"
 #include "gn/location.h"
@@ -28,6 +31,65 @@ bool NinjaWriter::RunAndWriteFiles(const BuildSettings* build_settings,
   return NinjaBuildWriter::RunAndWriteFile(build_settings, builder, err);
 }
 
+// static
+void NinjaWriter::SortRules(PerToolchainRules* per_toolchain_rules) {
+  // All targets of a toolchain have the same toolchain label, so ordering by
+  // label means ordering by directory, then by name. Comparing labels
+  // repeatedly compares the same directory strings, which dominates with
+  // large builds. Instead, each distinct directory (there are far fewer of
+  // them than targets) is ranked once, then the rules are bucketed by
+  // directory rank with a counting sort, and only targets sharing a directory
+  // need to have their names compared.
+  //
+  // SourceDir values are interned, so the address of the string identifies
+  // the directory.
+  std::unordered_map<const std::string*, size_t> dir_ranks;
+  for (const auto& toolchain_rules : *per_toolchain_rules) {
+    for (const TargetRulePair& pair : toolchain_rules.second)
+      dir_ranks.emplace(&pair.first->label().dir().value(), 0);
+  }
+
+  std::vector<const std::string*> dirs;
+  dirs.reserve(dir_ranks.size());
+  for (const auto& dir : dir_ranks)
+    dirs.push_back(dir.first);
+  std::sort(dirs.begin(), dirs.end(),
+            [](const std::string* a, const std::string* b) { return *a < *b; });
+  for (size_t i = 0; i < dirs.size(); i++)
+    dir_ranks[dirs[i]] = i;
+
+  std::vector<size_t> rule_ranks;
+  std::vector<size_t> bucket_starts;
+  for (auto& toolchain_rules : *per_toolchain_rules) {
+    std::vector<TargetRulePair>& rules = toolchain_rules.second;
+    rule_ranks.resize(rules.size());
+    bucket_starts.assign(dirs.size() + 1, 0);
+    for (size_t i = 0; i < rules.size(); i++) {
+      rule_ranks[i] = dir_ranks[&rules[i].first->label().dir().value()];
+      bucket_starts[rule_ranks[i] + 1]++;
+    }
+    for (size_t i = 1; i < bucket_starts.size(); i++)
+      bucket_starts[i] += bucket_starts[i - 1];
+
+    std::vector<TargetRulePair> sorted(rules.size());
+    std::vector<size_t> next = bucket_starts;
+    for (size_t i = 0; i < rules.size(); i++)
+      sorted[next[rule_ranks[i]]++] = std::move(rules[i]);
+
+    for (size_t rank = 0; rank < dirs.size(); rank++) {
+      size_t begin = bucket_starts[rank];
+      size_t end = bucket_starts[rank + 1];
+      if (end - begin < 2)
+        continue;
+      std::sort(sorted.begin() + begin, sorted.begin() + end,
+                [](const TargetRulePair& a, const TargetRulePair& b) {
+                  return a.first->label() < b.first->label();
+                });
+    }
+    rules = std::move(sorted);
+  }
+}
+
 bool NinjaWriter::WriteToolchains(const PerToolchainRules& per_toolchain_rules,
                                   Err* err) {
   if (per_toolchain_rules.empty()) {
@@ -33,6 +33,10 @@ class NinjaWriter {
                                const PerToolchainRules& per_toolchain_rules,
                                Err* err);
 
+  // Sorts the rules of each toolchain by target label, which makes the
+  // toolchain build files have deterministic content.
+  static void SortRules(PerToolchainRules* per_toolchain_rules);
+
  private:
   NinjaWriter(const Builder& builder);
   ~NinjaWriter();
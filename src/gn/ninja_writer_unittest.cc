@@ -0,0 +1,46 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/ninja_writer.h"
+
+#include <memory>
+
+#include "gn/target.h"
+#include "gn/test_with_scope.h"
+#include "util/test/test.h"
+
+TEST(NinjaWriter, SortRules) {
+  TestWithScope setup;
+
+  const char* const kLabels[][2] = {
+      {"//foo/", "z"},     {"//foo/bar/", "a"}, {"//", "root"},
+      {"//foo/", "a"},     {"//foo-bar/", "x"}, {"//foo/", "m"},
+      {"//foo/bar/", "0"},
+  };
+  std::vector<std::unique_ptr<Target>> targets;
+  NinjaWriter::PerToolchainRules rules;
+  for (const auto& label : kLabels) {
+    targets.push_back(std::make_unique<Target>(
+        setup.settings(), Label(SourceDir(label[0]), label[1])));
+    rules[setup.toolchain()].emplace_back(targets.back().get(),
+                                          std::string(label[1]));
+  }
+
+  NinjaWriter::SortRules(&rules);
+
+  const std::vector<NinjaWriter::TargetRulePair>& sorted =
+      rules[setup.toolchain()];
+  ASSERT_EQ(std::size(kLabels), sorted.size());
+  EXPECT_EQ("//:root", sorted[0].first->label().GetUserVisibleName(false));
+  EXPECT_EQ("//foo-bar:x", sorted[1].first->label().GetUserVisibleName(false));
+  EXPECT_EQ("//foo:a", sorted[2].first->label().GetUserVisibleName(false));
+  EXPECT_EQ("//foo:m", sorted[3].first->label().GetUserVisibleName(false));
+  EXPECT_EQ("//foo:z", sorted[4].first->label().GetUserVisibleName(false));
+  EXPECT_EQ("//foo/bar:0", sorted[5].first->label().GetUserVisibleName(false));
+  EXPECT_EQ("//foo/bar:a", sorted[6].first->label().GetUserVisibleName(false));
+
+  // The rules follow their targets.
+  for (const auto& pair : sorted)
+    EXPECT_EQ(pair.first->label().name(), pair.second);
+}
@@ -0,0 +1,145 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/output_sink.h"
+
+#include <utility>
+
+#include "base/files/file_util.h"
+#include "gn/filesystem_utils.h"
+
+namespace {
+
+// Writing is I/O bound, a few threads are enough to keep the disk busy
+// without competing with the threads that produce the files.
+constexpr size_t kDefaultThreadCount = 4;
+
+// Number of requests submitted to the writer threads at once. Batching keeps
+// the number of tasks (and thus of lock round-trips on the worker pool queue)
+// low when many small files are produced at the same time.
+constexpr size_t kBatchSize = 32;
+
+}  // namespace
+
+OutputSink::OutputSink() : OutputSink(kDefaultThreadCount) {}
+
+OutputSink::OutputSink(size_t thread_count) : pool_(thread_count) {}
+
+OutputSink::~OutputSink() {
+  Err err;
+  Flush(&err);
+}
+
+void OutputSink::WriteToFileIfChanged(
+    const base::FilePath& file_path,
+    std::unique_ptr<StringOutputBuffer> contents) {
+  std::lock_guard<std::mutex> lock(lock_);
+  pending_.push_back(Request{file_path, std::move(contents)});
+  if (pending_.size() >= kBatchSize)
+    SubmitPendingLocked();
+}
+
+bool OutputSink::Flush(Err* err) {
+  std::unique_lock<std::mutex> lock(lock_);
+  if (!pending_.empty())
+    SubmitPendingLocked();
+  idle_cv_.wait(lock, [this]() { return in_flight_ == 0; });
+
+  if (first_error_.has_error()) {
+    *err = std::move(first_error_);
+    first_error_ = Err();
+    return false;
+  }
+  return true;
+}
+
+OutputSink::Stats OutputSink::GetStats() const {
+  Stats result;
+  result.files_written = files_written_.load(std::memory_order_relaxed);
+  result.files_unchanged = files_unchanged_.load(std::memory_order_relaxed);
+  result.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+  result.batches = batches_.load(std::memory_order_relaxed);
+  result.syscalls = syscalls_.load(std::memory_order_relaxed);
+  return result;
+}
+
+void OutputSink::SubmitPendingLocked() {
+  in_flight_++;
+  batches_.fetch_add(1, std::memory_order_relaxed);
+
+  // std::function requires a copyable callable, so the batch is moved to
+  // the heap and owned by a shared_ptr.
+  auto batch = std::make_shared<std::vector<Request>>(std::move(pending_));
+  pending_.clear();
+  pending_.reserve(kBatchSize);
+  pool_.PostTask([this, batch]() { ProcessBatch(std::move(*batch)); });
+}
+
+void OutputSink::ProcessBatch(std::vector<Request> batch) {
+  Err err;
+  for (const Request& request : batch) {
+    if (!ProcessRequest(request, &err))
+      break;
+  }
+
+  // Release the buffers before signaling completion.
+  batch.clear();
+
+  std::lock_guard<std::mutex> lock(lock_);
+  if (err.has_error() && !first_error_.has_error())
+    first_error_ = std::move(err);
+  if (--in_flight_ == 0)
+    idle_cv_.notify_all();
+}
+
+bool OutputSink::ProcessRequest(const Request& request, Err* err) {
+  const StringOutputBuffer& contents = *request.contents;
+  uint64_t pages = contents.page_count();
+
+  // ContentsEqual() checks the file size before reading anything: one stat,
+  // then open + one read per page + close when the sizes match.
+  int64_t file_size;
+  bool exists = base::GetFileSize(request.file_path, &file_size);
+  syscalls_.fetch_add(1, std::memory_order_relaxed);
+  if (exists && static_cast<size_t>(file_size) == contents.size()) {
+    syscalls_.fetch_add(pages + 3, std::memory_order_relaxed);
+    if (contents.ContentsEqual(request.file_path)) {
+      files_unchanged_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  // Files that already exist are in an existing directory.
+  if (!exists && !EnsureDirectoryExists(request.file_path.DirName())) {
+    *err = Err(Location(), "Unable to create directory.",
+               "I was using \"" +
+                   FilePathToUTF8(request.file_path.DirName()) + "\".");
+    return false;
+  }
+
+  // open + one write per page + close.
+  syscalls_.fetch_add(pages + 2, std::memory_order_relaxed);
+  if (!contents.WriteToFileInExistingDirectory(request.file_path, err))
+    return false;
+
+  files_written_.fetch_add(1, std::memory_order_relaxed);
+  bytes_written_.fetch_add(contents.size(), std::memory_order_relaxed);
+  return true;
+}
+
+bool OutputSink::EnsureDirectoryExists(const base::FilePath& dir) {
+  {
+    std::lock_guard<std::mutex> lock(dirs_lock_);
+    if (created_dirs_.count(dir.value()))
+      return true;
+  }
+
+  syscalls_.fetch_add(1, std::memory_order_relaxed);
+  if (!base::CreateDirectory(dir))
+    return false;
+
+  std::lock_guard<std::mutex> lock(dirs_lock_);
+  created_dirs_.insert(dir.value());
+  return true;
+}
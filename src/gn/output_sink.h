@@ -0,0 +1,116 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_OUTPUT_SINK_H_
+#define TOOLS_GN_OUTPUT_SINK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "gn/err.h"
+#include "gn/string_output_buffer.h"
+#include "util/worker_pool.h"
+
+// OutputSink writes completed StringOutputBuffers to disk in the background.
+//
+// "gn gen" produces tens of thousands of files. Writing each one from the
+// worker thread that rendered it means that thread blocks on a stat + read
+// (to compare with the existing file) and a create + write sequence before
+// it can pick up the next target. Instead, callers hand the buffer to the
+// sink, which queues it and submits queued requests in batches to a small
+// pool of dedicated writer threads.
+//
+// The sink also caches the directories it already created, so that only
+// the first file written to a given directory pays for the directory
+// creation, and keeps statistics about the work done.
+//
+// Usage:
+//
+//   OutputSink sink;
+//   ... from any thread:
+//   sink.WriteToFileIfChanged(path, std::move(buffer));
+//   ... once all files have been queued:
+//   if (!sink.Flush(&err))
+//     return false;
+//
+class OutputSink {
+ public:
+  struct Stats {
+    uint64_t files_written = 0;
+    uint64_t files_unchanged = 0;
+    uint64_t bytes_written = 0;
+    uint64_t batches = 0;
+
+    // Number of file system calls issued by the sink (stat, mkdir, open,
+    // read, write and close). Reads and writes are counted per buffer page,
+    // which is how they are issued.
+    uint64_t syscalls = 0;
+  };
+
+  OutputSink();
+  explicit OutputSink(size_t thread_count);
+
+  // Waits for pending writes to complete.
+  ~OutputSink();
+
+  // Queues |contents| to be written to |file_path| unless the file already
+  // exists with the same contents. Can be called from any thread.
+  void WriteToFileIfChanged(const base::FilePath& file_path,
+                            std::unique_ptr<StringOutputBuffer> contents);
+
+  // Submits any partial batch and blocks until all queued writes have
+  // completed. Returns false and sets |err| to the first write error, if
+  // any happened since the last call.
+  bool Flush(Err* err);
+
+  Stats GetStats() const;
+
+ private:
+  struct Request {
+    base::FilePath file_path;
+    std::unique_ptr<StringOutputBuffer> contents;
+  };
+
+  // Posts |pending_| to the writer threads. Must be called with |lock_| held.
+  void SubmitPendingLocked();
+
+  // Called on a writer thread.
+  void ProcessBatch(std::vector<Request> batch);
+  bool ProcessRequest(const Request& request, Err* err);
+
+  // Creates |dir| unless it was already created by this sink.
+  bool EnsureDirectoryExists(const base::FilePath& dir);
+
+  std::mutex lock_;
+  std::condition_variable idle_cv_;  // Signaled when |in_flight_| hits 0.
+  std::vector<Request> pending_;
+  size_t in_flight_ = 0;  // Submitted batches that haven't completed.
+  Err first_error_;
+
+  std::mutex dirs_lock_;
+  std::set<base::FilePath::StringType> created_dirs_;
+
+  std::atomic<uint64_t> files_written_{0};
+  std::atomic<uint64_t> files_unchanged_{0};
+  std::atomic<uint64_t> bytes_written_{0};
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> syscalls_{0};
+
+  // Declared last so its threads are joined before the state above goes
+  // away.
+  WorkerPool pool_;
+
+  OutputSink(const OutputSink&) = delete;
+  OutputSink& operator=(const OutputSink&) = delete;
+};
+
+#endif  // TOOLS_GN_OUTPUT_SINK_H_
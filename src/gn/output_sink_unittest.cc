@@ -0,0 +1,85 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/output_sink.h"
+
+#include <memory>
+#include <string>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "util/test/test.h"
+
+namespace {
+
+std::unique_ptr<StringOutputBuffer> MakeBuffer(const std::string& str) {
+  auto result = std::make_unique<StringOutputBuffer>();
+  result->Append(str);
+  return result;
+}
+
+}  // namespace
+
+TEST(OutputSink, WriteToFileIfChanged) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath dir = temp_dir.GetPath().AppendASCII("sub");
+  base::FilePath unchanged = dir.AppendASCII("unchanged.ninja");
+
+  OutputSink sink(2);
+  Err err;
+
+  // More files than a single batch, in a directory that doesn't exist yet.
+  for (int i = 0; i < 100; i++) {
+    sink.WriteToFileIfChanged(
+        dir.AppendASCII("file" + std::to_string(i) + ".ninja"),
+        MakeBuffer("contents " + std::to_string(i)));
+  }
+  sink.WriteToFileIfChanged(unchanged, MakeBuffer("same"));
+  ASSERT_TRUE(sink.Flush(&err));
+
+  std::string contents;
+  ASSERT_TRUE(
+      base::ReadFileToString(dir.AppendASCII("file42.ninja"), &contents));
+  EXPECT_EQ("contents 42", contents);
+
+  OutputSink::Stats stats = sink.GetStats();
+  EXPECT_EQ(101u, stats.files_written);
+  EXPECT_EQ(0u, stats.files_unchanged);
+  EXPECT_LT(1u, stats.batches);
+
+  // Writing the same contents again doesn't touch the file.
+  sink.WriteToFileIfChanged(unchanged, MakeBuffer("same"));
+  sink.WriteToFileIfChanged(dir.AppendASCII("file42.ninja"),
+                            MakeBuffer("new contents"));
+  ASSERT_TRUE(sink.Flush(&err));
+
+  stats = sink.GetStats();
+  EXPECT_EQ(102u, stats.files_written);
+  EXPECT_EQ(1u, stats.files_unchanged);
+  ASSERT_TRUE(
+      base::ReadFileToString(dir.AppendASCII("file42.ninja"), &contents));
+  EXPECT_EQ("new contents", contents);
+}
+
+TEST(OutputSink, Error) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  // A regular file is in the way of the directory to create.
+  base::FilePath file = temp_dir.GetPath().AppendASCII("file");
+  ASSERT_EQ(0, base::WriteFile(file, "", 0));
+
+  OutputSink sink(1);
+  sink.WriteToFileIfChanged(file.AppendASCII("foo.ninja"), MakeBuffer("foo"));
+
+  Err err;
+  EXPECT_FALSE(sink.Flush(&err));
+  EXPECT_TRUE(err.has_error());
+
+  // The error is only reported once.
+  err = Err();
+  EXPECT_TRUE(sink.Flush(&err));
+  EXPECT_FALSE(err.has_error());
+}
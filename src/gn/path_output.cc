@@ -4,9 +4,13 @@
 
 #include "gn/path_output.h"
 
+#include <sstream>
+
 #include "base/strings/string_util.h"
 #include "gn/filesystem_utils.h"
 #include "gn/output_file.h"
+#include "gn/path_output_cache.h"
+#include "gn/string_atom.h"
 #include "gn/string_utils.h"
 #include "util/build_config.h"
 
@@ -17,13 +21,14 @@ PathOutput::PathOutput(const SourceDir& current_dir,
   inverse_current_dir_ = RebasePath("//", current_dir, source_root);
   if (!EndsWithSlash(inverse_current_dir_))
     inverse_current_dir_.push_back('/');
+  inverse_current_dir_key_ = &StringAtom(inverse_current_dir_).str();
   options_.mode = escaping;
 }
 
 PathOutput::~PathOutput() = default;
 
 void PathOutput::WriteFile(std::ostream& out, const SourceFile& file) const {
-  WritePathStr(out, file.value());
+  WriteInternedPathStr(out, file.value(), false);
 }
 
 void PathOutput::WriteDir(std::ostream& out,
@@ -60,12 +65,10 @@ void PathOutput::WriteDir(std::ostream& out,
       out << "./";
     else
       out << ".";
-  } else if (slash_ending == DIR_INCLUDE_LAST_SLASH) {
-    WritePathStr(out, dir.value());
   } else {
-    // DIR_NO_LAST_SLASH mode, just trim the last char.
-    WritePathStr(out,
-                 std::string_view(dir.value().data(), dir.value().size() - 1));
+    // In DIR_NO_LAST_SLASH mode, just trim the last char.
+    WriteInternedPathStr(out, dir.value(),
+                         slash_ending == DIR_NO_LAST_SLASH);
   }
 }
 
@@ -173,3 +176,27 @@ void PathOutput::WritePathStr(std::ostream& out, std::string_view str) const {
 #endif
   }
 }
+
+void PathOutput::WriteInternedPathStr(std::ostream& out,
+                                      const std::string& str,
+                                      bool trim_last_char) const {
+  PathOutputCache::Key key;
+  key.path = &str;
+  key.current_dir = &current_dir_.value();
+  key.inverse_current_dir = inverse_current_dir_key_;
+  key.flags = static_cast<uint32_t>(options_.mode) |
+              (static_cast<uint32_t>(options_.platform) << 8) |
+              (options_.inhibit_quoting ? (1u << 16) : 0u) |
+              (trim_last_char ? (1u << 17) : 0u);
+
+  const std::string* rendered = PathOutputCache::Find(key);
+  if (!rendered) {
+    std::string_view path(str);
+    if (trim_last_char)
+      path.remove_suffix(1);
+    std::ostringstream buffer;
+    WritePathStr(buffer, path);
+    rendered = &PathOutputCache::Insert(key, buffer.str());
+  }
+  out.write(rendered->data(), rendered->size());
+}
@@ -78,11 +78,23 @@ class PathOutput {
   // current dir. This assumes leading slashes have been trimmed.
   void WriteSourceRelativeString(std::ostream& out, std::string_view str) const;
 
+  // Like WritePathStr() but for interned strings (the value of a SourceFile
+  // or SourceDir). The rendering is looked up in, or added to, the global
+  // PathOutputCache. If |trim_last_char| is set, the last character of |str|
+  // is not written (used to strip the trailing slash of directories).
+  void WriteInternedPathStr(std::ostream& out,
+                            const std::string& str,
+                            bool trim_last_char) const;
+
   SourceDir current_dir_;
 
   // Uses system slashes if convert_slashes_to_system_.
   std::string inverse_current_dir_;
 
+  // Interned copy of inverse_current_dir_, used as part of PathOutputCache
+  // keys.
+  const std::string* inverse_current_dir_key_;
+
   // Since the inverse_current_dir_ depends on some of these, we don't expose
   // this directly to modification.
   EscapeOptions options_;
@@ -0,0 +1,224 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/path_output_cache.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <set>
+
+#include "gn/hash_table_base.h"
+#include "gn/string_atom.h"
+#include "util/build_config.h"
+
+namespace {
+
+// Implementation note:
+//
+// This follows the same scheme as the StringAtom implementation: a global
+// table protected by a mutex, and a per-thread cache that is consulted first
+// so that the mutex is only taken when a thread sees a key for the first
+// time. Since the set of distinct paths is small compared to the number of
+// times each one is written, this means nearly all lookups are lock-free.
+
+// A HashTableBase node type that stores a key and its rendered value.
+struct CacheNode {
+  size_t hash;
+  PathOutputCache::Key key;
+  const std::string* value;
+
+  // The following methods are required by HashTableBase<>
+  bool is_valid() const { return !is_null(); }
+  bool is_null() const { return !value; }
+  size_t hash_value() const { return hash; }
+
+  // No deletion support means faster lookup code.
+  static constexpr bool is_tombstone() { return false; }
+};
+
+struct CacheTable : public HashTableBase<CacheNode> {
+  using BaseType = HashTableBase<CacheNode>;
+  using Node = BaseType::Node;
+
+  // Lookup for |key| with specific |hash| value. Always returns a Node
+  // pointer. If the key was not found, |node->value| is null and the node
+  // can be passed to Insert().
+  Node* Lookup(size_t hash, const PathOutputCache::Key& key) const {
+    return BaseType::NodeLookup(hash, [hash, &key](const Node* node) {
+      return node->hash == hash && node->key == key;
+    });
+  }
+
+  void Insert(Node* node,
+              size_t hash,
+              const PathOutputCache::Key& key,
+              const std::string* value) {
+    node->hash = hash;
+    node->key = key;
+    node->value = value;
+    BaseType::UpdateAfterInsert();
+  }
+};
+
+class ThreadLocalCache;
+
+class GlobalCache {
+ public:
+  const std::string* Find(size_t hash, const PathOutputCache::Key& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return table_.Lookup(hash, key)->value;
+  }
+
+  const std::string* Insert(size_t hash,
+                            const PathOutputCache::Key& key,
+                            std::string_view rendered) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto* node = table_.Lookup(hash, key);
+    if (node->value)
+      return node->value;
+    // Inserting can grow the table, so |node| must not be used afterwards.
+    const std::string* value = &StringAtom(rendered).str();
+    table_.Insert(node, hash, key, value);
+    return value;
+  }
+
+  void Register(ThreadLocalCache* cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    caches_.insert(cache);
+  }
+
+  // Called when a thread exits, to keep its counters in the totals.
+  void Unregister(ThreadLocalCache* cache, uint64_t hits, uint64_t misses) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    caches_.erase(cache);
+    retired_stats_.hits += hits;
+    retired_stats_.misses += misses;
+  }
+
+  PathOutputCache::Stats GetStats();
+
+ private:
+  std::mutex mutex_;
+  CacheTable table_;
+  std::set<ThreadLocalCache*> caches_;
+  PathOutputCache::Stats retired_stats_;
+};
+
+GlobalCache& GetGlobalCache() {
+  // Deliberately leaked, since thread-local caches may still reference it
+  // during process teardown.
+  static GlobalCache* s_global_cache = new GlobalCache();
+  return *s_global_cache;
+}
+
+// Each thread maintains its own ThreadLocalCache to perform fast lookups
+// without taking any mutex in most cases. The counters are only written by
+// the owning thread, and are atomic so they can be read from GetStats().
+class ThreadLocalCache {
+ public:
+  ThreadLocalCache() { GetGlobalCache().Register(this); }
+  ~ThreadLocalCache() {
+    GetGlobalCache().Unregister(this, hits_.load(std::memory_order_relaxed),
+                                misses_.load(std::memory_order_relaxed));
+  }
+
+  const std::string* Find(const PathOutputCache::Key& key) {
+    size_t hash = key.Hash();
+    auto* node = table_.Lookup(hash, key);
+    if (node->value) {
+      Increment(&hits_);
+      return node->value;
+    }
+
+    const std::string* result = GetGlobalCache().Find(hash, key);
+    if (!result) {
+      Increment(&misses_);
+      return nullptr;
+    }
+    Increment(&hits_);
+    table_.Insert(node, hash, key, result);
+    return result;
+  }
+
+  const std::string& Insert(const PathOutputCache::Key& key,
+                            std::string_view rendered) {
+    size_t hash = key.Hash();
+    const std::string* result =
+        GetGlobalCache().Insert(hash, key, rendered);
+    auto* node = table_.Lookup(hash, key);
+    if (!node->value)
+      table_.Insert(node, hash, key, result);
+    return *result;
+  }
+
+  PathOutputCache::Stats GetStats() const {
+    PathOutputCache::Stats result;
+    result.hits = hits_.load(std::memory_order_relaxed);
+    result.misses = misses_.load(std::memory_order_relaxed);
+    return result;
+  }
+
+ private:
+  // Only the owning thread writes to the counters, so a relaxed load + store
+  // is enough and avoids a locked read-modify-write on the hot path.
+  static void Increment(std::atomic<uint64_t>* counter) {
+    counter->store(counter->load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+  }
+
+  CacheTable table_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+PathOutputCache::Stats GlobalCache::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PathOutputCache::Stats result = retired_stats_;
+  for (const ThreadLocalCache* cache : caches_) {
+    PathOutputCache::Stats stats = cache->GetStats();
+    result.hits += stats.hits;
+    result.misses += stats.misses;
+  }
+  return result;
+}
+
+#if !defined(OS_ZOS)
+thread_local ThreadLocalCache s_local_cache;
+#define LOCAL_CACHE() (&s_local_cache)
+#else
+// z/OS has no thread_local, emulate it with zoslib as string_atom.cc does.
+static ThreadLocalCache s_tlc;
+__tlssim<ThreadLocalCache*> __g_s_local_cache_impl(&s_tlc);
+#define LOCAL_CACHE() (*__g_s_local_cache_impl.access())
+#endif
+
+}  // namespace
+
+size_t PathOutputCache::Key::Hash() const {
+  std::hash<const void*> ptr_hash;
+  size_t result = ptr_hash(path);
+  result = result * 31 + ptr_hash(current_dir);
+  result = result * 31 + ptr_hash(inverse_current_dir);
+  result = result * 31 + flags;
+  // Pointer hashes have their low bits cleared, mix them back in since
+  // HashTableBase uses power-of-2 bucket counts.
+  return result ^ (result >> 7) ^ (result >> 17);
+}
+
+// static
+const std::string* PathOutputCache::Find(const Key& key) {
+  return LOCAL_CACHE()->Find(key);
+}
+
+// static
+const std::string& PathOutputCache::Insert(const Key& key,
+                                           std::string_view rendered) {
+  return LOCAL_CACHE()->Insert(key, rendered);
+}
+
+// static
+PathOutputCache::Stats PathOutputCache::GetStats() {
+  return GetGlobalCache().GetStats();
+}
@@ -0,0 +1,64 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_PATH_OUTPUT_CACHE_H_
+#define TOOLS_GN_PATH_OUTPUT_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+
+// PathOutputCache stores the final rendering (rebased and escaped bytes) of
+// source-absolute paths written by PathOutput, so that the same headers,
+// object files and stamp files referenced by thousands of targets are only
+// rebased and escaped once per process.
+//
+// Keys are the addresses of interned strings (i.e. the value of a StringAtom,
+// as returned by SourceFile::value() or SourceDir::value()) combined with the
+// PathOutput context (current directory, inverse current directory) and the
+// escaping flags. Rendered values are interned as StringAtoms too, so the
+// returned pointers remain valid for the lifetime of the process.
+//
+// Lookups are safe to perform concurrently from any thread: each thread has
+// its own lock-free cache, and only falls back to a mutex-protected global
+// table on a miss.
+class PathOutputCache {
+ public:
+  struct Key {
+    const std::string* path;
+    const std::string* current_dir;
+    const std::string* inverse_current_dir;
+    uint32_t flags;
+
+    bool operator==(const Key& other) const {
+      return path == other.path && current_dir == other.current_dir &&
+             inverse_current_dir == other.inverse_current_dir &&
+             flags == other.flags;
+    }
+
+    size_t Hash() const;
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  // Returns the cached rendering for |key|, or nullptr if it is not known
+  // yet. In the latter case, the caller should render the path and call
+  // Insert(). The result has a stable address.
+  static const std::string* Find(const Key& key);
+
+  // Records |rendered| as the rendering for |key| and returns its interned
+  // copy. If another thread inserted the same key concurrently, the first
+  // value wins (both are identical anyway).
+  static const std::string& Insert(const Key& key, std::string_view rendered);
+
+  // Returns the hit / miss counts accumulated by all threads so far.
+  static Stats GetStats();
+};
+
+#endif  // TOOLS_GN_PATH_OUTPUT_CACHE_H_
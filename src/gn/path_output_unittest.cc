@@ -7,6 +7,7 @@
 #include "base/files/file_path.h"
 #include "gn/output_file.h"
 #include "gn/path_output.h"
+#include "gn/path_output_cache.h"
 #include "gn/source_dir.h"
 #include "gn/source_file.h"
 #include "util/build_config.h"
@@ -274,3 +275,49 @@ TEST(PathOutput, WriteDir) {
     }
   }
 }
+
+// Writing the same file or directory repeatedly must give identical results
+// whether the rendering comes from the cache or not, and the cache must not
+// mix up renderings for different writers or escaping options.
+TEST(PathOutput, CachedRendering) {
+  std::string_view source_root("/source/root");
+  PathOutput debug_writer(SourceDir("//out/Debug/"), source_root,
+                          ESCAPE_NINJA_COMMAND);
+  debug_writer.set_escape_platform(ESCAPE_PLATFORM_WIN);
+  PathOutput release_writer(SourceDir("//out/Release/"), source_root,
+                            ESCAPE_NINJA_COMMAND);
+  release_writer.set_escape_platform(ESCAPE_PLATFORM_WIN);
+  SourceFile file("//cache_test/foo bar.cc");
+  SourceDir dir("//out/Debug/cache_test/");
+
+  PathOutputCache::Stats before = PathOutputCache::GetStats();
+  for (int i = 0; i < 3; i++) {
+    std::ostringstream out;
+    debug_writer.WriteFile(out, file);
+    EXPECT_EQ("\"../../cache_test/foo$ bar.cc\"", out.str());
+  }
+  {
+    std::ostringstream out;
+    release_writer.WriteFile(out, file);
+    EXPECT_EQ("\"../../cache_test/foo$ bar.cc\"", out.str());
+  }
+  {
+    std::ostringstream out;
+    debug_writer.set_inhibit_quoting(true);
+    debug_writer.WriteFile(out, file);
+    EXPECT_EQ("../../cache_test/foo$ bar.cc", out.str());
+  }
+  for (int i = 0; i < 2; i++) {
+    std::ostringstream out;
+    debug_writer.WriteDir(out, dir, PathOutput::DIR_INCLUDE_LAST_SLASH);
+    out << " ";
+    debug_writer.WriteDir(out, dir, PathOutput::DIR_NO_LAST_SLASH);
+    EXPECT_EQ("cache_test/ cache_test", out.str());
+  }
+  PathOutputCache::Stats after = PathOutputCache::GetStats();
+
+  // 3 file renderings (one per writer or option set) and 2 dir renderings
+  // are computed, everything else comes from the cache.
+  EXPECT_EQ(5u, after.misses - before.misses);
+  EXPECT_EQ(4u, after.hits - before.hits);
+}
@@ -14,12 +14,14 @@
 #include "base/strings/utf_string_conversions.h"
 
 #include "gn/builder.h"
-#include "gn/config_values_extractors.h"
-#include "gn/deps_iterator.h"
+#include "gn/config_values.h"
 #include "gn/filesystem_utils.h"
 #include "gn/label.h"
 #include "gn/loader.h"
+#include "gn/settings.h"
 #include "gn/string_output_buffer.h"
+#include "gn/target_closure.h"
+#include "gn/target_values_union.h"
 
 namespace {
 base::FilePath::CharType kProjectDirName[] =
@@ -72,21 +74,11 @@ QtCreatorWriter::QtCreatorWriter(const BuildSettings* build_settings,
 
 QtCreatorWriter::~QtCreatorWriter() = default;
 
-void QtCreatorWriter::CollectDeps(const Target* target) {
-  for (const auto& dep : target->GetDeps(Target::DEPS_ALL)) {
-    const Target* dep_target = dep.ptr;
-    if (!targets_.add(dep_target))
-      continue;
-    CollectDeps(dep_target);
-  }
-}
-
 bool QtCreatorWriter::DiscoverTargets() {
   auto all_targets = builder_.GetAllResolvedTargets();
 
   if (root_target_name_.empty()) {
-    targets_.clear();
-    targets_.insert(all_targets.begin(), all_targets.end());
+    targets_ = std::move(all_targets);
     return true;
   }
 
@@ -103,8 +95,8 @@ bool QtCreatorWriter::DiscoverTargets() {
     return false;
   }
 
-  targets_.insert(root_target);
-  CollectDeps(root_target);
+  targets_ = TargetClosure(std::move(all_targets), Target::DEPS_ALL)
+                 .Collect({root_target});
   return true;
 }
 
@@ -221,43 +213,32 @@ void ParseCompilerOptions(const std::vector<std::string>& cflags,
 }  // namespace QtCreatorWriterUtils
 
 void QtCreatorWriter::HandleTarget(const Target* target) {
-  using namespace QtCreatorWriterUtils;
-
   SourceFile build_file = builder_.loader()->BuildFileForLabel(target->label());
   sources_.insert(FilePathToUTF8(build_settings_->GetFullPath(build_file)));
-  AddToSources(target->settings()->import_manager().GetImportedFiles());
-
-  AddToSources(target->sources());
-  AddToSources(target->public_headers());
+}
 
-  for (ConfigValuesIterator it(target); !it.done(); it.Next()) {
-    for (const auto& input : it.cur().inputs())
-      sources_.insert(FilePathToUTF8(build_settings_->GetFullPath(input)));
+void QtCreatorWriter::HandleValues(const TargetValuesUnion& values) {
+  using namespace QtCreatorWriterUtils;
 
-    SourceFile precompiled_source = it.cur().precompiled_source();
-    if (!precompiled_source.is_null()) {
-      sources_.insert(
-          FilePathToUTF8(build_settings_->GetFullPath(precompiled_source)));
-    }
+  AddToSources(values.files());
 
-    for (const SourceDir& include_dir : it.cur().include_dirs()) {
-      includes_.insert(
-          FilePathToUTF8(build_settings_->GetFullPath(include_dir)));
-    }
+  for (const SourceDir& include_dir : values.include_dirs())
+    includes_.insert(FilePathToUTF8(build_settings_->GetFullPath(include_dir)));
 
-    static constexpr const char* define_str = "#define ";
-    for (std::string define : it.cur().defines()) {
-      size_t equal_pos = define.find('=');
-      if (equal_pos != std::string::npos)
-        define[equal_pos] = ' ';
-      define.insert(0, define_str);
-      defines_.insert(define);
-    }
+  static constexpr const char* define_str = "#define ";
+  for (std::string define : values.defines()) {
+    size_t equal_pos = define.find('=');
+    if (equal_pos != std::string::npos)
+      define[equal_pos] = ' ';
+    define.insert(0, define_str);
+    defines_.insert(define);
+  }
 
+  for (const ConfigValues* config_values : values.config_values()) {
     CompilerOptions options;
-    ParseCompilerOptions(it.cur().cflags(), &options);
-    ParseCompilerOptions(it.cur().cflags_c(), &options);
-    ParseCompilerOptions(it.cur().cflags_cc(), &options);
+    ParseCompilerOptions(config_values->cflags(), &options);
+    ParseCompilerOptions(config_values->cflags_c(), &options);
+    ParseCompilerOptions(config_values->cflags_cc(), &options);
 
     auto add_define_version = [this](auto& ver) {
       if (ver)
@@ -282,12 +263,19 @@ void QtCreatorWriter::Run() {
   if (!DiscoverTargets())
     return;
 
+  // The imported files are the same for all the targets of a toolchain.
+  std::vector<const Target*> targets;
+  std::set<const Settings*> settings;
   for (const Target* target : targets_) {
     if (target->toolchain()->label() !=
         builder_.loader()->GetDefaultToolchain())
       continue;
+    targets.push_back(target);
     HandleTarget(target);
+    if (settings.insert(target->settings()).second)
+      AddToSources(target->settings()->import_manager().GetImportedFiles());
   }
+  HandleValues(TargetValuesUnion(targets));
 
   std::set<std::string> empty_list;
 
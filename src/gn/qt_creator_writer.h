@@ -7,6 +7,7 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include "base/files/file_path.h"
 #include "gn/err.h"
@@ -14,6 +15,7 @@
 
 class Builder;
 class BuildSettings;
+class TargetValuesUnion;
 
 class QtCreatorWriter {
  public:
@@ -33,8 +35,8 @@ class QtCreatorWriter {
 
   bool DiscoverTargets();
   void HandleTarget(const Target* target);
+  void HandleValues(const TargetValuesUnion& values);
 
-  void CollectDeps(const Target* target);
   void AddToSources(const Target::FileList& files);
   void GenerateFile(const base::FilePath::CharType* suffix,
                     const std::set<std::string>& items);
@@ -43,7 +45,7 @@ class QtCreatorWriter {
   const Builder& builder_;
   base::FilePath project_prefix_;
   std::string root_target_name_;
-  TargetSet targets_;
+  std::vector<const Target*> targets_;
   std::set<std::string> sources_;
   std::set<std::string> includes_;
   std::set<std::string> defines_;
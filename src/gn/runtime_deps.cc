@@ -23,11 +23,10 @@
 #include "gn/switches.h"
 #include "gn/target.h"
 #include "gn/trace.h"
+#include "util/worker_pool.h"
 
 namespace {
 
-using RuntimeDepsVector = std::vector<std::pair<OutputFile, const Target*>>;
-
 // Adds the given file to the deps list if it hasn't already been listed in
 // the found_files list. Updates the list.
 void AddIfNew(const OutputFile& output_file,
@@ -40,14 +39,10 @@ void AddIfNew(const OutputFile& output_file,
 }
 
 // Automatically converts a string that looks like a source to an OutputFile.
-void AddIfNew(const std::string& str,
-              const Target* source,
-              RuntimeDepsVector* deps,
-              std::set<OutputFile>* found_file) {
-  OutputFile output_file(
+OutputFile ToOutputFile(const std::string& str, const Target* source) {
+  return OutputFile(
       RebasePath(str, source->settings()->build_settings()->build_dir(),
                  source->settings()->build_settings()->root_path_utf8()));
-  AddIfNew(output_file, source, deps, found_file);
 }
 
 // To avoid duplicate traversals of targets, or duplicating output files that
@@ -56,7 +51,8 @@ void AddIfNew(const std::string& str,
 // is a boolean indicating if the seen dep was a data dep (true = data_dep).
 // data deps add more stuff, so we will want to revisit a target if it's a
 // data dependency and we've previously only seen it as a regular dep.
-void RecursiveCollectRuntimeDeps(const Target* target,
+void RecursiveCollectRuntimeDeps(RuntimeDepsCache* cache,
+                                 const Target* target,
                                  bool is_target_data_dep,
                                  RuntimeDepsVector* deps,
                                  std::map<const Target*, bool>* seen_targets,
@@ -74,58 +70,27 @@ void RecursiveCollectRuntimeDeps(const Target* target,
   }
   (*seen_targets)[target] = is_target_data_dep;
 
-  // Add the main output file for executables, shared libraries, and
-  // loadable modules.
-  if (target->output_type() == Target::EXECUTABLE ||
-      target->output_type() == Target::LOADABLE_MODULE ||
-      target->output_type() == Target::SHARED_LIBRARY) {
-    for (const auto& runtime_output : target->runtime_outputs())
-      AddIfNew(runtime_output, target, deps, found_files);
-  }
-
-  // Add all data files.
-  for (const auto& file : target->data())
+  const RuntimeDepsCache::Step& step =
+      cache->GetStep(target, is_target_data_dep);
+  for (const auto& file : step.files)
     AddIfNew(file, target, deps, found_files);
 
-  // Actions/copy have all outputs considered when the're a data dep.
-  if (is_target_data_dep && (target->output_type() == Target::ACTION ||
-                             target->output_type() == Target::ACTION_FOREACH ||
-                             target->output_type() == Target::COPY_FILES)) {
-    std::vector<SourceFile> outputs;
-    target->action_values().GetOutputsAsSourceFiles(target, &outputs);
-    for (const auto& output_file : outputs)
-      AddIfNew(output_file.value(), target, deps, found_files);
-  }
-
   // Data dependencies.
-  for (const auto& dep_pair : target->data_deps()) {
-    RecursiveCollectRuntimeDeps(dep_pair.ptr, true, deps, seen_targets,
+  for (const Target* dep : step.data_deps)
+    RecursiveCollectRuntimeDeps(cache, dep, true, deps, seen_targets,
                                 found_files);
-  }
 
   // Do not recurse into bundle targets. A bundle's dependencies should be
   // copied into the bundle itself for run-time access.
-  if (target->output_type() == Target::CREATE_BUNDLE) {
-    SourceDir bundle_root_dir =
-        target->bundle_data().GetBundleRootDirOutputAsDir(target->settings());
-    AddIfNew(bundle_root_dir.value(), target, deps, found_files);
+  if (step.bundle_root_dir) {
+    AddIfNew(*step.bundle_root_dir, target, deps, found_files);
     return;
   }
 
   // Non-data dependencies (both public and private).
-  for (const auto& dep_pair : target->GetDeps(Target::DEPS_LINKED)) {
-    if (dep_pair.ptr->output_type() == Target::EXECUTABLE)
-      continue;  // Skip executables that aren't data deps.
-    if (dep_pair.ptr->output_type() == Target::SHARED_LIBRARY &&
-        (target->output_type() == Target::ACTION ||
-         target->output_type() == Target::ACTION_FOREACH)) {
-      // Skip shared libraries that action depends on,
-      // unless it were listed in data deps.
-      continue;
-    }
-    RecursiveCollectRuntimeDeps(dep_pair.ptr, false, deps, seen_targets,
+  for (const Target* dep : step.deps)
+    RecursiveCollectRuntimeDeps(cache, dep, false, deps, seen_targets,
                                 found_files);
-  }
 }
 
 bool CollectRuntimeDepsFromFlag(const BuildSettings* build_settings,
@@ -204,7 +169,8 @@ bool CollectRuntimeDepsFromFlag(const BuildSettings* build_settings,
   return true;
 }
 
-bool WriteRuntimeDepsFile(const OutputFile& output_file,
+bool WriteRuntimeDepsFile(RuntimeDepsCache* cache,
+                          const OutputFile& output_file,
                           const Target* target,
                           Err* err) {
   SourceFile output_as_source =
@@ -214,7 +180,7 @@ bool WriteRuntimeDepsFile(const OutputFile& output_file,
 
   StringOutputBuffer storage;
   std::ostream contents(&storage);
-  for (const auto& pair : ComputeRuntimeDeps(target))
+  for (const auto& pair : cache->ComputeRuntimeDeps(target))
     contents << pair.first.value() << std::endl;
 
   ScopedTrace trace(TraceItem::TRACE_FILE_WRITE, output_as_source.value());
@@ -292,7 +258,11 @@ Multiple outputs
   the tool, the default will be the first output only.
 )";
 
-RuntimeDepsVector ComputeRuntimeDeps(const Target* target) {
+RuntimeDepsCache::RuntimeDepsCache() = default;
+
+RuntimeDepsCache::~RuntimeDepsCache() = default;
+
+RuntimeDepsVector RuntimeDepsCache::ComputeRuntimeDeps(const Target* target) {
   RuntimeDepsVector result;
   std::map<const Target*, bool> seen_targets;
   std::set<OutputFile> found_files;
@@ -300,11 +270,80 @@ RuntimeDepsVector ComputeRuntimeDeps(const Target* target) {
   // The initial target is not considered a data dependency so that actions's
   // outputs (if the current target is an action) are not automatically
   // considered data deps.
-  RecursiveCollectRuntimeDeps(target, false, &result, &seen_targets,
+  RecursiveCollectRuntimeDeps(this, target, false, &result, &seen_targets,
                               &found_files);
   return result;
 }
 
+const RuntimeDepsCache::Step& RuntimeDepsCache::GetStep(
+    const Target* target,
+    bool is_target_data_dep) {
+  auto& steps = steps_[is_target_data_dep];
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto found = steps.find(target);
+    if (found != steps.end())
+      return *found->second;
+  }
+
+  // Another thread may compute the same step concurrently, in which case the
+  // first one inserted wins. Both are identical.
+  auto step = std::make_unique<Step>();
+
+  // Add the main output file for executables, shared libraries, and
+  // loadable modules.
+  if (target->output_type() == Target::EXECUTABLE ||
+      target->output_type() == Target::LOADABLE_MODULE ||
+      target->output_type() == Target::SHARED_LIBRARY) {
+    for (const auto& runtime_output : target->runtime_outputs())
+      step->files.push_back(runtime_output);
+  }
+
+  // Add all data files.
+  for (const auto& file : target->data())
+    step->files.push_back(ToOutputFile(file, target));
+
+  // Actions/copy have all outputs considered when the're a data dep.
+  if (is_target_data_dep && (target->output_type() == Target::ACTION ||
+                             target->output_type() == Target::ACTION_FOREACH ||
+                             target->output_type() == Target::COPY_FILES)) {
+    std::vector<SourceFile> outputs;
+    target->action_values().GetOutputsAsSourceFiles(target, &outputs);
+    for (const auto& output_file : outputs)
+      step->files.push_back(ToOutputFile(output_file.value(), target));
+  }
+
+  for (const auto& dep_pair : target->data_deps())
+    step->data_deps.push_back(dep_pair.ptr);
+
+  if (target->output_type() == Target::CREATE_BUNDLE) {
+    SourceDir bundle_root_dir =
+        target->bundle_data().GetBundleRootDirOutputAsDir(target->settings());
+    step->bundle_root_dir = ToOutputFile(bundle_root_dir.value(), target);
+  } else {
+    for (const auto& dep_pair : target->GetDeps(Target::DEPS_LINKED)) {
+      if (dep_pair.ptr->output_type() == Target::EXECUTABLE)
+        continue;  // Skip executables that aren't data deps.
+      if (dep_pair.ptr->output_type() == Target::SHARED_LIBRARY &&
+          (target->output_type() == Target::ACTION ||
+           target->output_type() == Target::ACTION_FOREACH)) {
+        // Skip shared libraries that action depends on,
+        // unless it were listed in data deps.
+        continue;
+      }
+      step->deps.push_back(dep_pair.ptr);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  return *steps.emplace(target, std::move(step)).first->second;
+}
+
+RuntimeDepsVector ComputeRuntimeDeps(const Target* target) {
+  RuntimeDepsCache cache;
+  return cache.ComputeRuntimeDeps(target);
+}
+
 bool WriteRuntimeDepsFilesIfNecessary(const BuildSettings* build_settings,
                                       const Builder& builder,
                                       Err* err) {
@@ -319,12 +358,32 @@ bool WriteRuntimeDepsFilesIfNecessary(const BuildSettings* build_settings,
         std::make_pair(target->write_runtime_deps_output(), target));
   }
 
-  for (const auto& entry : files_to_write) {
-    // Currently this writes all runtime deps files sequentially. We generally
-    // expect few of these. We can run this on the worker pool if it looks
-    // like it's talking a long time.
-    if (!WriteRuntimeDepsFile(entry.first, entry.second, err))
+  // The same file may be requested more than once, in which case the last
+  // request wins as it did when the files were written in order.
+  std::map<OutputFile, size_t> last_entry;
+  for (size_t i = 0; i < files_to_write.size(); i++)
+    last_entry[files_to_write[i].first] = i;
+
+  // The runtime deps of most targets overlap, so all the files share one
+  // cache.
+  RuntimeDepsCache cache;
+  std::vector<Err> errors(files_to_write.size());
+  ParallelFor(files_to_write.size(), [&cache, &files_to_write, &last_entry,
+                                       &errors](size_t, size_t begin,
+                                                size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      if (last_entry.at(files_to_write[i].first) == i) {
+        WriteRuntimeDepsFile(&cache, files_to_write[i].first,
+                             files_to_write[i].second, &errors[i]);
+      }
+    }
+  });
+
+  for (const Err& error : errors) {
+    if (error.has_error()) {
+      *err = error;
       return false;
+    }
   }
   return true;
 }
@@ -5,22 +5,71 @@
 #ifndef TOOLS_GN_RUNTIME_DEPS_H
 #define TOOLS_GN_RUNTIME_DEPS_H
 
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "gn/output_file.h"
+
 class Builder;
 class BuildSettings;
 class Err;
-class OutputFile;
 class Target;
 
 extern const char kRuntimeDeps_Help[];
 
+using RuntimeDepsVector = std::vector<std::pair<OutputFile, const Target*>>;
+
+// Caches what each target contributes to the runtime deps of its dependents,
+// so that computing the runtime deps of many targets with overlapping
+// dependencies only inspects each target once. The targets must stay alive
+// and unmodified as long as the cache is used.
+//
+// This class is threadsafe.
+class RuntimeDepsCache {
+ public:
+  // What a target contributes to a runtime deps walk, depending on whether it
+  // is reached as a data dep.
+  struct Step {
+    // The runtime dependencies listed by the target itself.
+    std::vector<OutputFile> files;
+
+    std::vector<const Target*> data_deps;
+
+    // Set for bundles, which stop the walk after their data deps.
+    std::optional<OutputFile> bundle_root_dir;
+
+    // The non-data dependencies to walk.
+    std::vector<const Target*> deps;
+  };
+
+  RuntimeDepsCache();
+  ~RuntimeDepsCache();
+
+  // See the ComputeRuntimeDeps() function below.
+  RuntimeDepsVector ComputeRuntimeDeps(const Target* target);
+
+  // Returns the step of the given target, computing it if needed. The
+  // reference stays valid for the lifetime of the cache.
+  const Step& GetStep(const Target* target, bool is_target_data_dep);
+
+ private:
+  std::mutex lock_;
+
+  // Indexed by whether the target is reached as a data dep.
+  std::unordered_map<const Target*, std::unique_ptr<Step>> steps_[2];
+
+  RuntimeDepsCache(const RuntimeDepsCache&) = delete;
+  RuntimeDepsCache& operator=(const RuntimeDepsCache&) = delete;
+};
+
 // Computes the runtime dependencies of the given target. The result is a list
 // of pairs listing the runtime dependency and the target that the runtime
 // dependency is from (for blaming).
-std::vector<std::pair<OutputFile, const Target*>> ComputeRuntimeDeps(
-    const Target* target);
+RuntimeDepsVector ComputeRuntimeDeps(const Target* target);
 
 // Writes all runtime deps files requested on the command line, or does nothing
 // if no files were specified.
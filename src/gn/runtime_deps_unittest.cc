@@ -419,6 +419,40 @@ TEST_F(RuntimeDeps, Dupe) {
       << GetVectorDescription(result);
 }
 
+// Tests that a shared cache gives the same results as separate walks, both
+// for a target reached as a data dep and as a regular dep.
+TEST_F(RuntimeDeps, SharedCache) {
+  TestWithScope setup;
+  Err err;
+
+  Target action(setup.settings(), Label(SourceDir("//"), "action"));
+  InitTargetWithType(setup, &action, Target::ACTION);
+  action.action_values().outputs() =
+      SubstitutionList::MakeForTest("//action.output");
+  action.data().push_back("//action.dat");
+  ASSERT_TRUE(action.OnResolved(&err));
+
+  Target data_user(setup.settings(), Label(SourceDir("//"), "data_user"));
+  InitTargetWithType(setup, &data_user, Target::EXECUTABLE);
+  data_user.data_deps().push_back(LabelTargetPair(&action));
+  ASSERT_TRUE(data_user.OnResolved(&err));
+
+  Target user(setup.settings(), Label(SourceDir("//"), "user"));
+  InitTargetWithType(setup, &user, Target::EXECUTABLE);
+  user.private_deps().push_back(LabelTargetPair(&action));
+  ASSERT_TRUE(user.OnResolved(&err));
+
+  RuntimeDepsCache cache;
+  for (const Target* target : {&data_user, &user, &data_user}) {
+    EXPECT_EQ(ComputeRuntimeDeps(target), cache.ComputeRuntimeDeps(target))
+        << target->label().name();
+  }
+  EXPECT_TRUE(base::ContainsValue(cache.ComputeRuntimeDeps(&data_user),
+                                  MakePair("../../action.output", &action)));
+  EXPECT_FALSE(base::ContainsValue(cache.ComputeRuntimeDeps(&user),
+                                   MakePair("../../action.output", &action)));
+}
+
 // Tests that actions can't have output substitutions.
 TEST_F(RuntimeDeps, WriteRuntimeDepsVariable) {
   TestWithScope setup;
@@ -5,9 +5,12 @@
 #include "gn/rust_project_writer.h"
 
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <tuple>
+#include <unordered_map>
 
 #include "base/json/string_escape.h"
 #include "base/strings/string_split.h"
@@ -19,6 +22,7 @@
 #include "gn/source_file.h"
 #include "gn/string_output_buffer.h"
 #include "gn/tool.h"
+#include "util/worker_pool.h"
 
 #if defined(OS_WINDOWS)
 #define NEWLINE "\r\n"
@@ -85,29 +89,6 @@ using TargetIndexMap = std::unordered_map<const Target*, uint32_t>;
 // A collection of Targets.
 using TargetsVector = UniqueVector<const Target*>;
 
-// Get the Rust deps for a target, recursively expanding OutputType::GROUPS
-// that are present in the GN structure.  This will return a flattened list of
-// deps from the groups, but will not expand a Rust lib dependency to find any
-// transitive Rust dependencies.
-void GetRustDeps(const Target* target, TargetsVector* rust_deps) {
-  for (const auto& pair : target->GetDeps(Target::DEPS_LINKED)) {
-    const Target* dep = pair.ptr;
-
-    if (dep->source_types_used().RustSourceUsed()) {
-      // Include any Rust dep.
-      rust_deps->push_back(dep);
-    } else if (dep->output_type() == Target::OutputType::GROUP) {
-      // Inspect (recursively) any group to see if it contains Rust deps.
-      GetRustDeps(dep, rust_deps);
-    }
-  }
-}
-TargetsVector GetRustDeps(const Target* target) {
-  TargetsVector deps;
-  GetRustDeps(target, &deps);
-  return deps;
-}
-
 std::vector<std::string> ExtractCompilerArgs(const Target* target) {
   std::vector<std::string> args;
   for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
@@ -162,55 +143,142 @@ std::vector<std::string> FindAllArgValuesAfterPrefix(
   return values;
 }
 
-void AddTarget(const BuildSettings* build_settings,
-               const Target* target,
+namespace {
+
+// Get the Rust deps for a target, recursively expanding OutputType::GROUPS
+// that are present in the GN structure.  This will return a flattened list of
+// deps from the groups, but will not expand a Rust lib dependency to find any
+// transitive Rust dependencies.
+//
+// The deps of each target and group are only computed once, as the same
+// groups are typically depended on by many crates. This class is not
+// threadsafe.
+class RustDepsCache {
+ public:
+  const TargetsVector& GetRustDeps(const Target* target) {
+    auto found = deps_.find(target);
+    if (found != deps_.end())
+      return found->second;
+
+    TargetsVector rust_deps;
+    for (const auto& pair : target->GetDeps(Target::DEPS_LINKED)) {
+      const Target* dep = pair.ptr;
+
+      if (dep->source_types_used().RustSourceUsed()) {
+        // Include any Rust dep.
+        rust_deps.push_back(dep);
+      } else if (dep->output_type() == Target::OutputType::GROUP) {
+        // Inspect (recursively) any group to see if it contains Rust deps.
+        for (const Target* group_dep : GetRustDeps(dep))
+          rust_deps.push_back(group_dep);
+      }
+    }
+    // References to the elements of an unordered_map stay valid when it
+    // grows.
+    return deps_.emplace(target, std::move(rust_deps)).first->second;
+  }
+
+ private:
+  std::unordered_map<const Target*, TargetsVector> deps_;
+};
+
+// The values rust-project.json uses from the compiler arguments of a crate.
+struct CompilerArgValues {
+  std::optional<std::string> compiler_target;
+  std::string edition;
+  ConfigList cfgs;
+};
+
+struct CompilerArgsHash {
+  size_t operator()(const std::vector<std::string>& args) const {
+    size_t hash = args.size();
+    for (const std::string& arg : args)
+      hash = hash * 31 + std::hash<std::string>()(arg);
+    return hash;
+  }
+};
+
+// Extracts the values from each distinct list of compiler arguments only
+// once, as the crates of a toolchain usually share most of their flags. This
+// class is threadsafe.
+class CompilerArgValuesCache {
+ public:
+  const CompilerArgValues& Get(const std::vector<std::string>& args) {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      auto found = values_.find(args);
+      if (found != values_.end())
+        return *found->second;
+    }
+
+    auto values = std::make_unique<CompilerArgValues>();
+    values->compiler_target = FindArgValue("--target", args);
+    std::optional<std::string> edition =
+        FindArgValueAfterPrefix(std::string("--edition="), args);
+    if (!edition.has_value())
+      edition = FindArgValue("--edition", args);
+    values->edition = edition.value_or("2015");
+    values->cfgs = FindAllArgValuesAfterPrefix(std::string("--cfg="), args);
+
+    // Another thread may have extracted the same values in the meantime, in
+    // which case the first ones are kept.
+    std::lock_guard<std::mutex> lock(lock_);
+    return *values_.emplace(args, std::move(values)).first->second;
+  }
+
+ private:
+  std::mutex lock_;
+  std::unordered_map<std::vector<std::string>,
+                     std::unique_ptr<CompilerArgValues>,
+                     CompilerArgsHash>
+      values_;
+};
+
+// Assigns crate indices to the target and its Rust deps, the deps first,
+// by appending them to |crate_targets|.
+void AddTarget(const Target* target,
+               RustDepsCache& rust_deps,
                TargetIndexMap& lookup,
-               CrateList& crate_list) {
+               std::vector<const Target*>& crate_targets) {
   if (lookup.find(target) != lookup.end()) {
     // If target is already in the lookup, we don't add it again.
     return;
   }
 
-  auto compiler_args = ExtractCompilerArgs(target);
-  auto compiler_target = FindArgValue("--target", compiler_args);
-  auto crate_deps = GetRustDeps(target);
-
   // Add all dependencies of this crate, before this crate.
-  for (const auto& dep : crate_deps) {
-    AddTarget(build_settings, dep, lookup, crate_list);
-  }
+  for (const auto* dep : rust_deps.GetRustDeps(target))
+    AddTarget(dep, rust_deps, lookup, crate_targets);
 
   // The index of a crate is its position (0-based) in the list of crates.
-  size_t crate_id = crate_list.size();
+  lookup.insert(std::make_pair(target, crate_targets.size()));
+  crate_targets.push_back(target);
+}
 
-  // Add the target to the crate lookup.
-  lookup.insert(std::make_pair(target, crate_id));
+Crate MakeCrate(const BuildSettings* build_settings,
+                const Target* target,
+                CrateIndex crate_id,
+                const TargetsVector& crate_deps,
+                const TargetIndexMap& lookup,
+                CompilerArgValuesCache& arg_values_cache) {
+  auto compiler_args = ExtractCompilerArgs(target);
+  const CompilerArgValues& arg_values = arg_values_cache.Get(compiler_args);
 
   SourceFile crate_root = target->rust_values().crate_root();
   std::string crate_label = target->label().GetUserVisibleName(false);
 
-  auto edition =
-      FindArgValueAfterPrefix(std::string("--edition="), compiler_args);
-  if (!edition.has_value()) {
-    edition = FindArgValue("--edition", compiler_args);
-  }
-
   auto gen_dir = GetBuildDirForTargetAsOutputFile(target, BuildDirType::GEN);
 
   Crate crate = Crate(crate_root, gen_dir, crate_id, crate_label,
-                      edition.value_or("2015"));
-
-  crate.SetCompilerArgs(compiler_args);
-  if (compiler_target.has_value())
-    crate.SetCompilerTarget(compiler_target.value());
+                      arg_values.edition);
 
-  ConfigList cfgs =
-      FindAllArgValuesAfterPrefix(std::string("--cfg="), compiler_args);
+  crate.SetCompilerArgs(std::move(compiler_args));
+  if (arg_values.compiler_target.has_value())
+    crate.SetCompilerTarget(arg_values.compiler_target.value());
 
   crate.AddConfigItem("test");
   crate.AddConfigItem("debug_assertions");
 
-  for (auto& cfg : cfgs) {
+  for (auto& cfg : arg_values.cfgs) {
     crate.AddConfigItem(cfg);
   }
 
@@ -238,13 +306,132 @@ void AddTarget(const BuildSettings* build_settings,
 
   // Add the rest of the crate dependencies.
   for (const auto& dep : crate_deps) {
-    auto idx = lookup[dep];
+    auto idx = lookup.find(dep)->second;
     crate.AddDependency(idx, dep->rust_values().crate_name());
   }
 
-  crate_list.push_back(crate);
+  return crate;
 }
 
+// Writes the JSON object of one crate, preceded by a newline.
+void WriteCrate(const BuildSettings* build_settings,
+                Crate& crate,
+                std::ostream& rust_project) {
+  auto crate_module = FilePathToUTF8(build_settings->GetFullPath(crate.root()));
+
+  rust_project << NEWLINE << "    {" NEWLINE
+               << "      \"crate_id\": " << crate.index() << "," NEWLINE
+               << "      \"root_module\": \"" << crate_module << "\"," NEWLINE
+               << "      \"label\": \"" << crate.label() << "\"," NEWLINE
+               << "      \"source\": {" NEWLINE
+               << "          \"include_dirs\": [" NEWLINE
+               << "               \""
+               << FilePathToUTF8(
+                      build_settings->GetFullPath(crate.root().GetDir()))
+               << "\"";
+  auto gen_dir = crate.gen_dir();
+  if (gen_dir.has_value()) {
+    auto gen_dir_path = FilePathToUTF8(
+        build_settings->GetFullPath(gen_dir->AsSourceDir(build_settings)));
+    rust_project << "," NEWLINE << "               \"" << gen_dir_path
+                 << "\"" NEWLINE;
+  } else {
+    rust_project << NEWLINE;
+  }
+  rust_project << "          ]," NEWLINE
+               << "          \"exclude_dirs\": []" NEWLINE
+               << "      }," NEWLINE;
+
+  auto compiler_target = crate.CompilerTarget();
+  if (compiler_target.has_value()) {
+    rust_project << "      \"target\": \"" << compiler_target.value()
+                 << "\"," NEWLINE;
+  }
+
+  const auto& compiler_args = crate.CompilerArgs();
+  if (!compiler_args.empty()) {
+    rust_project << "      \"compiler_args\": [";
+    bool first_arg = true;
+    for (auto& arg : compiler_args) {
+      if (!first_arg)
+        rust_project << ", ";
+      first_arg = false;
+
+      std::string escaped_arg;
+      base::EscapeJSONString(arg, false, &escaped_arg);
+
+      rust_project << "\"" << escaped_arg << "\"";
+    }
+    rust_project << "]," << NEWLINE;
+  }
+
+  rust_project << "      \"deps\": [";
+  bool first_dep = true;
+  for (auto& dep : crate.dependencies()) {
+    if (!first_dep)
+      rust_project << ",";
+    first_dep = false;
+
+    rust_project << NEWLINE << "        {" NEWLINE
+                 << "          \"crate\": " << dep.first << "," NEWLINE
+                 << "          \"name\": \"" << dep.second << "\"" NEWLINE
+                 << "        }";
+  }
+  rust_project << NEWLINE "      ]," NEWLINE;  // end dep list
+
+  rust_project << "      \"edition\": \"" << crate.edition() << "\"," NEWLINE;
+
+  auto proc_macro_target = crate.proc_macro_path();
+  if (proc_macro_target.has_value()) {
+    rust_project << "      \"is_proc_macro\": true," NEWLINE;
+    auto so_location = FilePathToUTF8(build_settings->GetFullPath(
+        proc_macro_target->AsSourceFile(build_settings)));
+    rust_project << "      \"proc_macro_dylib_path\": \"" << so_location
+                 << "\"," NEWLINE;
+  }
+
+  rust_project << "      \"cfg\": [";
+  bool first_cfg = true;
+  for (const auto& cfg : crate.configs()) {
+    if (!first_cfg)
+      rust_project << ",";
+    first_cfg = false;
+
+    std::string escaped_config;
+    base::EscapeJSONString(cfg, false, &escaped_config);
+
+    rust_project << NEWLINE;
+    rust_project << "        \"" << escaped_config << "\"";
+  }
+  rust_project << NEWLINE;
+  rust_project << "      ]";  // end cfgs
+
+  if (!crate.rustenv().empty()) {
+    rust_project << "," NEWLINE;
+    rust_project << "      \"env\": {";
+    bool first_env = true;
+    for (const auto& env : crate.rustenv()) {
+      if (!first_env)
+        rust_project << ",";
+      first_env = false;
+      std::string escaped_key, escaped_val;
+      base::EscapeJSONString(env.first, false, &escaped_key);
+      base::EscapeJSONString(env.second, false, &escaped_val);
+      rust_project << NEWLINE;
+      rust_project << "        \"" << escaped_key << "\": \"" << escaped_val
+                   << "\"";
+    }
+
+    rust_project << NEWLINE;
+    rust_project << "      }" NEWLINE;  // end env vars
+  } else {
+    rust_project << NEWLINE;
+  }
+  rust_project << "    }";  // end crate
+}
+
+}  // namespace
+
 void WriteCrates(const BuildSettings* build_settings,
                  CrateList& crate_list,
                  std::optional<std::string>& sysroot,
@@ -265,124 +452,25 @@ void WriteCrates(const BuildSettings* build_settings,
   }
 
   rust_project << "  \"crates\": [";
+
+  // The crates are written in parallel, then concatenated in order.
+  std::vector<std::string> rendered_crates(crate_list.size());
+  ParallelFor(crate_list.size(), [build_settings, &crate_list,
+                                  &rendered_crates](size_t, size_t begin,
+                                                    size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      std::ostringstream out;
+      WriteCrate(build_settings, crate_list[i], out);
+      rendered_crates[i] = out.str();
+    }
+  });
+
   bool first_crate = true;
-  for (auto& crate : crate_list) {
+  for (const std::string& rendered_crate : rendered_crates) {
     if (!first_crate)
       rust_project << ",";
     first_crate = false;
-
-    auto crate_module =
-        FilePathToUTF8(build_settings->GetFullPath(crate.root()));
-
-    rust_project << NEWLINE << "    {" NEWLINE
-                 << "      \"crate_id\": " << crate.index() << "," NEWLINE
-                 << "      \"root_module\": \"" << crate_module << "\"," NEWLINE
-                 << "      \"label\": \"" << crate.label() << "\"," NEWLINE
-                 << "      \"source\": {" NEWLINE
-                 << "          \"include_dirs\": [" NEWLINE
-                 << "               \""
-                 << FilePathToUTF8(
-                        build_settings->GetFullPath(crate.root().GetDir()))
-                 << "\"";
-    auto gen_dir = crate.gen_dir();
-    if (gen_dir.has_value()) {
-      auto gen_dir_path = FilePathToUTF8(
-          build_settings->GetFullPath(gen_dir->AsSourceDir(build_settings)));
-      rust_project << "," NEWLINE << "               \"" << gen_dir_path
-                   << "\"" NEWLINE;
-    } else {
-      rust_project << NEWLINE;
-    }
-    rust_project << "          ]," NEWLINE
-                 << "          \"exclude_dirs\": []" NEWLINE
-                 << "      }," NEWLINE;
-
-    auto compiler_target = crate.CompilerTarget();
-    if (compiler_target.has_value()) {
-      rust_project << "      \"target\": \"" << compiler_target.value()
-                   << "\"," NEWLINE;
-    }
-
-    auto compiler_args = crate.CompilerArgs();
-    if (!compiler_args.empty()) {
-      rust_project << "      \"compiler_args\": [";
-      bool first_arg = true;
-      for (auto& arg : crate.CompilerArgs()) {
-        if (!first_arg)
-          rust_project << ", ";
-        first_arg = false;
-
-        std::string escaped_arg;
-        base::EscapeJSONString(arg, false, &escaped_arg);
-
-        rust_project << "\"" << escaped_arg << "\"";
-      }
-      rust_project << "]," << NEWLINE;
-    }
-
-    rust_project << "      \"deps\": [";
-    bool first_dep = true;
-    for (auto& dep : crate.dependencies()) {
-      if (!first_dep)
-        rust_project << ",";
-      first_dep = false;
-
-      rust_project << NEWLINE << "        {" NEWLINE
-                   << "          \"crate\": " << dep.first << "," NEWLINE
-                   << "          \"name\": \"" << dep.second << "\"" NEWLINE
-                   << "        }";
-    }
-    rust_project << NEWLINE "      ]," NEWLINE;  // end dep list
-
-    rust_project << "      \"edition\": \"" << crate.edition() << "\"," NEWLINE;
-
-    auto proc_macro_target = crate.proc_macro_path();
-    if (proc_macro_target.has_value()) {
-      rust_project << "      \"is_proc_macro\": true," NEWLINE;
-      auto so_location = FilePathToUTF8(build_settings->GetFullPath(
-          proc_macro_target->AsSourceFile(build_settings)));
-      rust_project << "      \"proc_macro_dylib_path\": \"" << so_location
-                   << "\"," NEWLINE;
-    }
-
-    rust_project << "      \"cfg\": [";
-    bool first_cfg = true;
-    for (const auto& cfg : crate.configs()) {
-      if (!first_cfg)
-        rust_project << ",";
-      first_cfg = false;
-
-      std::string escaped_config;
-      base::EscapeJSONString(cfg, false, &escaped_config);
-
-      rust_project << NEWLINE;
-      rust_project << "        \"" << escaped_config << "\"";
-    }
-    rust_project << NEWLINE;
-    rust_project << "      ]";  // end cfgs
-
-    if (!crate.rustenv().empty()) {
-      rust_project << "," NEWLINE;
-      rust_project << "      \"env\": {";
-      bool first_env = true;
-      for (const auto& env : crate.rustenv()) {
-        if (!first_env)
-          rust_project << ",";
-        first_env = false;
-        std::string escaped_key, escaped_val;
-        base::EscapeJSONString(env.first, false, &escaped_key);
-        base::EscapeJSONString(env.second, false, &escaped_val);
-        rust_project << NEWLINE;
-        rust_project << "        \"" << escaped_key << "\": \"" << escaped_val
-                     << "\"";
-      }
-
-      rust_project << NEWLINE;
-      rust_project << "      }" NEWLINE;  // end env vars
-    } else {
-      rust_project << NEWLINE;
-    }
-    rust_project << "    }";  // end crate
+    rust_project << rendered_crate;
   }
   rust_project << NEWLINE "  ]" NEWLINE;  // end crate list
   rust_project << "}" NEWLINE;
@@ -392,15 +480,17 @@ void RustProjectWriter::RenderJSON(const BuildSettings* build_settings,
                                    std::vector<const Target*>& all_targets,
                                    std::ostream& rust_project) {
   TargetIndexMap lookup;
-  CrateList crate_list;
+  RustDepsCache rust_deps;
+  std::vector<const Target*> crate_targets;
   std::optional<std::string> rust_sysroot;
 
-  // All the crates defined in the project.
+  // All the crates defined in the project. Their indices only depend on the
+  // order of the targets, so that the output is stable.
   for (const auto* target : all_targets) {
     if (!target->IsBinary() || !target->source_types_used().RustSourceUsed())
       continue;
 
-    AddTarget(build_settings, target, lookup, crate_list);
+    AddTarget(target, rust_deps, lookup, crate_targets);
 
     // If a sysroot hasn't been found, see if we can find one using this target.
     if (!rust_sysroot.has_value()) {
@@ -412,5 +502,28 @@ void RustProjectWriter::RenderJSON(const BuildSettings* build_settings,
     }
   }
 
+  // The deps of all the crates were computed while assigning the indices, so
+  // the crates can be built in parallel.
+  std::vector<const TargetsVector*> crate_deps;
+  crate_deps.reserve(crate_targets.size());
+  for (const Target* target : crate_targets)
+    crate_deps.push_back(&rust_deps.GetRustDeps(target));
+
+  std::vector<std::optional<Crate>> crates(crate_targets.size());
+  {
+    CompilerArgValuesCache arg_values_cache;
+    ParallelFor(crate_targets.size(), [&](size_t, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        crates[i].emplace(MakeCrate(build_settings, crate_targets[i], i,
+                                    *crate_deps[i], lookup, arg_values_cache));
+      }
+    });
+  }
+
+  CrateList crate_list;
+  crate_list.reserve(crates.size());
+  for (auto& crate : crates)
+    crate_list.push_back(std::move(*crate));
+
   WriteCrates(build_settings, crate_list, rust_sysroot, rust_project);
 }
@@ -3,7 +3,11 @@
 // found in the LICENSE file.
 
 #include "gn/rust_project_writer.h"
+
+#include <memory>
+
 #include "base/files/file_path.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "gn/filesystem_utils.h"
 #include "gn/substitution_list.h"
@@ -653,3 +657,79 @@ TEST_F(RustProjectJSONWriter, OneRustProcMacroTarget) {
 
   ExpectEqOrShowDiff(expected_json, out);
 }
+
+TEST_F(RustProjectJSONWriter, ManyCratesSharingDeps) {
+  Err err;
+  TestWithScope setup;
+  setup.build_settings()->SetRootPath(UTF8ToFilePath("path"));
+
+  Target lib(setup.settings(), Label(SourceDir("//lib/"), "lib"));
+  lib.set_output_type(Target::RUST_LIBRARY);
+  lib.visibility().SetPublic();
+  SourceFile lib_root("//lib/lib.rs");
+  lib.sources().push_back(lib_root);
+  lib.source_types_used().Set(SourceFile::SOURCE_RS);
+  lib.rust_values().set_crate_root(lib_root);
+  lib.rust_values().crate_name() = "lib";
+  lib.SetToolchain(setup.toolchain());
+  ASSERT_TRUE(lib.OnResolved(&err));
+
+  Target group(setup.settings(), Label(SourceDir("//lib/"), "group"));
+  group.set_output_type(Target::GROUP);
+  group.visibility().SetPublic();
+  group.public_deps().push_back(LabelTargetPair(&lib));
+  group.SetToolchain(setup.toolchain());
+  ASSERT_TRUE(group.OnResolved(&err));
+
+  // Enough crates to be built and written by several tasks, all sharing the
+  // same flags and deps.
+  constexpr size_t kCrateCount = 200;
+  std::vector<std::unique_ptr<Target>> crates;
+  std::vector<const Target*> targets;
+  for (size_t i = 0; i < kCrateCount; i++) {
+    std::string dir = "//crate" + base::NumberToString(i) + "/";
+    auto target = std::make_unique<Target>(setup.settings(),
+                                           Label(SourceDir(dir), "bar"));
+    target->set_output_type(Target::RUST_LIBRARY);
+    SourceFile root(dir + "lib.rs");
+    target->sources().push_back(root);
+    target->source_types_used().Set(SourceFile::SOURCE_RS);
+    target->rust_values().set_crate_root(root);
+    target->rust_values().crate_name() = "bar";
+    target->config_values().rustflags().push_back("--edition=2021");
+    target->private_deps().push_back(LabelTargetPair(&group));
+    target->SetToolchain(setup.toolchain());
+    ASSERT_TRUE(target->OnResolved(&err));
+    targets.push_back(target.get());
+    crates.push_back(std::move(target));
+  }
+
+  std::ostringstream stream;
+  RustProjectWriter::RenderJSON(setup.build_settings(), targets, stream);
+  std::string out = stream.str();
+#if defined(OS_WIN)
+  base::ReplaceSubstringsAfterOffset(&out, 0, "\r\n", "\n");
+#endif
+
+  // The shared dep comes first, then the crates in order.
+  size_t pos = out.find("\"crate_id\": 0,\n");
+  ASSERT_NE(std::string::npos, pos);
+  EXPECT_EQ(pos + 15,
+            out.find("      \"root_module\": \"path/lib/lib.rs\"", pos));
+  for (size_t i = 0; i < kCrateCount; i++) {
+    std::string crate = "\"crate_id\": " + base::NumberToString(i + 1) +
+                        ",\n      \"root_module\": \"path/crate" +
+                        base::NumberToString(i) + "/lib.rs\"";
+    size_t next = out.find(crate, pos);
+    ASSERT_NE(std::string::npos, next) << crate;
+    pos = next;
+
+    size_t deps = out.find(
+        "\"deps\": [\n        {\n          \"crate\": 0,\n"
+        "          \"name\": \"lib\"\n        }\n      ],\n"
+        "      \"edition\": \"2021\"",
+        pos);
+    ASSERT_NE(std::string::npos, deps);
+    EXPECT_LT(deps, out.find("crate_id", pos + crate.size()));
+  }
+}
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "gn/metadata_walk.h"
 #include "gn/standard_out.h"
 #include "gn/target.h"
 
@@ -15,7 +16,8 @@ Scheduler* g_scheduler = nullptr;
 
 Scheduler::Scheduler()
     : main_thread_run_loop_(MsgLoop::Current()),
-      input_file_manager_(new InputFileManager) {
+      input_file_manager_(new InputFileManager),
+      metadata_walk_cache_(std::make_unique<MetadataWalkCache>()) {
   g_scheduler = this;
 }
 
@@ -78,6 +80,16 @@ std::vector<base::FilePath> Scheduler::GetGenDependencies() const {
   return gen_dependencies_;
 }
 
+void Scheduler::AddExecScriptResult(std::string result) {
+  std::lock_guard<std::mutex> lock(lock_);
+  exec_script_results_.push_back(std::move(result));
+}
+
+std::vector<std::string> Scheduler::GetExecScriptResults() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return exec_script_results_;
+}
+
 void Scheduler::AddWrittenFile(const SourceFile& file) {
   std::lock_guard<std::mutex> lock(lock_);
   written_files_.push_back(file);
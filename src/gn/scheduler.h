@@ -8,6 +8,7 @@
 #include <condition_variable>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 
 #include "base/atomic_ref_count.h"
@@ -19,6 +20,7 @@
 #include "util/msg_loop.h"
 #include "util/worker_pool.h"
 
+class MetadataWalkCache;
 class Target;
 
 // Maintains the thread pool and error state.
@@ -36,6 +38,11 @@ class Scheduler {
 
   InputFileManager* input_file_manager() { return input_file_manager_.get(); }
 
+  // Shared by the generated_file targets collecting metadata.
+  MetadataWalkCache* metadata_walk_cache() {
+    return metadata_walk_cache_.get();
+  }
+
   bool verbose_logging() const { return verbose_logging_; }
   void set_verbose_logging(bool v) { verbose_logging_ = v; }
 
@@ -60,6 +67,12 @@ class Scheduler {
   void AddGenDependency(const base::FilePath& file);
   std::vector<base::FilePath> GetGenDependencies() const;
 
+  // Records the command line and the output of a successful exec_script()
+  // call. Scripts may depend on more than the files they declare, so the
+  // writers caching what they generate across runs depend on the results.
+  void AddExecScriptResult(std::string result);
+  std::vector<std::string> GetExecScriptResults() const;
+
   // Tracks calls to write_file for resolving with the unknown generated
   // inputs (see AddUnknownGeneratedInput below).
   void AddWrittenFile(const SourceFile& file);
@@ -114,6 +127,8 @@ class Scheduler {
 
   scoped_refptr<InputFileManager> input_file_manager_;
 
+  std::unique_ptr<MetadataWalkCache> metadata_walk_cache_;
+
   bool verbose_logging_ = false;
 
   base::AtomicRefCount work_count_;
@@ -142,6 +157,7 @@ class Scheduler {
 
   // Protected by the lock. See the corresponding Add/Get functions above.
   std::vector<base::FilePath> gen_dependencies_;
+  std::vector<std::string> exec_script_results_;
   std::vector<SourceFile> written_files_;
   std::vector<const Target*> write_runtime_deps_targets_;
   std::multimap<SourceFile, const Target*> unknown_generated_inputs_;
@@ -93,6 +93,12 @@ bool StringOutputBuffer::WriteToFile(const base::FilePath& file_path,
     return false;
   }
 
+  return WriteToFileInExistingDirectory(file_path, err);
+}
+
+bool StringOutputBuffer::WriteToFileInExistingDirectory(
+    const base::FilePath& file_path,
+    Err* err) const {
   size_t data_size = size();
   size_t page_count = pages_.size();
 
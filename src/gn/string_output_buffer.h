@@ -50,6 +50,10 @@ class StringOutputBuffer : public std::streambuf {
   // Return the number of characters stored in this instance.
   size_t size() const { return (pages_.size() - 1u) * kPageSize + pos_; }
 
+  // Return the number of pages used by this instance. Each page is read or
+  // written with a single call by ContentsEqual() and WriteToFile().
+  size_t page_count() const { return pages_.size(); }
+
   // Append string to this instance.
   void Append(const char* str, size_t len);
   void Append(std::string_view str);
@@ -66,6 +70,11 @@ class StringOutputBuffer : public std::streambuf {
   // Write the contents of this instance to a file at |file_path|.
   bool WriteToFile(const base::FilePath& file_path, Err* err) const;
 
+  // Same as WriteToFile(), but assumes the parent directory of |file_path|
+  // already exists.
+  bool WriteToFileInExistingDirectory(const base::FilePath& file_path,
+                                      Err* err) const;
+
   // Write the contents of this instance to a file at |file_path| unless the
   // file already exists and the contents are equal.
   bool WriteToFileIfChanged(const base::FilePath& file_path, Err* err) const;
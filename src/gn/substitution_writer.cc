@@ -585,3 +585,67 @@ std::string SubstitutionWriter::GetLinkerSubstitution(
     return std::string();
   }
 }
+
+CompiledSubstitutionList::CompiledSubstitutionList(const Target* target,
+                                                   const SubstitutionList& list)
+    : target_(target) {
+  programs_.reserve(list.list().size());
+  for (const auto& pattern : list.list()) {
+    Program& program = programs_.emplace_back();
+    std::string subst;
+    for (const auto& subrange : pattern.ranges()) {
+      const std::string* literal = &subrange.literal;
+      if (subrange.type != &SubstitutionLiteral) {
+        subst.clear();
+        if (!SubstitutionWriter::GetTargetSubstitution(target, subrange.type,
+                                                       &subst)) {
+          // Depends on the source file.
+          Op& op = program.emplace_back();
+          op.type = subrange.type;
+          continue;
+        }
+        literal = &subst;
+      }
+      if (program.empty() || program.back().type)
+        program.emplace_back();
+      program.back().literal.append(*literal);
+    }
+  }
+}
+
+CompiledSubstitutionList::~CompiledSubstitutionList() = default;
+
+void CompiledSubstitutionList::ApplyToSource(
+    const SourceFile& source,
+    std::vector<OutputFile>* output) const {
+  const Settings* settings = target_->settings();
+  const SourceDir& build_dir = settings->build_settings()->build_dir();
+  for (const Program& program : programs_) {
+    OutputFile& result = output->emplace_back();
+    for (const Op& op : program) {
+      if (!op.type) {
+        result.value().append(op.literal);
+      } else {
+        result.value().append(SubstitutionWriter::GetSourceSubstitution(
+            target_, settings, source, op.type,
+            SubstitutionWriter::OUTPUT_RELATIVE, build_dir));
+      }
+    }
+  }
+}
+
+CompiledSubstitutionList::Cache::Cache(const Target* target)
+    : target_(target) {}
+
+CompiledSubstitutionList::Cache::~Cache() = default;
+
+const CompiledSubstitutionList& CompiledSubstitutionList::Cache::Get(
+    const SubstitutionList& list) {
+  for (const auto& entry : entries_) {
+    if (entry.first == &list)
+      return *entry.second;
+  }
+  entries_.emplace_back(
+      &list, std::make_unique<CompiledSubstitutionList>(target_, list));
+  return *entries_.back().second;
+}
@@ -6,7 +6,9 @@
 #define TOOLS_GN_SUBSTITUTION_WRITER_H_
 
 #include <iosfwd>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gn/substitution_type.h"
@@ -235,4 +237,55 @@ class SubstitutionWriter {
                                            const Substitution* type);
 };
 
+// A compiler outputs SubstitutionList compiled for a given target.
+//
+// ApplyListToCompilerAsOutputFile() has to interpret every range of every
+// pattern, and dispatch on its substitution type, for each source file of a
+// target. Since only the source substitutions depend on the source file,
+// this class expands the literal and target substitution ranges once, merging
+// adjacent ones into single literal ops. Applying the result to a source file
+// then only expands the source-dependent ops, producing the same output as
+// ApplyListToCompilerAsOutputFile().
+class CompiledSubstitutionList {
+ public:
+  CompiledSubstitutionList(const Target* target, const SubstitutionList& list);
+  ~CompiledSubstitutionList();
+
+  // Applies the compiled list to a source, APPENDING the results to the given
+  // output vector.
+  void ApplyToSource(const SourceFile& source,
+                     std::vector<OutputFile>* output) const;
+
+  // A set of compiled lists for a single target, keyed by the tool list they
+  // were compiled from. Targets only use a handful of tools, so this uses a
+  // linear search.
+  class Cache {
+   public:
+    explicit Cache(const Target* target);
+    ~Cache();
+
+    const CompiledSubstitutionList& Get(const SubstitutionList& list);
+
+   private:
+    const Target* target_;
+    std::vector<std::pair<const SubstitutionList*,
+                          std::unique_ptr<CompiledSubstitutionList>>>
+        entries_;
+
+    Cache(const Cache&) = delete;
+    Cache& operator=(const Cache&) = delete;
+  };
+
+ private:
+  // A literal op has a null |type|.
+  struct Op {
+    const Substitution* type = nullptr;
+    std::string literal;
+  };
+  using Program = std::vector<Op>;
+
+  const Target* target_;
+  std::vector<Program> programs_;
+};
+
 #endif  // TOOLS_GN_SUBSTITUTION_WRITER_H_
@@ -249,6 +249,44 @@ TEST(SubstitutionWriter, CompilerSubstitutions) {
                                &SubstitutionTargetGenDir));
 }
 
+TEST(SubstitutionWriter, CompiledSubstitutionList) {
+  TestWithScope setup;
+  Err err;
+
+  Target target(setup.settings(), Label(SourceDir("//foo/bar/"), "baz"));
+  target.set_output_type(Target::STATIC_LIBRARY);
+  target.SetToolchain(setup.toolchain());
+  ASSERT_TRUE(target.OnResolved(&err));
+
+  SubstitutionList list;
+  ASSERT_TRUE(list.Parse(
+      {"{{target_out_dir}}/{{label_name}}/{{source_name_part}}.o",
+       "{{source_gen_dir}}/{{source_file_part}}.d", "{{root_out_dir}}/x"},
+      nullptr, &err));
+
+  CompiledSubstitutionList::Cache cache(&target);
+  const CompiledSubstitutionList& compiled = cache.Get(list);
+  EXPECT_EQ(&compiled, &cache.Get(list));
+
+  // The compiled list must match the interpreted one for every source.
+  for (const char* source_name : {"//foo/bar/file.cc", "//foo/baz/other.c"}) {
+    SourceFile source(source_name);
+    std::vector<OutputFile> expected;
+    SubstitutionWriter::ApplyListToCompilerAsOutputFile(&target, source, list,
+                                                        &expected);
+    std::vector<OutputFile> actual;
+    compiled.ApplyToSource(source, &actual);
+    EXPECT_EQ(expected, actual);
+  }
+
+  std::vector<OutputFile> outputs;
+  compiled.ApplyToSource(SourceFile("//foo/bar/file.cc"), &outputs);
+  ASSERT_EQ(3u, outputs.size());
+  EXPECT_EQ("obj/foo/bar/baz/file.o", outputs[0].value());
+  EXPECT_EQ("gen/foo/bar/file.cc.d", outputs[1].value());
+  EXPECT_EQ("./x", outputs[2].value());
+}
+
 TEST(SubstitutionWriter, LinkerSubstitutions) {
   TestWithScope setup;
   Err err;
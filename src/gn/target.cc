@@ -98,9 +98,11 @@ bool EnsureFileIsGeneratedByDependency(const Target* target,
   // Check binary target intermediate files if requested.
   if (consider_object_files && target->IsBinary()) {
     std::vector<OutputFile> source_outputs;
+    CompiledSubstitutionList::Cache compiled_lists(target);
     for (const SourceFile& source : target->sources()) {
       const char* tool_name;
-      if (!target->GetOutputFilesForSource(source, &tool_name, &source_outputs))
+      if (!target->GetOutputFilesForSource(source, &tool_name, &source_outputs,
+                                           &compiled_lists))
         continue;
       if (base::ContainsValue(source_outputs, file))
         return true;
@@ -670,9 +672,11 @@ bool Target::GetOutputsAsSourceFiles(const LocationRange& loc_for_error,
   return true;
 }
 
-bool Target::GetOutputFilesForSource(const SourceFile& source,
-                                     const char** computed_tool_type,
-                                     std::vector<OutputFile>* outputs) const {
+bool Target::GetOutputFilesForSource(
+    const SourceFile& source,
+    const char** computed_tool_type,
+    std::vector<OutputFile>* outputs,
+    CompiledSubstitutionList::Cache* compiled_lists) const {
   DCHECK(toolchain());  // Should be resolved before calling.
 
   outputs->clear();
@@ -731,8 +735,12 @@ bool Target::GetOutputFilesForSource(const SourceFile& source,
                                               : tool->outputs();
 
     // Figure out what output(s) this compiler produces.
-    SubstitutionWriter::ApplyListToCompilerAsOutputFile(
-        this, source, substitution_list, outputs);
+    if (compiled_lists) {
+      compiled_lists->Get(substitution_list).ApplyToSource(source, outputs);
+    } else {
+      SubstitutionWriter::ApplyListToCompilerAsOutputFile(
+          this, source, substitution_list, outputs);
+    }
   }
   return !outputs->empty();
 }
@@ -1165,8 +1173,33 @@ bool Target::GetMetadata(const std::vector<std::string>& keys_to_extract,
                          std::vector<Value>* result,
                          TargetSet* targets_walked,
                          Err* err) const {
-  std::vector<Value> next_walk_keys;
   std::vector<Value> current_result;
+  std::vector<const Target*> next_targets;
+  bool ok = GetMetadataStep(keys_to_extract, keys_to_walk, rebase_dir,
+                            deps_only, &current_result, &next_targets, err);
+  for (const Target* next : next_targets) {
+    // If we haven't walked this dep yet, go down into it.
+    if (targets_walked->add(next)) {
+      if (!next->GetMetadata(keys_to_extract, keys_to_walk, rebase_dir, false,
+                             result, targets_walked, err))
+        return false;
+    }
+  }
+  if (!ok)
+    return false;
+  result->insert(result->end(), std::make_move_iterator(current_result.begin()),
+                 std::make_move_iterator(current_result.end()));
+  return true;
+}
+
+bool Target::GetMetadataStep(const std::vector<std::string>& keys_to_extract,
+                             const std::vector<std::string>& keys_to_walk,
+                             const SourceDir& rebase_dir,
+                             bool deps_only,
+                             std::vector<Value>* values,
+                             std::vector<const Target*>* next_targets,
+                             Err* err) const {
+  std::vector<Value> next_walk_keys;
   // If deps_only, this is the top-level target and thus we don't want to
   // collect its metadata, only that of its deps and data_deps.
   if (deps_only) {
@@ -1180,8 +1213,8 @@ bool Target::GetMetadata(const std::vector<std::string>& keys_to_extract,
     // because WalkStep() will append to 'next_walk_keys' in this case.
     // See https://crbug.com/1273069.
     if (!metadata().WalkStep(settings()->build_settings(), keys_to_extract,
-                             keys_to_walk, rebase_dir, &next_walk_keys,
-                             &current_result, err))
+                             keys_to_walk, rebase_dir, &next_walk_keys, values,
+                             err))
       return false;
   }
 
@@ -1197,14 +1230,8 @@ bool Target::GetMetadata(const std::vector<std::string>& keys_to_extract,
     // from each explicitly listed dep prior to this, followed by all data in
     // walk order of the remaining deps.
     if (next.string_value().empty()) {
-      for (const auto& dep : all_deps) {
-        // If we haven't walked this dep yet, go down into it.
-        if (targets_walked->add(dep.ptr)) {
-          if (!dep.ptr->GetMetadata(keys_to_extract, keys_to_walk, rebase_dir,
-                                    false, result, targets_walked, err))
-            return false;
-        }
-      }
+      for (const auto& dep : all_deps)
+        next_targets->push_back(dep.ptr);
 
       // Any other walk keys are superfluous, as they can only be a subset of
       // all deps.
@@ -1226,19 +1253,14 @@ bool Target::GetMetadata(const std::vector<std::string>& keys_to_extract,
     for (const auto& dep : all_deps) {
       // Match against the label with the toolchain.
       if (dep.label.GetUserVisibleName(true) == canonicalize_next_label) {
-        // If we haven't walked this dep yet, go down into it.
-        if (targets_walked->add(dep.ptr)) {
-          if (!dep.ptr->GetMetadata(keys_to_extract, keys_to_walk, rebase_dir,
-                                    false, result, targets_walked, err))
-            return false;
-        }
+        next_targets->push_back(dep.ptr);
         // We found it, so we can exit this search now.
         found_next = true;
         break;
       }
     }
     // If we didn't find the specified dep in the target, that's an error.
-    // Propagate it back to the user.
+    // Propagate it back to the user once the deps found so far are walked.
     if (!found_next) {
       *err = Err(next.origin(),
                  std::string("I was expecting ") + canonicalize_next_label +
@@ -1249,7 +1271,5 @@ bool Target::GetMetadata(const std::vector<std::string>& keys_to_extract,
       return false;
     }
   }
-  result->insert(result->end(), std::make_move_iterator(current_result.begin()),
-                 std::make_move_iterator(current_result.end()));
   return true;
 }
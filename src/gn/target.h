@@ -22,6 +22,7 @@
 #include "gn/pointer_set.h"
 #include "gn/rust_values.h"
 #include "gn/source_file.h"
+#include "gn/substitution_writer.h"
 #include "gn/swift_values.h"
 #include "gn/toolchain.h"
 #include "gn/unique_vector.h"
@@ -180,6 +181,18 @@ class Target : public Item {
                    TargetSet* targets_walked,
                    Err* err) const;
 
+  // Computes what this target alone contributes to a metadata walk: the
+  // values it collects are appended to |values| and the deps to walk next,
+  // in walk order, to |next_targets|. On failure, |next_targets| holds the
+  // deps that must still be walked before the error is reported.
+  bool GetMetadataStep(const std::vector<std::string>& keys_to_extract,
+                       const std::vector<std::string>& keys_to_walk,
+                       const SourceDir& rebase_dir,
+                       bool deps_only,
+                       std::vector<Value>* values,
+                       std::vector<const Target*>* next_targets,
+                       Err* err) const;
+
   // GeneratedFile-related methods.
   bool GenerateFile(Err* err) const;
 
@@ -454,9 +467,15 @@ class Target : public Item {
   // The function can succeed with a "NONE" tool type for object files which
   // are just passed to the output. The output will always be overwritten, not
   // appended to.
-  bool GetOutputFilesForSource(const SourceFile& source,
-                               const char** computed_tool_type,
-                               std::vector<OutputFile>* outputs) const;
+  //
+  // Callers iterating over many sources of this target should pass a
+  // |compiled_lists| cache created for this target, so the tool output
+  // patterns are only interpreted once instead of once per source.
+  bool GetOutputFilesForSource(
+      const SourceFile& source,
+      const char** computed_tool_type,
+      std::vector<OutputFile>* outputs,
+      CompiledSubstitutionList::Cache* compiled_lists = nullptr) const;
 
  private:
   FRIEND_TEST_ALL_PREFIXES(TargetTest, ResolvePrecompiledHeaders);
@@ -0,0 +1,102 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/target_closure.h"
+
+#include "gn/deps_iterator.h"
+#include "util/worker_pool.h"
+
+struct TargetClosure::Chunk {
+  // The dependencies of the targets of the chunk, in order, and the number
+  // of dependencies of each of them.
+  std::vector<const Target*> deps;
+  std::vector<size_t> counts;
+};
+
+TargetClosure::TargetClosure(std::vector<const Target*> targets,
+                             Target::DepsIterationType type)
+    : type_(type), targets_(std::move(targets)) {
+  indices_.reserve(targets_.size());
+  for (size_t i = 0; i < targets_.size(); i++)
+    indices_.emplace(targets_[i], static_cast<TargetIndex>(i));
+
+  const size_t count = targets_.size();
+  std::vector<Chunk> chunks(ParallelForRangeCount(count));
+  ParallelFor(count, [this, &chunks](size_t range, size_t begin, size_t end) {
+    ExtractChunk(begin, end, &chunks[range]);
+  });
+
+  // The chunks are merged in order so the edges of each target are
+  // contiguous. Dependencies which were not given are appended to targets_,
+  // and their own edges are then extracted the same way.
+  deps_offsets_.reserve(count + 1);
+  deps_offsets_.push_back(0);
+  auto add_edges = [this](const Chunk& chunk) {
+    auto dep = chunk.deps.begin();
+    for (size_t dep_count : chunk.counts) {
+      for (size_t i = 0; i < dep_count; i++)
+        deps_.push_back(AddTarget(*dep++));
+      deps_offsets_.push_back(deps_.size());
+    }
+  };
+  for (const Chunk& chunk : chunks)
+    add_edges(chunk);
+  for (size_t i = count; i < targets_.size(); i++) {
+    Chunk chunk;
+    ExtractChunk(i, i + 1, &chunk);
+    add_edges(chunk);
+  }
+}
+
+TargetClosure::~TargetClosure() = default;
+
+std::vector<const Target*> TargetClosure::Collect(
+    const std::vector<const Target*>& roots) const {
+  std::vector<bool> visited(targets_.size());
+  std::vector<TargetIndex> stack;
+  for (const Target* root : roots) {
+    auto found = indices_.find(root);
+    if (found != indices_.end() && !visited[found->second]) {
+      visited[found->second] = true;
+      stack.push_back(found->second);
+    }
+  }
+  while (!stack.empty()) {
+    TargetIndex index = stack.back();
+    stack.pop_back();
+    for (size_t i = deps_offsets_[index]; i < deps_offsets_[index + 1]; i++) {
+      if (!visited[deps_[i]]) {
+        visited[deps_[i]] = true;
+        stack.push_back(deps_[i]);
+      }
+    }
+  }
+
+  std::vector<const Target*> result;
+  for (size_t i = 0; i < targets_.size(); i++) {
+    if (visited[i])
+      result.push_back(targets_[i]);
+  }
+  return result;
+}
+
+void TargetClosure::ExtractChunk(size_t begin,
+                                 size_t end,
+                                 Chunk* chunk) const {
+  chunk->counts.reserve(end - begin);
+  for (size_t i = begin; i < end; i++) {
+    size_t before = chunk->deps.size();
+    for (const auto& pair : targets_[i]->GetDeps(type_))
+      chunk->deps.push_back(pair.ptr);
+    chunk->counts.push_back(chunk->deps.size() - before);
+  }
+}
+
+TargetClosure::TargetIndex TargetClosure::AddTarget(const Target* target) {
+  auto inserted = indices_.emplace(
+      target, static_cast<TargetIndex>(targets_.size()));
+  if (inserted.second)
+    targets_.push_back(target);
+  return inserted.first->second;
+}
@@ -0,0 +1,64 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_TARGET_CLOSURE_H_
+#define TOOLS_GN_TARGET_CLOSURE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "gn/target.h"
+
+// Computes the transitive dependencies of sets of targets, as used by the
+// IDE writers to restrict their output to the targets matching some patterns
+// and their dependencies.
+//
+// Targets are assigned dense indices in the order they are passed to the
+// constructor, followed by any of their dependencies that were not passed.
+// The dependency edges are stored in compressed sparse row form, so that the
+// closure of a set of targets is a walk over integer arrays which records the
+// visited targets in a bitset.
+//
+// The edges are extracted in parallel, and Collect() is const, so an instance
+// can be shared between threads once constructed.
+class TargetClosure {
+ public:
+  TargetClosure(std::vector<const Target*> targets,
+                Target::DepsIterationType type);
+  ~TargetClosure();
+
+  // Returns |roots| and their transitive dependencies, each once, in the
+  // order of the indices. Roots which were not indexed are ignored.
+  std::vector<const Target*> Collect(
+      const std::vector<const Target*>& roots) const;
+
+ private:
+  using TargetIndex = uint32_t;
+
+  // The result of extracting the edges of a range of targets on a worker
+  // thread.
+  struct Chunk;
+  void ExtractChunk(size_t begin, size_t end, Chunk* chunk) const;
+
+  // Returns the index of |target|, indexing it if needed.
+  TargetIndex AddTarget(const Target* target);
+
+  Target::DepsIterationType type_;
+
+  std::vector<const Target*> targets_;
+  std::unordered_map<const Target*, TargetIndex> indices_;
+
+  // The dependencies of targets_[i] are deps_[deps_offsets_[i]] to
+  // deps_[deps_offsets_[i + 1] - 1].
+  std::vector<size_t> deps_offsets_;
+  std::vector<TargetIndex> deps_;
+
+  TargetClosure(const TargetClosure&) = delete;
+  TargetClosure& operator=(const TargetClosure&) = delete;
+};
+
+#endif  // TOOLS_GN_TARGET_CLOSURE_H_
@@ -0,0 +1,47 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/target_closure.h"
+
+#include "gn/test_with_scope.h"
+#include "util/test/test.h"
+
+TEST(TargetClosure, Collect) {
+  TestWithScope setup;
+  TestTarget a(setup, "//foo:a", Target::SOURCE_SET);
+  TestTarget b(setup, "//foo:b", Target::SOURCE_SET);
+  TestTarget c(setup, "//foo:c", Target::EXECUTABLE);
+  TestTarget d(setup, "//foo:d", Target::GROUP);
+  TestTarget e(setup, "//foo:e", Target::GROUP);
+  b.private_deps().push_back(LabelTargetPair(&a));
+  c.public_deps().push_back(LabelTargetPair(&a));
+  c.private_deps().push_back(LabelTargetPair(&b));
+  d.data_deps().push_back(LabelTargetPair(&c));
+
+  // The results follow the order in which the targets are given.
+  TargetClosure all({&e, &d, &c, &b, &a}, Target::DEPS_ALL);
+  EXPECT_EQ(std::vector<const Target*>({&d, &c, &b, &a}), all.Collect({&d}));
+  EXPECT_EQ(std::vector<const Target*>({&e, &b, &a}),
+            all.Collect({&a, &b, &e, &b}));
+  EXPECT_TRUE(all.Collect({}).empty());
+
+  // Data deps are not linked.
+  TargetClosure linked({&e, &d, &c, &b, &a}, Target::DEPS_LINKED);
+  EXPECT_EQ(std::vector<const Target*>({&d}), linked.Collect({&d}));
+  EXPECT_EQ(std::vector<const Target*>({&c, &b, &a}), linked.Collect({&c}));
+}
+
+TEST(TargetClosure, MissingDeps) {
+  TestWithScope setup;
+  TestTarget a(setup, "//foo:a", Target::SOURCE_SET);
+  TestTarget b(setup, "//foo:b", Target::SOURCE_SET);
+  TestTarget c(setup, "//foo:c", Target::EXECUTABLE);
+  b.private_deps().push_back(LabelTargetPair(&a));
+  c.private_deps().push_back(LabelTargetPair(&b));
+
+  // Dependencies which are not given are indexed after the given targets.
+  TargetClosure closure({&c}, Target::DEPS_ALL);
+  EXPECT_EQ(std::vector<const Target*>({&c, &b, &a}), closure.Collect({&c}));
+  EXPECT_EQ(std::vector<const Target*>({&b, &a}), closure.Collect({&b}));
+}
@@ -0,0 +1,182 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/target_graph_index.h"
+
+#include <algorithm>
+
+#include "gn/config_values_extractors.h"
+#include "gn/deps_iterator.h"
+#include "gn/settings.h"
+#include "gn/target.h"
+#include "util/worker_pool.h"
+
+struct TargetGraphIndex::Chunk {
+  // (dependency, dependent) pairs in the order of targets_.
+  std::vector<std::pair<TargetIndex, TargetIndex>> edges;
+  std::vector<std::pair<SourceFile, FileReference>> files;
+  std::vector<std::pair<std::string_view, TargetIndex>> data;
+  std::vector<std::pair<const Config*, TargetIndex>> configs;
+};
+
+TargetGraphIndex::TargetGraphIndex(std::vector<const Target*> targets)
+    : targets_(std::move(targets)) {
+  indices_.reserve(targets_.size());
+  for (size_t i = 0; i < targets_.size(); i++)
+    indices_.emplace(targets_[i], static_cast<TargetIndex>(i));
+
+  std::vector<Chunk> chunks(ParallelForRangeCount(targets_.size()));
+  ParallelFor(targets_.size(),
+              [this, &chunks](size_t range, size_t begin, size_t end) {
+                IndexChunk(begin, end, &chunks[range]);
+              });
+
+  // Merging the chunks in order keeps every list sorted by target index.
+  dependents_offsets_.assign(targets_.size() + 1, 0);
+  for (const Chunk& chunk : chunks) {
+    for (const auto& edge : chunk.edges)
+      dependents_offsets_[edge.first + 1]++;
+  }
+  for (size_t i = 0; i < targets_.size(); i++)
+    dependents_offsets_[i + 1] += dependents_offsets_[i];
+  dependents_.resize(dependents_offsets_.back());
+  std::vector<size_t> next(dependents_offsets_.begin(),
+                           dependents_offsets_.end() - 1);
+  for (Chunk& chunk : chunks) {
+    for (const auto& edge : chunk.edges)
+      dependents_[next[edge.first]++] = targets_[edge.second];
+
+    for (auto& file : chunk.files) {
+      std::vector<FileReference>& refs = files_[std::move(file.first)];
+      // A target is indexed once per file, with the first way it refers to
+      // it.
+      if (refs.empty() || refs.back().first != file.second.first)
+        refs.push_back(file.second);
+    }
+    for (const auto& data : chunk.data) {
+      std::vector<TargetIndex>& indices = data_[data.first];
+      if (indices.empty() || indices.back() != data.second)
+        indices.push_back(data.second);
+    }
+    for (const auto& config : chunk.configs) {
+      std::vector<TargetIndex>& indices = configs_[config.first];
+      if (indices.empty() || indices.back() != config.second)
+        indices.push_back(config.second);
+    }
+  }
+}
+
+TargetGraphIndex::~TargetGraphIndex() = default;
+
+size_t TargetGraphIndex::IndexOf(const Target* target) const {
+  auto found = indices_.find(target);
+  return found == indices_.end() ? kNotFound : found->second;
+}
+
+base::span<const Target* const> TargetGraphIndex::GetDependents(
+    const Target* target) const {
+  size_t index = IndexOf(target);
+  if (index == kNotFound)
+    return base::span<const Target* const>();
+  return base::span<const Target* const>(
+      dependents_.data() + dependents_offsets_[index],
+      dependents_offsets_[index + 1] - dependents_offsets_[index]);
+}
+
+std::vector<commands::TargetContainingFile>
+TargetGraphIndex::GetTargetsContainingFile(const SourceFile& file) const {
+  std::vector<FileReference> refs;
+  auto found = files_.find(file);
+  if (found != files_.end())
+    refs = found->second;
+
+  // Data entries match the file itself, or any directory containing it.
+  if (!data_.empty()) {
+    auto add_data = [this, &refs](std::string_view value) {
+      auto found_data = data_.find(value);
+      if (found_data == data_.end())
+        return;
+      for (TargetIndex index : found_data->second)
+        refs.emplace_back(index, commands::HowTargetContainsFile::kData);
+    };
+    std::string_view value = file.value();
+    add_data(value);
+    for (size_t slash = value.find('/'); slash != std::string_view::npos;
+         slash = value.find('/', slash + 1))
+      add_data(value.substr(0, slash + 1));
+  }
+
+  // HowTargetContainsFile values are in the order in which they take
+  // precedence, so the first reference of each target is the one to keep.
+  std::sort(refs.begin(), refs.end());
+  std::vector<commands::TargetContainingFile> result;
+  for (const FileReference& ref : refs) {
+    if (result.empty() || result.back().first != targets_[ref.first])
+      result.emplace_back(targets_[ref.first], ref.second);
+  }
+  return result;
+}
+
+std::vector<const Target*> TargetGraphIndex::GetTargetsReferencingConfig(
+    const Config* config) const {
+  std::vector<const Target*> result;
+  auto found = configs_.find(config);
+  if (found != configs_.end()) {
+    result.reserve(found->second.size());
+    for (TargetIndex index : found->second)
+      result.push_back(targets_[index]);
+  }
+  return result;
+}
+
+void TargetGraphIndex::IndexChunk(size_t begin,
+                                  size_t end,
+                                  Chunk* chunk) const {
+  using commands::HowTargetContainsFile;
+
+  std::vector<SourceFile> output_sources;
+  for (size_t i = begin; i < end; i++) {
+    const Target* target = targets_[i];
+    TargetIndex index = static_cast<TargetIndex>(i);
+
+    for (const auto& dep_pair : target->GetDeps(Target::DEPS_ALL)) {
+      auto found = indices_.find(dep_pair.ptr);
+      if (found != indices_.end())
+        chunk->edges.emplace_back(found->second, index);
+    }
+
+    // Files are added in the order of precedence of HowTargetContainsFile.
+    auto add_file = [chunk, index](const SourceFile& file,
+                                   HowTargetContainsFile how) {
+      chunk->files.emplace_back(file, FileReference(index, how));
+    };
+    for (const auto& file : target->sources())
+      add_file(file, HowTargetContainsFile::kSources);
+    for (const auto& file : target->public_headers())
+      add_file(file, HowTargetContainsFile::kPublic);
+    for (ConfigValuesIterator iter(target); !iter.done(); iter.Next()) {
+      for (const auto& file : iter.cur().inputs())
+        add_file(file, HowTargetContainsFile::kInputs);
+    }
+    for (const auto& data : target->data())
+      chunk->data.emplace_back(data, index);
+    if (!target->action_values().script().is_null()) {
+      add_file(target->action_values().script(),
+               HowTargetContainsFile::kScript);
+    }
+    output_sources.clear();
+    target->action_values().GetOutputsAsSourceFiles(target, &output_sources);
+    for (const auto& file : output_sources)
+      add_file(file, HowTargetContainsFile::kOutput);
+    for (const auto& output : target->computed_outputs()) {
+      add_file(output.AsSourceFile(target->settings()->build_settings()),
+               HowTargetContainsFile::kOutput);
+    }
+
+    for (const LabelConfigPair& config : target->configs())
+      chunk->configs.emplace_back(config.ptr, index);
+    for (const LabelConfigPair& config : target->public_configs())
+      chunk->configs.emplace_back(config.ptr, index);
+  }
+}
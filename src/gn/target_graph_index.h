@@ -0,0 +1,93 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_TARGET_GRAPH_INDEX_H_
+#define TOOLS_GN_TARGET_GRAPH_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/containers/span.h"
+#include "gn/commands.h"
+#include "gn/source_file.h"
+
+class Config;
+class Target;
+
+// Indexes of a resolved build graph used by the query commands ("gn refs",
+// "gn outputs", ...) to answer many inputs without scanning every target for
+// each of them.
+//
+// Targets are assigned dense indices in the order they are passed to the
+// constructor. The reverse dependency edges are stored in compressed sparse
+// row form: the dependents of all targets are stored in a single vector, and
+// an offsets vector gives the range belonging to each target.
+//
+// The indexes are built in parallel, and all the lookups are const, so an
+// instance can be shared between threads once constructed.
+class TargetGraphIndex {
+ public:
+  explicit TargetGraphIndex(std::vector<const Target*> targets);
+  ~TargetGraphIndex();
+
+  const std::vector<const Target*>& targets() const { return targets_; }
+
+  // Returns the index of |target|, or kNotFound if it is not in the graph.
+  static constexpr size_t kNotFound = static_cast<size_t>(-1);
+  size_t IndexOf(const Target* target) const;
+
+  // Returns the targets that list |target| in their public, private or data
+  // deps. Targets are in the order of targets(), which is the order in which
+  // a std::multimap filled by iterating over targets() would list them.
+  base::span<const Target* const> GetDependents(const Target* target) const;
+
+  // Returns the targets referring to |file|, with how they refer to it, in
+  // the order of targets(). When a target refers to the file in several ways,
+  // only the first HowTargetContainsFile value applies.
+  std::vector<commands::TargetContainingFile> GetTargetsContainingFile(
+      const SourceFile& file) const;
+
+  // Returns the targets listing |config| in their configs or public_configs,
+  // in the order of targets().
+  std::vector<const Target*> GetTargetsReferencingConfig(
+      const Config* config) const;
+
+ private:
+  using TargetIndex = uint32_t;
+  using FileReference = std::pair<TargetIndex, commands::HowTargetContainsFile>;
+
+  // The result of indexing a range of targets on a worker thread.
+  struct Chunk;
+  void IndexChunk(size_t begin, size_t end, Chunk* chunk) const;
+
+  std::vector<const Target*> targets_;
+  std::unordered_map<const Target*, TargetIndex> indices_;
+
+  // The dependents of targets_[i] are dependents_[dependents_offsets_[i]] to
+  // dependents_[dependents_offsets_[i + 1] - 1].
+  std::vector<size_t> dependents_offsets_;
+  std::vector<const Target*> dependents_;
+
+  std::unordered_map<SourceFile,
+                     std::vector<FileReference>,
+                     SourceFile::PtrHash,
+                     SourceFile::PtrEqual>
+      files_;
+
+  // Entries of the targets' data lists. Entries ending with a slash refer to
+  // all the files in that directory.
+  std::unordered_map<std::string_view, std::vector<TargetIndex>> data_;
+
+  std::unordered_map<const Config*, std::vector<TargetIndex>> configs_;
+
+  TargetGraphIndex(const TargetGraphIndex&) = delete;
+  TargetGraphIndex& operator=(const TargetGraphIndex&) = delete;
+};
+
+#endif  // TOOLS_GN_TARGET_GRAPH_INDEX_H_
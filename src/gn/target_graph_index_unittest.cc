@@ -0,0 +1,94 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/target_graph_index.h"
+
+#include "gn/config.h"
+#include "gn/test_with_scope.h"
+#include "util/test/test.h"
+
+TEST(TargetGraphIndex, Dependents) {
+  TestWithScope setup;
+  TestTarget a(setup, "//foo:a", Target::SOURCE_SET);
+  TestTarget b(setup, "//foo:b", Target::SOURCE_SET);
+  TestTarget c(setup, "//foo:c", Target::EXECUTABLE);
+  TestTarget d(setup, "//foo:d", Target::GROUP);
+  b.private_deps().push_back(LabelTargetPair(&a));
+  c.public_deps().push_back(LabelTargetPair(&a));
+  c.private_deps().push_back(LabelTargetPair(&b));
+  d.data_deps().push_back(LabelTargetPair(&c));
+
+  // The dependents follow the order in which the targets are given.
+  TargetGraphIndex index({&d, &c, &b, &a});
+  EXPECT_EQ(3u, index.IndexOf(&a));
+  EXPECT_EQ(TargetGraphIndex::kNotFound, index.IndexOf(nullptr));
+
+  base::span<const Target* const> dependents = index.GetDependents(&a);
+  ASSERT_EQ(2u, dependents.size());
+  EXPECT_EQ(&c, dependents[0]);
+  EXPECT_EQ(&b, dependents[1]);
+
+  dependents = index.GetDependents(&c);
+  ASSERT_EQ(1u, dependents.size());
+  EXPECT_EQ(&d, dependents[0]);
+
+  EXPECT_TRUE(index.GetDependents(&d).empty());
+}
+
+TEST(TargetGraphIndex, Files) {
+  using commands::HowTargetContainsFile;
+
+  TestWithScope setup;
+  TestTarget a(setup, "//foo:a", Target::SOURCE_SET);
+  TestTarget b(setup, "//foo:b", Target::SOURCE_SET);
+  TestTarget c(setup, "//foo:c", Target::GROUP);
+  SourceFile file("//foo/file.h");
+  a.sources().push_back(SourceFile("//foo/a.cc"));
+  a.data().push_back("//foo/file.h");
+  // The sources take precedence over the public headers.
+  a.public_headers().push_back(file);
+  a.sources().push_back(file);
+  b.config_values().inputs().push_back(file);
+  c.data().push_back("//foo/");
+
+  TargetGraphIndex index({&a, &b, &c});
+  std::vector<commands::TargetContainingFile> found =
+      index.GetTargetsContainingFile(file);
+  ASSERT_EQ(3u, found.size());
+  EXPECT_EQ(&a, found[0].first);
+  EXPECT_EQ(HowTargetContainsFile::kSources, found[0].second);
+  EXPECT_EQ(&b, found[1].first);
+  EXPECT_EQ(HowTargetContainsFile::kInputs, found[1].second);
+  EXPECT_EQ(&c, found[2].first);
+  EXPECT_EQ(HowTargetContainsFile::kData, found[2].second);
+
+  found = index.GetTargetsContainingFile(SourceFile("//foo/bar/baz.txt"));
+  ASSERT_EQ(1u, found.size());
+  EXPECT_EQ(&c, found[0].first);
+
+  EXPECT_TRUE(index.GetTargetsContainingFile(SourceFile("//bar/file.h"))
+                  .empty());
+}
+
+TEST(TargetGraphIndex, Configs) {
+  TestWithScope setup;
+  Config config(setup.settings(), Label(SourceDir("//foo/"), "config"));
+  Config other(setup.settings(), Label(SourceDir("//foo/"), "other"));
+  Err err;
+  ASSERT_TRUE(config.OnResolved(&err));
+  ASSERT_TRUE(other.OnResolved(&err));
+  TestTarget a(setup, "//foo:a", Target::SOURCE_SET);
+  TestTarget b(setup, "//foo:b", Target::SOURCE_SET);
+  TestTarget c(setup, "//foo:c", Target::SOURCE_SET);
+  a.configs().push_back(LabelConfigPair(&config));
+  a.public_configs().push_back(LabelConfigPair(&config));
+  b.configs().push_back(LabelConfigPair(&other));
+  c.public_configs().push_back(LabelConfigPair(&config));
+
+  TargetGraphIndex index({&a, &b, &c});
+  std::vector<const Target*> found = index.GetTargetsReferencingConfig(&config);
+  ASSERT_EQ(2u, found.size());
+  EXPECT_EQ(&a, found[0]);
+  EXPECT_EQ(&c, found[1]);
+}
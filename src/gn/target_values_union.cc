@@ -0,0 +1,105 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/target_values_union.h"
+
+#include <algorithm>
+#include <string_view>
+#include <unordered_set>
+
+#include "gn/config_values.h"
+#include "gn/config_values_extractors.h"
+#include "gn/target.h"
+#include "util/worker_pool.h"
+
+struct TargetValuesUnion::Chunk {
+  // The distinct config values of the targets, from the last used to the
+  // first used.
+  std::vector<const ConfigValues*> config_values;
+  std::vector<SourceFile> files;
+};
+
+TargetValuesUnion::TargetValuesUnion(
+    const std::vector<const Target*>& targets) {
+  std::vector<Chunk> chunks(ParallelForRangeCount(targets.size()));
+  ParallelFor(targets.size(),
+              [&targets, &chunks](size_t range, size_t begin, size_t end) {
+                CollectChunk(targets.data() + begin, targets.data() + end,
+                             &chunks[range]);
+              });
+
+  // Walking the chunks backwards keeps the last use of each config values.
+  std::unordered_set<const ConfigValues*> seen_values;
+  for (auto chunk = chunks.rbegin(); chunk != chunks.rend(); ++chunk) {
+    for (const ConfigValues* values : chunk->config_values) {
+      if (seen_values.insert(values).second)
+        config_values_.push_back(values);
+    }
+  }
+  std::reverse(config_values_.begin(), config_values_.end());
+
+  std::unordered_set<SourceFile> seen_files;
+  for (const Chunk& chunk : chunks) {
+    for (const SourceFile& file : chunk.files) {
+      if (seen_files.insert(file).second)
+        files_.push_back(file);
+    }
+  }
+
+  std::unordered_set<SourceDir> seen_dirs;
+  for (const ConfigValues* values : config_values_) {
+    for (const SourceDir& dir : values->include_dirs()) {
+      if (seen_dirs.insert(dir).second)
+        include_dirs_.push_back(dir);
+    }
+    for (const SourceFile& input : values->inputs()) {
+      if (seen_files.insert(input).second)
+        files_.push_back(input);
+    }
+    const SourceFile& precompiled_source = values->precompiled_source();
+    if (!precompiled_source.is_null() &&
+        seen_files.insert(precompiled_source).second)
+      files_.push_back(precompiled_source);
+  }
+
+  // A define last used in some config values is last used in the last of
+  // them which contains it, so the order of config_values_ is enough.
+  std::unordered_set<std::string_view> seen_defines;
+  for (auto values = config_values_.rbegin(); values != config_values_.rend();
+       ++values) {
+    const std::vector<std::string>& defines = (*values)->defines();
+    for (auto define = defines.rbegin(); define != defines.rend(); ++define) {
+      if (seen_defines.insert(*define).second)
+        defines_.push_back(*define);
+    }
+  }
+  std::reverse(defines_.begin(), defines_.end());
+}
+
+TargetValuesUnion::~TargetValuesUnion() = default;
+
+// static
+void TargetValuesUnion::CollectChunk(const Target* const* begin,
+                                     const Target* const* end,
+                                     Chunk* chunk) {
+  std::vector<const ConfigValues*> uses;
+  std::unordered_set<SourceFile> seen_files;
+  for (const Target* const* target = begin; target != end; ++target) {
+    for (ConfigValuesIterator it(*target); !it.done(); it.Next())
+      uses.push_back(&it.cur());
+    for (const auto* files : {&(*target)->sources(),
+                              &(*target)->public_headers()}) {
+      for (const SourceFile& file : *files) {
+        if (seen_files.insert(file).second)
+          chunk->files.push_back(file);
+      }
+    }
+  }
+
+  std::unordered_set<const ConfigValues*> seen_values;
+  for (auto values = uses.rbegin(); values != uses.rend(); ++values) {
+    if (seen_values.insert(*values).second)
+      chunk->config_values.push_back(*values);
+  }
+}
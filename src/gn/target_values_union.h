@@ -0,0 +1,63 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLS_GN_TARGET_VALUES_UNION_H_
+#define TOOLS_GN_TARGET_VALUES_UNION_H_
+
+#include <string>
+#include <vector>
+
+#include "gn/source_dir.h"
+#include "gn/source_file.h"
+
+class ConfigValues;
+class Target;
+
+// Collects the deduplicated union of the values which the IDE writers export
+// for a set of targets.
+//
+// The resolved values of a config are shared by all the targets using it, so
+// the config values are deduplicated by identity before their contents are
+// read. Include dirs and files are then deduplicated by atom, before being
+// converted to paths. The targets are walked in parallel.
+class TargetValuesUnion {
+ public:
+  explicit TargetValuesUnion(const std::vector<const Target*>& targets);
+  ~TargetValuesUnion();
+
+  // The distinct config values of the targets and of their configs, in the
+  // order of their last use when iterating over the targets with a
+  // ConfigValuesIterator.
+  const std::vector<const ConfigValues*>& config_values() const {
+    return config_values_;
+  }
+
+  // The distinct include dirs, in the order of config_values().
+  const std::vector<SourceDir>& include_dirs() const { return include_dirs_; }
+
+  // The distinct defines, in the order of their last use. Assigning them in
+  // order gives each macro the value it was last defined with.
+  const std::vector<std::string>& defines() const { return defines_; }
+
+  // The distinct sources and public headers of the targets, followed by the
+  // inputs and precompiled sources of config_values().
+  const std::vector<SourceFile>& files() const { return files_; }
+
+ private:
+  // The values collected from a range of targets on a worker thread.
+  struct Chunk;
+  static void CollectChunk(const Target* const* begin,
+                           const Target* const* end,
+                           Chunk* chunk);
+
+  std::vector<const ConfigValues*> config_values_;
+  std::vector<SourceDir> include_dirs_;
+  std::vector<std::string> defines_;
+  std::vector<SourceFile> files_;
+
+  TargetValuesUnion(const TargetValuesUnion&) = delete;
+  TargetValuesUnion& operator=(const TargetValuesUnion&) = delete;
+};
+
+#endif  // TOOLS_GN_TARGET_VALUES_UNION_H_
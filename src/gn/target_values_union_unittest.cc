@@ -0,0 +1,50 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/target_values_union.h"
+
+#include "gn/config.h"
+#include "gn/test_with_scope.h"
+#include "util/test/test.h"
+
+TEST(TargetValuesUnion, Collect) {
+  TestWithScope setup;
+  Config config(setup.settings(), Label(SourceDir("//foo/"), "config"));
+  config.own_values().include_dirs().push_back(SourceDir("//foo/include/"));
+  config.own_values().defines().push_back("FOO=1");
+  config.own_values().inputs().push_back(SourceFile("//foo/input.txt"));
+  Err err;
+  ASSERT_TRUE(config.OnResolved(&err));
+
+  TestTarget a(setup, "//foo:a", Target::SOURCE_SET);
+  TestTarget b(setup, "//foo:b", Target::SOURCE_SET);
+  a.sources().push_back(SourceFile("//foo/a.cc"));
+  a.sources().push_back(SourceFile("//foo/common.h"));
+  a.config_values().include_dirs().push_back(SourceDir("//foo/include/"));
+  a.config_values().defines().push_back("FOO=2");
+  a.configs().push_back(LabelConfigPair(&config));
+  b.public_headers().push_back(SourceFile("//foo/common.h"));
+  b.config_values().include_dirs().push_back(SourceDir("//bar/"));
+  b.config_values().defines().push_back("BAR");
+  b.configs().push_back(LabelConfigPair(&config));
+
+  TargetValuesUnion values({&a, &b});
+
+  // The config values of the config are collected once, at their last use.
+  ASSERT_EQ(3u, values.config_values().size());
+  EXPECT_EQ(&a.config_values(), values.config_values()[0]);
+  EXPECT_EQ(&b.config_values(), values.config_values()[1]);
+  EXPECT_EQ(&config.resolved_values(), values.config_values()[2]);
+
+  EXPECT_EQ(std::vector<SourceDir>({SourceDir("//foo/include/"),
+                                    SourceDir("//bar/")}),
+            values.include_dirs());
+  // FOO=1 is used after FOO=2 by b.
+  EXPECT_EQ(std::vector<std::string>({"FOO=2", "BAR", "FOO=1"}),
+            values.defines());
+  EXPECT_EQ(std::vector<SourceFile>({SourceFile("//foo/a.cc"),
+                                     SourceFile("//foo/common.h"),
+                                     SourceFile("//foo/input.txt")}),
+            values.files());
+}
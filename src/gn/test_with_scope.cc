@@ -7,6 +7,8 @@
 #include <memory>
 #include <utility>
 
+#include "base/command_line.h"
+#include "gn/commands.h"
 #include "gn/parser.h"
 #include "gn/tokenizer.h"
 
@@ -354,3 +356,9 @@ TestTarget::TestTarget(const TestWithScope& setup,
 }
 
 TestTarget::~TestTarget() = default;
+
+void InitCommandSwitchesForTesting() {
+  static bool initialized = commands::CommandSwitches::Init(
+      base::CommandLine(base::CommandLine::NO_PROGRAM));
+  CHECK(initialized);
+}
@@ -126,4 +126,9 @@ class TestTarget : public Target {
   ~TestTarget() override;
 };
 
+// Initializes the command switches of the process, with no switch set, for
+// the tests of code reading them such as DescBuilder. Can be called any number
+// of times.
+void InitCommandSwitchesForTesting();
+
 #endif  // TOOLS_GN_TEST_WITH_SCOPE_H_
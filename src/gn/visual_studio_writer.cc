@@ -11,7 +11,6 @@
 #include <set>
 #include <string>
 
-#include "base/containers/queue.h"
 #include "base/logging.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
@@ -19,7 +18,6 @@
 #include "gn/commands.h"
 #include "gn/config.h"
 #include "gn/config_values_extractors.h"
-#include "gn/deps_iterator.h"
 #include "gn/filesystem_utils.h"
 #include "gn/label_pattern.h"
 #include "gn/parse_tree.h"
@@ -27,9 +25,11 @@
 #include "gn/standard_out.h"
 #include "gn/string_output_buffer.h"
 #include "gn/target.h"
+#include "gn/target_closure.h"
 #include "gn/variables.h"
 #include "gn/visual_studio_utils.h"
 #include "gn/xml_element_writer.h"
+#include "util/worker_pool.h"
 
 #if defined(OS_WIN)
 #include "base/win/registry.h"
@@ -206,31 +206,13 @@ bool FilterTargets(const BuildSettings* build_settings,
                                           err))
     return false;
 
-  commands::FilterTargetsByPatterns(builder.GetAllResolvedTargets(), patterns,
-                                    targets);
+  std::vector<const Target*> all_targets = builder.GetAllResolvedTargets();
+  commands::FilterTargetsByPatterns(all_targets, patterns, targets);
 
-  if (no_deps)
-    return true;
-
-  std::set<Label> labels;
-  base::queue<const Target*> to_process;
-  for (const Target* target : *targets) {
-    labels.insert(target->label());
-    to_process.push(target);
-  }
-
-  while (!to_process.empty()) {
-    const Target* target = to_process.front();
-    to_process.pop();
-    for (const auto& pair : target->GetDeps(Target::DEPS_ALL)) {
-      if (labels.find(pair.label) == labels.end()) {
-        targets->push_back(pair.ptr);
-        to_process.push(pair.ptr);
-        labels.insert(pair.label);
-      }
-    }
+  if (!no_deps) {
+    TargetClosure closure(std::move(all_targets), Target::DEPS_ALL);
+    *targets = closure.Collect(*targets);
   }
-
   return true;
 }
 
@@ -363,6 +345,8 @@ bool VisualStudioWriter::RunAndWriteFiles(const BuildSettings* build_settings,
   writer.projects_.reserve(targets.size());
   writer.folders_.reserve(targets.size());
 
+  std::vector<const Target*> project_targets;
+  project_targets.reserve(targets.size());
   for (const Target* target : targets) {
     // Skip actions and bundle targets.
     if (target->output_type() == Target::ACTION ||
@@ -373,10 +357,27 @@ bool VisualStudioWriter::RunAndWriteFiles(const BuildSettings* build_settings,
         target->output_type() == Target::GENERATED_FILE) {
       continue;
     }
+    project_targets.push_back(target);
+  }
+
+  // Projects are independent of each other, so they are written in parallel.
+  // The results are gathered in target order so that the first error is
+  // always the same.
+  SolutionProjects projects(project_targets.size());
+  std::vector<Err> errors(project_targets.size());
+  ParallelFor(project_targets.size(), [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      writer.WriteProjectFiles(project_targets[i], ninja_extra_args,
+                               ninja_executable, &projects[i], &errors[i]);
+    }
+  });
 
-    if (!writer.WriteProjectFiles(target, ninja_extra_args, ninja_executable,
-                                  err))
+  for (size_t i = 0; i < projects.size(); i++) {
+    if (errors[i].has_error()) {
+      *err = errors[i];
       return false;
+    }
+    writer.projects_.push_back(std::move(projects[i]));
   }
 
   if (writer.projects_.empty()) {
@@ -396,10 +397,12 @@ bool VisualStudioWriter::RunAndWriteFiles(const BuildSettings* build_settings,
   return writer.WriteSolutionFile(sln_name, err);
 }
 
-bool VisualStudioWriter::WriteProjectFiles(const Target* target,
-                                           const std::string& ninja_extra_args,
-                                           const std::string& ninja_executable,
-                                           Err* err) {
+bool VisualStudioWriter::WriteProjectFiles(
+    const Target* target,
+    const std::string& ninja_extra_args,
+    const std::string& ninja_executable,
+    std::unique_ptr<SolutionProject>* project,
+    Err* err) const {
   std::string project_name = target->label().name();
   const char* project_config_platform = config_platform_;
   if (!target->settings()->is_default()) {
@@ -421,21 +424,19 @@ bool VisualStudioWriter::WriteProjectFiles(const Target* target,
   base::FilePath vcxproj_path = build_settings_->GetFullPath(target_file);
   std::string vcxproj_path_str = FilePathToUTF8(vcxproj_path);
 
-  projects_.push_back(std::make_unique<SolutionProject>(
+  auto solution_project = std::make_unique<SolutionProject>(
       project_name, vcxproj_path_str,
       MakeGuid(vcxproj_path_str, kGuidSeedProject),
       FilePathToUTF8(build_settings_->GetFullPath(target->label().dir())),
-      project_config_platform));
+      project_config_platform);
 
   StringOutputBuffer vcxproj_storage;
   std::ostream vcxproj_string_out(&vcxproj_storage);
   SourceFileCompileTypePairs source_types;
-  if (!WriteProjectFileContents(vcxproj_string_out, *projects_.back(), target,
+  if (!WriteProjectFileContents(vcxproj_string_out, *solution_project, target,
                                 ninja_extra_args, ninja_executable,
-                                &source_types, err)) {
-    projects_.pop_back();
+                                &source_types, err))
     return false;
-  }
 
   // Only write the content to the file if it's different. That is
   // both a performance optimization and more importantly, prevents
@@ -448,7 +449,11 @@ bool VisualStudioWriter::WriteProjectFiles(const Target* target,
   StringOutputBuffer filters_storage;
   std::ostream filters_string_out(&filters_storage);
   WriteFiltersFileContents(filters_string_out, target, source_types);
-  return filters_storage.WriteToFileIfChanged(filters_path, err);
+  if (!filters_storage.WriteToFileIfChanged(filters_path, err))
+    return false;
+
+  *project = std::move(solution_project);
+  return true;
 }
 
 bool VisualStudioWriter::WriteProjectFileContents(
@@ -458,7 +463,7 @@ bool VisualStudioWriter::WriteProjectFileContents(
     const std::string& ninja_extra_args,
     const std::string& ninja_executable,
     SourceFileCompileTypePairs* source_types,
-    Err* err) {
+    Err* err) const {
   PathOutput path_output(
       GetBuildDirForTargetAsSourceDir(target, BuildDirType::OBJ),
       build_settings_->root_path_utf8(), EscapingMode::ESCAPE_NONE);
@@ -687,7 +692,7 @@ bool VisualStudioWriter::WriteProjectFileContents(
 void VisualStudioWriter::WriteFiltersFileContents(
     std::ostream& out,
     const Target* target,
-    const SourceFileCompileTypePairs& source_types) {
+    const SourceFileCompileTypePairs& source_types) const {
   out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>" << std::endl;
   XmlElementWriter project(
       out, "Project",
@@ -711,7 +716,7 @@ void VisualStudioWriter::WriteFiltersFileContents(
                                   build_settings_->root_path_utf8(),
                                   EscapingMode::ESCAPE_NONE);
 
-    std::set<std::string> processed_filters;
+    std::set<const Filter*> processed_filters;
 
     for (const auto& file_and_type : source_types) {
       std::unique_ptr<XmlElementWriter> cl_item = files_group.SubElement(
@@ -725,17 +730,13 @@ void VisualStudioWriter::WriteFiltersFileContents(
       std::string_view filter_path = FindParentDir(&target_relative_path);
 
       if (!filter_path.empty()) {
-        std::string filter_path_str(filter_path);
-        while (processed_filters.find(filter_path_str) ==
-               processed_filters.end()) {
-          auto it = processed_filters.insert(filter_path_str).first;
+        for (const Filter* filter = GetFilter(filter_path);
+             filter && processed_filters.insert(filter).second;
+             filter = filter->parent) {
           filters_group
-              ->SubElement("Filter", XmlAttributes("Include", filter_path_str))
+              ->SubElement("Filter", XmlAttributes("Include", filter->path))
               ->SubElement("UniqueIdentifier")
-              ->Text(MakeGuid(filter_path_str, kGuidSeedFilter));
-          filter_path_str = std::string(FindParentDir(&(*it)));
-          if (filter_path_str.empty())
-            break;
+              ->Text(filter->guid);
         }
         cl_item->SubElement("Filter")->Text(filter_path);
       }
@@ -928,7 +929,7 @@ void VisualStudioWriter::ResolveSolutionFolders() {
 }
 
 std::pair<std::string, bool> VisualStudioWriter::GetNinjaTarget(
-    const Target* target) {
+    const Target* target) const {
   std::ostringstream ninja_target_out;
   bool is_phony = false;
   OutputFile output_file;
@@ -945,3 +946,28 @@ std::pair<std::string, bool> VisualStudioWriter::GetNinjaTarget(
     s = s.substr(2);
   return std::make_pair(s, is_phony);
 }
+
+const VisualStudioWriter::Filter* VisualStudioWriter::GetFilter(
+    std::string_view path) const {
+  if (path.empty())
+    return nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock(filters_lock_);
+    auto found = filters_.find(path);
+    if (found != filters_.end())
+      return &found->second;
+  }
+
+  // Hash outside of the lock. If another thread added the same filter in the
+  // meantime, its entry is kept.
+  std::string path_str(path);
+  Filter filter;
+  filter.path = path_str;
+  filter.parent = GetFilter(FindParentDir(&path_str));
+  filter.guid = MakeGuid(path_str, kGuidSeedFilter);
+
+  std::lock_guard<std::mutex> lock(filters_lock_);
+  return &filters_.emplace(std::move(path_str), std::move(filter))
+              .first->second;
+}
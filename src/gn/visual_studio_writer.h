@@ -6,8 +6,11 @@
 #define TOOLS_GN_VISUAL_STUDIO_WRITER_H_
 
 #include <iosfwd>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "base/gtest_prod_util.h"
@@ -57,6 +60,7 @@ class VisualStudioWriter {
                            ResolveSolutionFolders_AbsPath);
   FRIEND_TEST_ALL_PREFIXES(VisualStudioWriterTest, NoDotSlash);
   FRIEND_TEST_ALL_PREFIXES(VisualStudioWriterTest, NinjaExecutable);
+  FRIEND_TEST_ALL_PREFIXES(VisualStudioWriterTest, SharedFilters);
 
   // Solution project or folder.
   struct SolutionEntry {
@@ -99,6 +103,17 @@ class VisualStudioWriter {
     const char* compile_type;
   };
 
+  // Filter folder of a .vcxproj.filters file. Filters are paths relative to
+  // the target directory, so they are shared by many projects.
+  struct Filter {
+    // Filter path, using system separators.
+    std::string path;
+    // GUID-like string.
+    std::string guid;
+    // Pointer to parent filter. nullptr if filter has no parent.
+    const Filter* parent;
+  };
+
   using SolutionProjects = std::vector<std::unique_ptr<SolutionProject>>;
   using SolutionFolders = std::vector<std::unique_ptr<SolutionEntry>>;
   using SourceFileCompileTypePairs = std::vector<SourceFileCompileTypePair>;
@@ -109,20 +124,25 @@ class VisualStudioWriter {
                      const std::string& win_kit);
   ~VisualStudioWriter();
 
+  // Writes the project files of |target| and fills |project| on success.
+  // Only reads the writer state, so it may run concurrently for different
+  // targets.
   bool WriteProjectFiles(const Target* target,
                          const std::string& ninja_extra_args,
                          const std::string& ninja_executable,
-                         Err* err);
+                         std::unique_ptr<SolutionProject>* project,
+                         Err* err) const;
   bool WriteProjectFileContents(std::ostream& out,
                                 const SolutionProject& solution_project,
                                 const Target* target,
                                 const std::string& ninja_extra_args,
                                 const std::string& ninja_executable,
                                 SourceFileCompileTypePairs* source_types,
-                                Err* err);
-  void WriteFiltersFileContents(std::ostream& out,
-                                const Target* target,
-                                const SourceFileCompileTypePairs& source_types);
+                                Err* err) const;
+  void WriteFiltersFileContents(
+      std::ostream& out,
+      const Target* target,
+      const SourceFileCompileTypePairs& source_types) const;
   bool WriteSolutionFile(const std::string& sln_name, Err* err);
   void WriteSolutionFileContents(std::ostream& out,
                                  const base::FilePath& solution_dir_path);
@@ -132,7 +152,11 @@ class VisualStudioWriter {
   void ResolveSolutionFolders();
 
   // Returns the ninja target string and whether the target is phony.
-  std::pair<std::string, bool> GetNinjaTarget(const Target* target);
+  std::pair<std::string, bool> GetNinjaTarget(const Target* target) const;
+
+  // Returns the filter for |path|, creating it and its parents on first use.
+  // Returns nullptr if |path| is empty. Threadsafe.
+  const Filter* GetFilter(std::string_view path) const;
 
   const BuildSettings* build_settings_;
 
@@ -167,6 +191,11 @@ class VisualStudioWriter {
   // Windows 10 SDK version string (e.g. 10.0.14393.0)
   std::string windows_sdk_version_;
 
+  // Filters of all the projects, indexed by path. Protected by
+  // |filters_lock_| as projects are written in parallel.
+  mutable std::mutex filters_lock_;
+  mutable std::map<std::string, Filter, std::less<>> filters_;
+
   VisualStudioWriter(const VisualStudioWriter&) = delete;
   VisualStudioWriter& operator=(const VisualStudioWriter&) = delete;
 };
@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "base/strings/string_util.h"
+#include "gn/filesystem_utils.h"
 #include "gn/test_with_scope.h"
 #include "gn/visual_studio_utils.h"
 #include "util/test/test.h"
@@ -244,3 +245,49 @@ TEST_F(VisualStudioWriterTest, NinjaExecutable) {
   ASSERT_NE(file_contents_with_flag.str().find("call ninja_wrapper.exe"),
             std::string::npos);
 }
+
+TEST_F(VisualStudioWriterTest, SharedFilters) {
+  VisualStudioWriter writer(setup_.build_settings(), "Win32",
+                            VisualStudioWriter::Version::Vs2015,
+                            "10.0.17134.0");
+
+  Target foo(setup_.settings(), Label(SourceDir("//foo/"), "foo"));
+  foo.sources().push_back(SourceFile("//foo/a/b/x.cc"));
+  foo.sources().push_back(SourceFile("//foo/a/y.cc"));
+  Target bar(setup_.settings(), Label(SourceDir("//bar/"), "bar"));
+  bar.sources().push_back(SourceFile("//bar/a/b/z.cc"));
+
+  VisualStudioWriter::SourceFileCompileTypePairs foo_types;
+  for (const SourceFile& file : foo.sources())
+    foo_types.emplace_back(&file, "None");
+  VisualStudioWriter::SourceFileCompileTypePairs bar_types;
+  for (const SourceFile& file : bar.sources())
+    bar_types.emplace_back(&file, "None");
+
+  std::stringstream foo_filters;
+  writer.WriteFiltersFileContents(foo_filters, &foo, foo_types);
+  std::stringstream bar_filters;
+  writer.WriteFiltersFileContents(bar_filters, &bar, bar_types);
+
+  // Both projects use the same filters, which are only created once.
+  ASSERT_EQ(2u, writer.filters_.size());
+  std::string a_path = "a";
+  std::string b_path = "a/b";
+  ConvertPathToSystem(&b_path);
+  const VisualStudioWriter::Filter* b = writer.GetFilter(b_path);
+  ASSERT_TRUE(b);
+  EXPECT_EQ(MakeGuid(b_path, "filter"), b->guid);
+  ASSERT_TRUE(b->parent);
+  EXPECT_EQ(a_path, b->parent->path);
+  EXPECT_EQ(MakeGuid(a_path, "filter"), b->parent->guid);
+  EXPECT_FALSE(b->parent->parent);
+
+  // Each filter is declared once per project.
+  for (const std::string& filters : {foo_filters.str(), bar_filters.str()}) {
+    std::string declaration = "<Filter Include=\"" + a_path + "\">";
+    size_t pos = filters.find(declaration);
+    ASSERT_NE(std::string::npos, pos) << filters;
+    EXPECT_EQ(std::string::npos, filters.find(declaration, pos + 1));
+    EXPECT_NE(std::string::npos, filters.find(b->parent->guid, pos));
+  }
+}
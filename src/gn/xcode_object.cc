@@ -255,7 +255,11 @@ void PrintProperty(std::ostream& out,
 struct PBXGroupComparator {
   using PBXObjectPtr = std::unique_ptr<PBXObject>;
   bool operator()(const PBXObjectPtr& lhs, const PBXObjectPtr& rhs) {
-    if (lhs.get() == rhs.get())
+    return (*this)(lhs.get(), rhs.get());
+  }
+
+  bool operator()(const PBXObject* lhs, const PBXObject* rhs) {
+    if (lhs == rhs)
       return false;
 
     // Ensure that PBXGroup that should sort last are sorted last.
@@ -270,11 +274,11 @@ struct PBXGroupComparator {
     return lhs->Name() < rhs->Name();
   }
 
-  bool SortLast(const PBXObjectPtr& ptr) {
+  bool SortLast(const PBXObject* ptr) {
     if (ptr->Class() != PBXGroupClass)
       return false;
 
-    return static_cast<PBXGroup*>(ptr.get())->SortLast();
+    return static_cast<const PBXGroup*>(ptr)->SortLast();
   }
 };
 }  // namespace
@@ -598,17 +602,9 @@ PBXFileReference* PBXGroup::AddSourceFile(const std::string& navigator_path,
   std::string::size_type sep = navigator_path.find("/");
   if (sep == std::string::npos) {
     // Prevent same file reference being created and added multiple times.
-    for (const auto& child : children_) {
-      if (child->Class() != PBXFileReferenceClass)
-        continue;
-
-      PBXFileReference* child_as_file_reference =
-          static_cast<PBXFileReference*>(child.get());
-      if (child_as_file_reference->Name() == navigator_path &&
-          child_as_file_reference->path() == navigator_path) {
-        return child_as_file_reference;
-      }
-    }
+    auto found = files_by_name_.find(navigator_path);
+    if (found != files_by_name_.end())
+      return found->second;
 
     return CreateChild<PBXFileReference>(navigator_path, navigator_path,
                                          std::string());
@@ -616,16 +612,9 @@ PBXFileReference* PBXGroup::AddSourceFile(const std::string& navigator_path,
 
   PBXGroup* group = nullptr;
   std::string_view component(navigator_path.data(), sep);
-  for (const auto& child : children_) {
-    if (child->Class() != PBXGroupClass)
-      continue;
-
-    PBXGroup* child_as_group = static_cast<PBXGroup*>(child.get());
-    if (child_as_group->name_ == component) {
-      group = child_as_group;
-      break;
-    }
-  }
+  auto found = groups_by_name_.find(component);
+  if (found != groups_by_name_.end())
+    group = found->second;
 
   if (!group) {
     group =
@@ -688,7 +677,25 @@ PBXObject* PBXGroup::AddChildImpl(std::unique_ptr<PBXObject> child) {
 
   auto iter = std::lower_bound(children_.begin(), children_.end(), child,
                                PBXGroupComparator());
-  return children_.insert(iter, std::move(child))->get();
+  PBXObject* added = children_.insert(iter, std::move(child))->get();
+
+  // AddSourceFile() finds the first child with a given name in the order of
+  // |children_|. The new child is inserted before the children comparing
+  // equal to it, so it replaces the indexed one unless it sorts after it.
+  if (added->Class() == PBXGroupClass) {
+    PBXGroup* group = static_cast<PBXGroup*>(added);
+    PBXGroup*& indexed = groups_by_name_[group->name_];
+    if (!indexed || !PBXGroupComparator()(indexed, group))
+      indexed = group;
+  } else {
+    PBXFileReference* file = static_cast<PBXFileReference*>(added);
+    if (file->Name() == file->path()) {
+      PBXFileReference*& indexed = files_by_name_[file->path()];
+      if (!indexed || !PBXGroupComparator()(indexed, file))
+        indexed = file;
+    }
+  }
+  return added;
 }
 
 // PBXMainGroup ---------------------------------------------------------------
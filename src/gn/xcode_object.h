@@ -98,7 +98,7 @@ class PBXObject {
   PBXObject();
   virtual ~PBXObject();
 
-  const std::string id() const { return id_; }
+  const std::string& id() const { return id_; }
   void SetId(const std::string& id);
 
   std::string Reference() const;
@@ -310,6 +310,14 @@ class PBXGroup : public PBXObject {
   std::string name_;
   std::string path_;
 
+  // The child groups, and the child file references whose name and path are
+  // the same, by name. They allow AddSourceFile() to find the existing
+  // children without scanning |children_|. Names need not be unique, as
+  // CreateChild() may add a child with the name of an existing one: each
+  // name maps to the first such child in the order of |children_|.
+  std::map<std::string, PBXGroup*, std::less<>> groups_by_name_;
+  std::map<std::string, PBXFileReference*, std::less<>> files_by_name_;
+
   PBXGroup(const PBXGroup&) = delete;
   PBXGroup& operator=(const PBXGroup&) = delete;
 };
@@ -433,3 +433,42 @@ TEST(XcodeObject, XCConfigurationListName) {
   EXPECT_EQ("Build configuration list for PBXNativeTarget \"target_name\"",
             xc_configuration_list->Name());
 }
+
+// Tests that AddSourceFile() reuses the existing groups and file references.
+TEST(XcodeObject, PBXGroupAddSourceFile) {
+  PBXGroup root;
+  PBXFileReference* file = root.AddSourceFile("foo/bar/a.cc", "/src/a.cc");
+  EXPECT_EQ("a.cc", file->Name());
+  EXPECT_EQ(file, root.AddSourceFile("foo/bar/a.cc", "/src/a.cc"));
+
+  // Files of the same directory share its group.
+  PBXGroup* foo = root.CreateChild<PBXGroup>("foo2", "foo2");
+  PBXFileReference* b = root.AddSourceFile("foo2/b.cc", "/src/b.cc");
+  EXPECT_EQ(b, foo->AddSourceFile("b.cc", "/src/b.cc"));
+}
+
+// Tests that when several children have the same name, AddSourceFile() uses
+// the first one in sorted order.
+TEST(XcodeObject, PBXGroupAddSourceFileDuplicateNames) {
+  PBXGroup root;
+  PBXFileReference* a = root.AddSourceFile("dir/a.cc", "/src/a.cc");
+
+  // A group added with the name of an existing one sorts before it, and is
+  // used from then on.
+  PBXGroup* other = root.CreateChild<PBXGroup>("other", "dir");
+  PBXFileReference* b = root.AddSourceFile("dir/b.cc", "/src/b.cc");
+  EXPECT_EQ(b, other->AddSourceFile("b.cc", "/src/b.cc"));
+  EXPECT_NE(a, root.AddSourceFile("dir/a.cc", "/src/a.cc"));
+
+  // The products group sorts last, so a group with its name sorts before it
+  // whichever was added first.
+  PBXGroup* products = root.CreateChild<PBXProductsGroup>();
+  PBXFileReference* c = root.AddSourceFile("Products/c.cc", "/src/c.cc");
+  EXPECT_EQ(c, products->AddSourceFile("c.cc", "/src/c.cc"));
+  PBXGroup* regular = root.CreateChild<PBXGroup>("Products", "Products");
+  PBXFileReference* d = root.AddSourceFile("Products/d.cc", "/src/d.cc");
+  EXPECT_EQ(d, regular->AddSourceFile("d.cc", "/src/d.cc"));
+  root.CreateChild<PBXProductsGroup>();
+  PBXFileReference* e = root.AddSourceFile("Products/e.cc", "/src/e.cc");
+  EXPECT_EQ(e, regular->AddSourceFile("e.cc", "/src/e.cc"));
+}
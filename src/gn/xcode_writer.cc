@@ -40,6 +40,7 @@
 #include "gn/value.h"
 #include "gn/variables.h"
 #include "gn/xcode_object.h"
+#include "util/worker_pool.h"
 
 namespace {
 
@@ -291,7 +292,7 @@ const SourceFileSet& XCTestFilesResolver::SearchFilesForTarget(
     xctest_files.insert(deps_xctest_files.begin(), deps_xctest_files.end());
   }
 
-  auto insert = cache_.insert(std::make_pair(target, xctest_files));
+  auto insert = cache_.emplace(target, std::move(xctest_files));
   DCHECK(insert.second);
   return insert.first->second;
 }
@@ -341,39 +342,54 @@ CollectPBXObjectsPerClass(const PBXProject* project) {
   return visitor.objects_per_class();
 }
 
-// Helper class to assign unique ids to all PBXObject.
-class RecursivelyAssignIdsHelper : public PBXObjectVisitor {
+// Helper class to collect all PBXObject in the order they are visited.
+class CollectPBXObjectsHelper : public PBXObjectVisitor {
  public:
-  RecursivelyAssignIdsHelper(const std::string& seed)
-      : seed_(seed), counter_(0) {}
+  CollectPBXObjectsHelper() = default;
 
   void Visit(PBXObject* object) override {
-    std::stringstream buffer;
-    buffer << seed_ << " " << object->Name() << " " << counter_;
-    std::string hash = base::SHA1HashString(buffer.str());
-    DCHECK_EQ(hash.size() % 4, 0u);
-
-    uint32_t id[3] = {0, 0, 0};
-    const uint32_t* ptr = reinterpret_cast<const uint32_t*>(hash.data());
-    for (size_t i = 0; i < hash.size() / 4; i++)
-      id[i % 3] ^= ptr[i];
-
-    object->SetId(base::HexEncode(id, sizeof(id)));
-    ++counter_;
+    DCHECK(object);
+    objects_.push_back(object);
   }
 
+  const std::vector<PBXObject*>& objects() const { return objects_; }
+
  private:
-  std::string seed_;
-  int64_t counter_;
+  std::vector<PBXObject*> objects_;
 
-  RecursivelyAssignIdsHelper(const RecursivelyAssignIdsHelper&) = delete;
-  RecursivelyAssignIdsHelper& operator=(const RecursivelyAssignIdsHelper&) =
-      delete;
+  CollectPBXObjectsHelper(const CollectPBXObjectsHelper&) = delete;
+  CollectPBXObjectsHelper& operator=(const CollectPBXObjectsHelper&) = delete;
 };
 
+// Assigns unique ids to all PBXObject. The id of an object is derived from
+// the project name, the object name and the position of the object in the
+// visit order, so the ids are computed in parallel once the objects are
+// collected.
 void RecursivelyAssignIds(PBXProject* project) {
-  RecursivelyAssignIdsHelper visitor(project->Name());
+  CollectPBXObjectsHelper visitor;
   project->Visit(visitor);
+  const std::vector<PBXObject*>& objects = visitor.objects();
+  const std::string seed = project->Name() + " ";
+
+  ParallelFor(objects.size(), [&objects, &seed](size_t, size_t begin,
+                                                size_t end) {
+    std::string buffer;
+    for (size_t i = begin; i < end; i++) {
+      buffer.assign(seed);
+      buffer.append(objects[i]->Name());
+      buffer.push_back(' ');
+      buffer.append(base::NumberToString(static_cast<int64_t>(i)));
+      std::string hash = base::SHA1HashString(buffer);
+      DCHECK_EQ(hash.size() % 4, 0u);
+
+      uint32_t id[3] = {0, 0, 0};
+      const uint32_t* ptr = reinterpret_cast<const uint32_t*>(hash.data());
+      for (size_t j = 0; j < hash.size() / 4; j++)
+        id[j % 3] ^= ptr[j];
+
+      objects[i]->SetId(base::HexEncode(id, sizeof(id)));
+    }
+  });
 }
 
 // Returns a list of configuration names from the options passed to the
@@ -460,13 +476,23 @@ class WorkspaceSources {
   // for files in an assets catalog, only the catalog itself will be added.
   void AddSourceFile(const SourceFile& source);
 
+  // Records the sources, inputs, public headers, bridge header and script
+  // of `target`.
+  void AddTargetSources(const Target* target);
+
+  // Records all the sources recorded by `other`.
+  void Merge(const WorkspaceSources& other);
+
   // Insert all the recorded source into `project`.
   void AddToProject(PBXProject& project) const;
 
  private:
   const SourceDir build_dir_;
   const std::string root_dir_;
-  SourceFileSet source_files_;
+
+  // May contain duplicates, which are removed when adding the files to the
+  // project, as inserting in a sorted set is quadratic.
+  std::vector<SourceFile> source_files_;
 };
 
 WorkspaceSources::WorkspaceSources(const BuildSettings* build_settings)
@@ -486,16 +512,46 @@ void WorkspaceSources::AddSourceFile(const SourceFile& source) {
 
   SourceFile assets_catalog_dir = BundleData::GetAssetsCatalogDirectory(source);
   if (!assets_catalog_dir.is_null()) {
-    source_files_.insert(assets_catalog_dir);
+    source_files_.push_back(assets_catalog_dir);
   } else {
-    source_files_.insert(source);
+    source_files_.push_back(source);
+  }
+}
+
+void WorkspaceSources::AddTargetSources(const Target* target) {
+  for (const SourceFile& source : target->sources()) {
+    AddSourceFile(source);
   }
+
+  for (const SourceFile& source : target->config_values().inputs()) {
+    AddSourceFile(source);
+  }
+
+  for (const SourceFile& source : target->public_headers()) {
+    AddSourceFile(source);
+  }
+
+  const SourceFile& bridge_header = target->swift_values().bridge_header();
+  if (!bridge_header.is_null()) {
+    AddSourceFile(bridge_header);
+  }
+
+  if (target->output_type() == Target::ACTION ||
+      target->output_type() == Target::ACTION_FOREACH) {
+    AddSourceFile(target->action_values().script());
+  }
+}
+
+void WorkspaceSources::Merge(const WorkspaceSources& other) {
+  source_files_.insert(source_files_.end(), other.source_files_.begin(),
+                       other.source_files_.end());
 }
 
 void WorkspaceSources::AddToProject(PBXProject& project) const {
   // Sort the files to ensure a deterministic generation of the project file.
-  std::vector<SourceFile> sources(source_files_.begin(), source_files_.end());
+  std::vector<SourceFile> sources(source_files_);
   std::sort(sources.begin(), sources.end());
+  sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
 
   const SourceDir source_dir("//");
   for (const SourceFile& source : sources) {
@@ -694,30 +750,21 @@ bool XcodeProject::ShouldIncludeFileInProject(const SourceFile& source) const {
 bool XcodeProject::AddSourcesFromBuilder(const Builder& builder, Err* err) {
   WorkspaceSources sources(build_settings_);
 
-  // Add sources from all targets.
-  for (const Target* target : builder.GetAllResolvedTargets()) {
-    for (const SourceFile& source : target->sources()) {
-      sources.AddSourceFile(source);
-    }
-
-    for (const SourceFile& source : target->config_values().inputs()) {
-      sources.AddSourceFile(source);
-    }
-
-    for (const SourceFile& source : target->public_headers()) {
-      sources.AddSourceFile(source);
-    }
-
-    const SourceFile& bridge_header = target->swift_values().bridge_header();
-    if (!bridge_header.is_null()) {
-      sources.AddSourceFile(bridge_header);
-    }
-
-    if (target->output_type() == Target::ACTION ||
-        target->output_type() == Target::ACTION_FOREACH) {
-      sources.AddSourceFile(target->action_values().script());
-    }
-  }
+  // Add sources from all targets. They are collected in parallel, and the
+  // order in which they are merged doesn't matter as they are sorted when
+  // added to the project.
+  const std::vector<const Target*> targets = builder.GetAllResolvedTargets();
+  std::vector<std::unique_ptr<WorkspaceSources>> targets_sources(
+      ParallelForRangeCount(targets.size()));
+  for (auto& chunk_sources : targets_sources)
+    chunk_sources = std::make_unique<WorkspaceSources>(build_settings_);
+  ParallelFor(targets.size(), [&targets_sources, &targets](
+                                  size_t range, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+      targets_sources[range]->AddTargetSources(targets[i]);
+  });
+  for (const auto& chunk_sources : targets_sources)
+    sources.Merge(*chunk_sources);
 
   // Add BUILD.gn and *.gni for targets, configs and toolchains.
   for (const Item* item : builder.GetAllResolvedItems()) {
@@ -1071,15 +1118,33 @@ void XcodeProject::WriteFileContent(std::ostream& out) const {
       << "\tobjectVersion = 46;\n"
       << "\tobjects = {\n";
 
-  for (auto& pair : CollectPBXObjectsPerClass(&project_)) {
-    out << "\n" << "/* Begin " << ToString(pair.first) << " section */\n";
-    std::sort(pair.second.begin(), pair.second.end(),
+  // The objects are printed in parallel, then written in order.
+  std::map<PBXObjectClass, std::vector<const PBXObject*>> objects_per_class =
+      CollectPBXObjectsPerClass(&project_);
+  std::map<PBXObjectClass, std::vector<std::string>> printed_per_class;
+  for (auto& pair : objects_per_class) {
+    std::vector<const PBXObject*>& objects = pair.second;
+    std::sort(objects.begin(), objects.end(),
               [](const PBXObject* a, const PBXObject* b) {
                 return a->id() < b->id();
               });
-    for (auto* object : pair.second) {
-      object->Print(out, 2);
-    }
+
+    std::vector<std::string>& printed = printed_per_class[pair.first];
+    printed.resize(objects.size());
+    ParallelFor(objects.size(), [&objects, &printed](size_t, size_t begin,
+                                                     size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        std::ostringstream buffer;
+        objects[i]->Print(buffer, 2);
+        printed[i] = buffer.str();
+      }
+    });
+  }
+
+  for (const auto& pair : printed_per_class) {
+    out << "\n" << "/* Begin " << ToString(pair.first) << " section */\n";
+    for (const std::string& printed : pair.second)
+      out << printed;
     out << "/* End " << ToString(pair.first) << " section */\n";
   }
 
@@ -0,0 +1,129 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gn/xcode_writer.h"
+
+#include <stdint.h>
+
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "gn/err.h"
+#include "gn/filesystem_utils.h"
+#include "gn/setup.h"
+#include "gn/switches.h"
+#include "gn/test_with_scheduler.h"
+#include "util/test/test.h"
+
+using XcodeWriterTest = TestWithScheduler;
+
+namespace {
+
+void WriteFile(const base::FilePath& file, const std::string& data) {
+  CHECK_EQ(static_cast<int>(data.size()),  // Way smaller than INT_MAX.
+           base::WriteFile(file, data.data(), data.size()));
+}
+
+// Returns the id the project assigns to the object with the given name and
+// index in the visit order.
+std::string GetExpectedId(const std::string& project_name,
+                          const std::string& object_name,
+                          size_t index) {
+  std::string hash = base::SHA1HashString(project_name + " " + object_name +
+                                          " " + base::NumberToString(index));
+  uint32_t id[3] = {0, 0, 0};
+  const uint32_t* ptr = reinterpret_cast<const uint32_t*>(hash.data());
+  for (size_t i = 0; i < hash.size() / 4; i++)
+    id[i % 3] ^= ptr[i];
+  return base::HexEncode(id, sizeof(id));
+}
+
+}  // namespace
+
+TEST_F(XcodeWriterTest, ProjectIds) {
+  base::ScopedTempDir in_temp_dir;
+  ASSERT_TRUE(in_temp_dir.CreateUniqueTempDir());
+  base::FilePath in_path = in_temp_dir.GetPath();
+  WriteFile(in_path.Append(FILE_PATH_LITERAL(".gn")),
+            "buildconfig = \"//BUILDCONFIG.gn\"\n");
+  WriteFile(in_path.Append(FILE_PATH_LITERAL("BUILDCONFIG.gn")),
+            "set_default_toolchain(\"//:default\")\n");
+  WriteFile(in_path.Append(FILE_PATH_LITERAL("BUILD.gn")), R"(
+toolchain("default") {
+  tool("stamp") {
+    command = "stamp"
+  }
+}
+
+group("all") {
+  deps = [ ":a", ":b" ]
+}
+
+source_set("a") {
+  sources = [ "dir/a.cc", "dir/sub/a.h" ]
+}
+
+source_set("b") {
+  sources = [ "dir/b.cc", "dir/sub/a.h" ]
+}
+)");
+
+  base::ScopedTempDir build_temp_dir;
+  ASSERT_TRUE(build_temp_dir.CreateUniqueTempDir());
+  base::CommandLine cmdline(base::CommandLine::NO_PROGRAM);
+  cmdline.AppendSwitch(switches::kRoot, FilePathToUTF8(in_path));
+  Setup setup;
+  ASSERT_TRUE(
+      setup.DoSetup(FilePathToUTF8(build_temp_dir.GetPath()), true, cmdline));
+  ASSERT_TRUE(setup.Run());
+
+  base::FilePath project_path =
+      build_temp_dir.GetPath()
+          .Append(FILE_PATH_LITERAL("all.xcodeproj"))
+          .Append(FILE_PATH_LITERAL("project.pbxproj"));
+  XcodeWriter::Options options;
+  options.project_name = "all";
+  auto generate = [&setup, &options, &project_path](std::string* contents) {
+    Err err;
+    ASSERT_TRUE(XcodeWriter::RunAndWriteFiles(
+        &setup.build_settings(), setup.builder(), options, &err));
+    ASSERT_TRUE(base::ReadFileToString(project_path, contents));
+  };
+  std::string contents;
+  generate(&contents);
+
+  // The project is the first object visited.
+  EXPECT_NE(std::string::npos,
+            contents.find("rootObject = " + GetExpectedId("all", "all", 0) +
+                          " /* Project object */;"))
+      << contents;
+
+  // Every object is defined once, and the header shared by both targets is
+  // listed once in its group.
+  std::set<std::string> ids;
+  for (std::string_view line : base::SplitStringPiece(
+           contents, "\n", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    if (line.starts_with("\t\t") && !line.starts_with("\t\t\t") &&
+        line.find(" = {") != std::string_view::npos) {
+      EXPECT_TRUE(ids.insert(std::string(line.substr(2, 24))).second) << line;
+    }
+  }
+  EXPECT_FALSE(ids.empty());
+  size_t header = contents.find("path = a.h;");
+  ASSERT_NE(std::string::npos, header);
+  EXPECT_EQ(std::string::npos, contents.find("path = a.h;", header + 1));
+
+  // Generating the project again gives the same ids.
+  std::string again;
+  generate(&again);
+  EXPECT_EQ(contents, again);
+}
@@ -4,6 +4,10 @@
 
 #include "util/worker_pool.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #include "base/command_line.h"
 #include "base/strings/string_number_conversions.h"
 #include "gn/switches.h"
@@ -41,8 +45,81 @@ int GetThreadCount() {
   return std::max(num_cores - 1, 8);
 }
 
+// Number of ranges ParallelFor() gives each thread, so that uneven ranges
+// still balance.
+constexpr size_t kRangesPerThread = 4;
+
+WorkerPool* GetSharedPool() {
+  // Deliberately leaked to avoid joining the threads at exit.
+  static WorkerPool* pool = new WorkerPool;
+  return pool;
+}
+
+// The state of a ParallelFor() call. It is shared with the tasks posted to
+// the pool, which may only start after the call returned.
+struct ParallelForState {
+  size_t count;
+  size_t range_count;
+
+  // Only valid until all the ranges are done.
+  const std::function<void(size_t, size_t, size_t)>* fn;
+
+  std::atomic<size_t> next_range{0};
+
+  std::mutex lock;
+  std::condition_variable done_notifier;
+  size_t done_count = 0;
+
+  // Runs ranges until none are left.
+  void RunRanges() {
+    for (;;) {
+      size_t range = next_range++;
+      if (range >= range_count)
+        return;
+      (*fn)(range, count * range / range_count,
+            count * (range + 1) / range_count);
+
+      std::lock_guard<std::mutex> done_lock(lock);
+      if (++done_count == range_count)
+        done_notifier.notify_all();
+    }
+  }
+};
+
 }  // namespace
 
+size_t ParallelForRangeCount(size_t count) {
+  return std::min(count,
+                  (GetSharedPool()->thread_count() + 1) * kRangesPerThread);
+}
+
+void ParallelFor(
+    size_t count,
+    const std::function<void(size_t range, size_t begin, size_t end)>& fn) {
+  size_t range_count = ParallelForRangeCount(count);
+  if (range_count <= 1) {
+    if (count)
+      fn(0, 0, count);
+    return;
+  }
+
+  auto state = std::make_shared<ParallelForState>();
+  state->count = count;
+  state->range_count = range_count;
+  state->fn = &fn;
+
+  WorkerPool* pool = GetSharedPool();
+  size_t helpers = std::min(range_count - 1, pool->thread_count());
+  for (size_t i = 0; i < helpers; i++)
+    pool->PostTask([state]() { state->RunRanges(); });
+  state->RunRanges();
+
+  std::unique_lock<std::mutex> done_lock(state->lock);
+  state->done_notifier.wait(done_lock, [&state]() {
+    return state->done_count == state->range_count;
+  });
+}
+
 WorkerPool::WorkerPool() : WorkerPool(GetThreadCount()) {}
 
 WorkerPool::WorkerPool(size_t thread_count) : should_stop_processing_(false) {
@@ -21,6 +21,8 @@ class WorkerPool {
 
   void PostTask(std::function<void()> work);
 
+  size_t thread_count() const { return threads_.size(); }
+
  private:
   void Worker();
 
@@ -34,4 +36,19 @@ class WorkerPool {
   WorkerPool& operator=(const WorkerPool&) = delete;
 };
 
+// Returns the number of consecutive ranges ParallelFor() splits |count|
+// indices into.
+size_t ParallelForRangeCount(size_t count);
+
+// Calls |fn(range, begin, end)| for each of the ParallelForRangeCount(count)
+// consecutive ranges covering the indices [0, count), where |range| is the
+// index of the range, and returns once all of them have run.
+//
+// The ranges run in parallel on a pool shared by the whole process, and on
+// the calling thread, so nested calls (including from the threads of the
+// pool) neither create threads nor deadlock.
+void ParallelFor(
+    size_t count,
+    const std::function<void(size_t range, size_t begin, size_t end)>& fn);
+
 #endif  // UTIL_WORKER_POOL_H_
@@ -0,0 +1,40 @@
+// Copyright 2026 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/worker_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "util/test/test.h"
+
+TEST(ParallelFor, CoversAllIndices) {
+  for (size_t count : {0, 1, 7, 1000}) {
+    std::vector<int> visits(count);
+    std::vector<size_t> range_begins(ParallelForRangeCount(count), count);
+    ParallelFor(count, [&visits, &range_begins](size_t range, size_t begin,
+                                                size_t end) {
+      range_begins[range] = begin;
+      for (size_t i = begin; i < end; i++)
+        visits[i]++;
+    });
+    for (size_t i = 0; i < count; i++)
+      EXPECT_EQ(1, visits[i]) << count << " " << i;
+    // The ranges are consecutive.
+    for (size_t i = 1; i < range_begins.size(); i++)
+      EXPECT_LE(range_begins[i - 1], range_begins[i]);
+  }
+}
+
+TEST(ParallelFor, Nested) {
+  std::atomic<size_t> sum{0};
+  ParallelFor(100, [&sum](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      ParallelFor(100, [&sum](size_t, size_t begin, size_t end) {
+        sum += end - begin;
+      });
+    }
+  });
+  EXPECT_EQ(10000u, sum);
+}